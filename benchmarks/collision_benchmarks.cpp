@@ -0,0 +1,287 @@
+/*
+ * Замеры поиска событий сбора collision_detector::FindGatherEvents():
+ * полный перебор пар собиратель-предмет (BroadPhase::NONE) и отбор предметов по сетке (BroadPhase::GRID)
+ * при равном числе собак и предметов на карте-сетке 100x100 дорог. По замерам выбрана граница GRID_MIN_PAIRS,
+ * с которой BroadPhase::AUTO переходит на сетку. Те же замеры для предметов, переданных массивами (без провайдера).
+ * Подбор предметов в сессии: все предметы сессии или только предметы из корзин дорог рядом с собаками
+ * (GameSession::FindLostObjectsNear) при 16 собаках и растущем числе предметов.
+ * Пакетная проверка одного перемещения со 100 000 точек (TryCollectPoints) каждым набором инструкций.
+ * Подбор в толпе: отсортированный вектор всех событий (FindGatherEvents) или потоковая обработка
+ * (ProcessGatherEvents), когда рюкзаки заполняются после первых событий.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "../src/collision_detector.h"
+#include "../src/game_session.h"
+#include "../src/model.h"
+#include "../tests/grid_map.h"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+constexpr double TICK = 0.05; // 50 мс
+constexpr double DOG_SPEED = 3.;
+constexpr int GRID_SIZE = 100;
+constexpr int GRID_STEP = 20;
+
+class Gathering : public collision_detector::ItemGathererProvider {
+public:
+    Gathering(std::vector<collision_detector::Item> items, std::vector<collision_detector::Gatherer> gatherers)
+        : items_(std::move(items))
+        , gatherers_(std::move(gatherers)) {
+        for (const collision_detector::Item& item : items_) {
+            positions_.push_back(item.GetPosition());
+            widths_.push_back(item.GetWidth());
+        }
+    }
+
+    size_t ItemsCount() const override {
+        return items_.size();
+    }
+    collision_detector::Item GetItem(size_t idx) const override {
+        return items_[idx];
+    }
+    size_t GatherersCount() const override {
+        return gatherers_.size();
+    }
+    collision_detector::Gatherer GetGatherer(size_t idx) const override {
+        return gatherers_[idx];
+    }
+
+    /* Те же предметы массивами, без провайдера */
+    std::vector<collision_detector::GatheringEvent> FindEvents(collision_detector::BroadPhase broad_phase) const {
+        return collision_detector::FindGatherEvents(positions_, widths_, gatherers_, false, broad_phase);
+    }
+
+private:
+    std::vector<collision_detector::Item> items_;
+    std::vector<collision_detector::Gatherer> gatherers_;
+    std::vector<model::Position> positions_;
+    std::vector<double> widths_;
+};
+
+/* Точка на случайной дороге сетки: одна координата кратна шагу сетки */
+model::Position RandomRoadPoint(std::mt19937& gen) {
+    std::uniform_int_distribution<int> line(0, GRID_SIZE - 1);
+    std::uniform_int_distribution<int> along(0, (GRID_SIZE - 1) * GRID_STEP);
+    if (line(gen) % 2 == 0) {
+        return {static_cast<double>(along(gen)), static_cast<double>(line(gen) * GRID_STEP)};
+    }
+    return {static_cast<double>(line(gen) * GRID_STEP), static_cast<double>(along(gen))};
+}
+
+/* Собаки и предметы в одной области карты: чем больше собак, тем больше область */
+Gathering PrepareGathering(size_t count) {
+    std::mt19937 gen(static_cast<std::uint32_t>(count));
+    std::vector<collision_detector::Item> items;
+    std::vector<collision_detector::Gatherer> gatherers;
+    for (size_t i = 0; i != count; ++i) {
+        items.emplace_back(0, RandomRoadPoint(gen), i);
+        const model::Position start = RandomRoadPoint(gen);
+        const bool horizontal = static_cast<int>(start.y) % GRID_STEP == 0;
+        const model::Position end = horizontal ? model::Position{start.x + DOG_SPEED * TICK, start.y}
+                                               : model::Position{start.x, start.y + DOG_SPEED * TICK};
+        gatherers.push_back({start, end, model::LostObject::GATHERER_HALF_WIDTH});
+    }
+    return Gathering(std::move(items), std::move(gatherers));
+}
+
+model::Map PrepareGridMap() {
+    model::Map map = grid_map::MakeGridMap(GRID_SIZE, GRID_STEP, DOG_SPEED);
+    map.AddLootType(model::LootType{"key"sv, "key.obj"sv, "obj"sv, std::nullopt, std::nullopt, 0.1, 5});
+    return map;
+}
+
+} // namespace
+
+TEST_CASE("Gathering broad phase", "[benchmark]") {
+    for (size_t count : {2u, 4u, 6u, 8u, 16u, 64u, 1'000u}) {
+        const Gathering gathering = PrepareGathering(count);
+        const std::string suffix = ", dogs and items: "s + std::to_string(count);
+        BENCHMARK("FindGatherEvents brute force"s + suffix) {
+            return collision_detector::FindGatherEvents(gathering, false, collision_detector::BroadPhase::NONE).size();
+        };
+        BENCHMARK("FindGatherEvents grid"s + suffix) {
+            return collision_detector::FindGatherEvents(gathering, false, collision_detector::BroadPhase::GRID).size();
+        };
+        BENCHMARK("FindGatherEvents arrays, brute force"s + suffix) {
+            return gathering.FindEvents(collision_detector::BroadPhase::NONE).size();
+        };
+        BENCHMARK("FindGatherEvents arrays, grid"s + suffix) {
+            return gathering.FindEvents(collision_detector::BroadPhase::GRID).size();
+        };
+    }
+}
+
+TEST_CASE("Lost objects near dogs", "[benchmark]") {
+    model::Map map = PrepareGridMap();
+    constexpr size_t DOGS = 16;
+    for (size_t count : {100u, 1'000u, 10'000u, 100'000u}) {
+        std::mt19937 gen(static_cast<std::uint32_t>(count));
+        model::GameSession session(&map);
+        std::vector<model::LostObject> lost_objects;
+        for (size_t i = 0; i != count; ++i) {
+            lost_objects.emplace_back(0, RandomRoadPoint(gen), i);
+        }
+        session.RestoreLostObjects(std::move(lost_objects), count);
+        std::vector<collision_detector::Gatherer> gatherers;
+        for (size_t i = 0; i != DOGS; ++i) {
+            const model::Position start = RandomRoadPoint(gen);
+            const bool horizontal = static_cast<int>(start.y) % GRID_STEP == 0;
+            const model::Position end = horizontal ? model::Position{start.x + DOG_SPEED * TICK, start.y}
+                                                   : model::Position{start.x, start.y + DOG_SPEED * TICK};
+            gatherers.push_back({start, end, model::LostObject::GATHERER_HALF_WIDTH});
+        }
+
+        const std::string suffix = ", items: "s + std::to_string(count);
+        BENCHMARK("Pickup among all session objects"s + suffix) {
+            std::vector<collision_detector::Item> items;
+            items.reserve(session.CountLostObjects());
+            for (const auto& object : session.GetLostObjects()) {
+                items.push_back(object);
+            }
+            return collision_detector::FindGatherEvents(Gathering(std::move(items), gatherers)).size();
+        };
+        BENCHMARK("Pickup among objects near dogs"s + suffix) {
+            std::vector<model::Position> positions;
+            std::vector<double> widths;
+            const model::GameSession::LostObjects& objects = session.GetLostObjects();
+            for (const auto& key : session.FindLostObjectsNear(gatherers)) {
+                positions.push_back(objects[key].GetPosition());
+                widths.push_back(objects[key].GetWidth());
+            }
+            return collision_detector::FindGatherEvents(positions, widths, gatherers).size();
+        };
+    }
+}
+
+/* Удаление каждой второй вещи, как после подбора в толпе: стоимость линейна по числу вещей сессии */
+TEST_CASE("Lost objects removal", "[benchmark]") {
+    model::Map map = PrepareGridMap();
+    for (size_t count : {1'000u, 10'000u, 100'000u}) {
+        std::mt19937 gen(static_cast<std::uint32_t>(count));
+        std::vector<model::LostObject> lost_objects;
+        for (size_t i = 0; i != count; ++i) {
+            lost_objects.emplace_back(0, RandomRoadPoint(gen), i);
+        }
+        std::vector<bool> every_other(count);
+        for (size_t i = 0; i != count; i += 2) {
+            every_other[i] = true;
+        }
+
+        BENCHMARK_ADVANCED("RemoveObjectsFromLost, items: "s + std::to_string(count))(Catch::Benchmark::Chronometer meter) {
+            std::vector<model::GameSession> sessions(meter.runs(), model::GameSession(&map));
+            for (model::GameSession& session : sessions) {
+                session.RestoreLostObjects(lost_objects, count);
+            }
+            meter.measure([&sessions, &every_other](int run) {
+                sessions[run].RemoveObjectsFromLost(every_other);
+                return sessions[run].CountLostObjects();
+            });
+        };
+    }
+}
+
+TEST_CASE("Batch TryCollectPoints", "[benchmark]") {
+    constexpr size_t POINTS = 100'000;
+    std::mt19937 gen(POINTS);
+    std::vector<model::Position> points;
+    std::vector<double> widths(POINTS, model::LostObject::ITEM_HALF_WIDTH);
+    for (size_t i = 0; i != POINTS; ++i) {
+        points.push_back(RandomRoadPoint(gen));
+    }
+    const model::Position start{100., 100.};
+    const model::Position end{140., 100.};
+
+    BENCHMARK("TryCollectPoint loop, points: 100000") {
+        size_t collected = 0;
+        for (size_t i = 0; i != POINTS; ++i) {
+            collected += collision_detector::TryCollectPoint(start, end, points[i])
+                             .IsCollected(model::LostObject::GATHERER_HALF_WIDTH + widths[i]);
+        }
+        return collected;
+    };
+    const std::pair<collision_detector::BatchKernel, std::string> kernels[] = {
+        {collision_detector::BatchKernel::SCALAR, "scalar"s},
+        {collision_detector::BatchKernel::SSE2, "SSE2"s},
+        {collision_detector::BatchKernel::AVX2, "AVX2"s}};
+    for (const auto& [kernel, name] : kernels) {
+        if (!collision_detector::IsBatchKernelSupported(kernel)) {
+            continue;
+        }
+        collision_detector::CollectionHits hits;
+        BENCHMARK("TryCollectPoints "s + name + ", points: 100000") {
+            hits.Clear();
+            collision_detector::TryCollectPoints(start, end, points, widths, model::LostObject::GATHERER_HALF_WIDTH,
+                                                 hits, kernel);
+            return hits.indices.size();
+        };
+    }
+}
+
+namespace {
+
+/* Рюкзак на BAG_CAPACITY предметов у каждой собаки */
+class BagsHandler : public collision_detector::GatherEventHandler {
+public:
+    static constexpr size_t BAG_CAPACITY = 3;
+
+    explicit BagsHandler(size_t dogs)
+        : bags_(dogs, 0) {}
+
+    bool IsGathererActive(size_t gatherer_idx) const override {
+        return bags_[gatherer_idx] < BAG_CAPACITY;
+    }
+    collision_detector::GatherDecision OnEvent(const collision_detector::GatheringEvent& event) override {
+        return (++bags_[event.gatherer_id] < BAG_CAPACITY) ? collision_detector::GatherDecision::TAKE
+                                                           : collision_detector::GatherDecision::TAKE_AND_STOP;
+    }
+
+private:
+    std::vector<size_t> bags_;
+};
+
+} // namespace
+
+TEST_CASE("Crowded pickup", "[benchmark]") {
+    for (size_t dogs : {10u, 100u, 300u}) {
+        std::mt19937 gen(static_cast<std::uint32_t>(dogs));
+        std::uniform_real_distribution<double> along(0., 100.);
+        std::vector<model::Position> positions;
+        std::vector<double> widths(dogs * 10, model::LostObject::ITEM_HALF_WIDTH);
+        for (size_t i = 0; i != dogs * 10; ++i) {
+            positions.push_back({along(gen), 0.});
+        }
+        std::vector<collision_detector::Gatherer> gatherers;
+        for (size_t i = 0; i != dogs; ++i) {
+            const double start = along(gen);
+            gatherers.push_back({{start, 0.}, {start + 20., 0.}, model::LostObject::GATHERER_HALF_WIDTH});
+        }
+
+        const std::string suffix = ", dogs: "s + std::to_string(dogs) + ", items: "s + std::to_string(dogs * 10);
+        BENCHMARK("Sorted events"s + suffix) {
+            BagsHandler handler(dogs);
+            std::vector<bool> item_taken(positions.size(), false);
+            for (const auto& event : collision_detector::FindGatherEvents(positions, widths, gatherers)) {
+                if (!item_taken[event.item_id] && handler.IsGathererActive(event.gatherer_id)) {
+                    item_taken[event.item_id] = true;
+                    handler.OnEvent(event);
+                }
+            }
+            return item_taken.size();
+        };
+        BENCHMARK("Streaming events"s + suffix) {
+            BagsHandler handler(dogs);
+            collision_detector::ProcessGatherEvents(positions, widths, gatherers, handler);
+            return positions.size();
+        };
+    }
+}
@@ -0,0 +1,122 @@
+#include "collision_scenes.h"
+#include "../tests/grid_map.h"
+
+#include <algorithm>
+#include <random>
+
+namespace collision_scenes {
+
+using namespace std::literals;
+
+namespace {
+
+constexpr double DOG_SPEED = 3.;
+
+fixed_point::Point ToFixed(const model::Position& pos) {
+    return {fixed_point::FromDouble(pos.x), fixed_point::FromDouble(pos.y)};
+}
+
+} // namespace
+
+const std::vector<SceneParams>& GetScenes() {
+    static const std::vector<SceneParams> scenes = {
+        {"city"s, 50, 20, 100, 100, 50, 0.05, 1},
+        {"busy city"s, 100, 20, 1'000, 10'000, 200, 0.05, 2},
+        {"crowd"s, 5, 10, 500, 5'000, 10, 0.05, 3},
+        {"long tick"s, 20, 20, 200, 2'000, 20, 10., 4},
+    };
+    return scenes;
+}
+
+Scene MakeScene(const SceneParams& params) {
+    Scene scene{params, std::make_unique<model::Map>(model::Map::Id{params.name}, params.name, DOG_SPEED), {}, {}, {}};
+    model::Map& map = *scene.map;
+    map.AddRoads(grid_map::MakeGridRoads(params.grid_size, params.grid_step));
+    map.AddLootType(model::LootType{"key"sv, "key.obj"sv, "obj"sv, std::nullopt, std::nullopt, 0.1, 5});
+
+    std::mt19937_64 gen(params.seed);
+    map.SetRandomEngine(model::RandomSource::Engine(params.seed));
+    std::uniform_int_distribution<int> junction(0, params.grid_size - 1);
+    for (size_t i = 0; i != params.offices; ++i) {
+        map.AddOffice({model::Office::Id{"o"s + std::to_string(i)},
+                       {junction(gen) * params.grid_step, junction(gen) * params.grid_step}, {5, 0}});
+    }
+    map.Freeze();
+
+    for (size_t i = 0; i != params.items; ++i) {
+        scene.item_positions.push_back(map.GetRandomPositionOnRoads());
+        scene.item_widths.push_back(model::LostObject::ITEM_HALF_WIDTH);
+    }
+
+    const model::Velocity speeds[] = {{0., -DOG_SPEED}, {0., DOG_SPEED}, {-DOG_SPEED, 0.}, {DOG_SPEED, 0.}};
+    const model::Direction directions[] = {model::Direction::NORTH, model::Direction::SOUTH,
+                                           model::Direction::WEST, model::Direction::EAST};
+    std::uniform_int_distribution<size_t> direction(0, 3);
+    for (size_t i = 0; i != params.dogs; ++i) {
+        const model::Position start = map.GetRandomPositionOnRoads();
+        const size_t d = direction(gen);
+        auto dog = std::make_shared<model::Dog>(i, "dog"s, start);
+        dog->SetState({start, speeds[d], directions[d]});
+        dog->SetRoad(map.FindDogRoad(start));
+        const model::Position end = map.MoveDog(dog, params.tick).position;
+        scene.gatherers.push_back({start, end, model::LostObject::GATHERER_HALF_WIDTH});
+    }
+    return scene;
+}
+
+std::vector<collision_detector::GatheringEvent> BruteForceEvents(const std::vector<model::Position>& item_positions,
+                                                                 const std::vector<double>& item_widths,
+                                                                 const std::vector<collision_detector::Gatherer>& gatherers,
+                                                                 bool fixed_point) {
+    std::vector<collision_detector::GatheringEvent> events;
+    for (size_t g_idx = 0; g_idx != gatherers.size(); ++g_idx) {
+        const collision_detector::Gatherer& gatherer = gatherers[g_idx];
+        if ((gatherer.start_pos.x == gatherer.end_pos.x) && (gatherer.start_pos.y == gatherer.end_pos.y)) {
+            continue;
+        }
+        const fixed_point::Point start = ToFixed(gatherer.start_pos);
+        const fixed_point::Point end = ToFixed(gatherer.end_pos);
+        if (fixed_point && (start.x == end.x) && (start.y == end.y)) {
+            continue;
+        }
+        for (size_t i_idx = 0; i_idx != item_positions.size(); ++i_idx) {
+            const collision_detector::CollectionResult result =
+                fixed_point ? collision_detector::TryCollectPoint(start, end, ToFixed(item_positions[i_idx]))
+                            : collision_detector::TryCollectPoint(gatherer.start_pos, gatherer.end_pos, item_positions[i_idx]);
+            if (result.IsCollected(gatherer.width + item_widths[i_idx])) {
+                events.push_back({i_idx, g_idx, result.sq_distance, result.proj_ratio});
+            }
+        }
+    }
+    std::stable_sort(events.begin(), events.end(), [](const auto& left, const auto& right) {
+        return left.time < right.time;
+    });
+    return events;
+}
+
+std::vector<collision_detector::GatheringEvent> BruteForcePickups(const std::vector<model::Position>& item_positions,
+                                                                  const std::vector<double>& item_widths,
+                                                                  const std::vector<collision_detector::Gatherer>& gatherers,
+                                                                  bool fixed_point, size_t bag_capacity) {
+    std::vector<collision_detector::GatheringEvent> pickups;
+    std::vector<bool> item_taken(item_positions.size(), false);
+    std::vector<size_t> bags(gatherers.size(), 0);
+    for (const auto& event : BruteForceEvents(item_positions, item_widths, gatherers, fixed_point)) {
+        if (!item_taken[event.item_id] && (bags[event.gatherer_id] < bag_capacity)) {
+            item_taken[event.item_id] = true;
+            ++bags[event.gatherer_id];
+            pickups.push_back(event);
+        }
+    }
+    return pickups;
+}
+
+bool SameEvents(const std::vector<collision_detector::GatheringEvent>& left,
+                const std::vector<collision_detector::GatheringEvent>& right) {
+    return std::equal(left.begin(), left.end(), right.begin(), right.end(), [](const auto& l, const auto& r) {
+        return (l.item_id == r.item_id) && (l.gatherer_id == r.gatherer_id) &&
+               (l.sq_distance == r.sq_distance) && (l.time == r.time);
+    });
+}
+
+} // namespace collision_scenes
@@ -0,0 +1,61 @@
+/*
+ * Случайные сцены для замеров и проверки поиска столкновений (collision_benchmarks).
+ * Сцена - карта-сетка дорог с офисами на перекрёстках, предметы в случайных точках дорог
+ * и собаки, которые за тик проходят по дорогам (Map::MoveDog) со скоростью карты.
+ * Эталон - полный перебор пар собиратель-предмет через TryCollectPoint() без broad phase,
+ * пакетных ядер и потоковой обработки: с ним сравниваются все ускоренные варианты.
+ */
+#pragma once
+#include "../src/collision_detector.h"
+#include "../src/model.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace collision_scenes {
+
+struct SceneParams {
+    std::string name;
+    int grid_size;   // число дорог по каждой оси
+    int grid_step;   // расстояние между соседними дорогами
+    size_t dogs;
+    size_t items;
+    size_t offices;
+    double tick;     // время перемещения собак, с
+    std::uint64_t seed;
+};
+
+struct Scene {
+    SceneParams params;
+    std::unique_ptr<model::Map> map; // сессии хранят указатель на карту
+    std::vector<model::Position> item_positions;
+    std::vector<double> item_widths;
+    std::vector<collision_detector::Gatherer> gatherers;
+};
+
+/* Реалистичные сцены (город, оживлённый город) и худшие случаи (толпа на маленькой карте,
+ * перемещения через всю карту при долгом тике) */
+const std::vector<SceneParams>& GetScenes();
+
+Scene MakeScene(const SceneParams& params);
+
+/* События эталона в порядке FindGatherEvents(): по времени, при равном времени - по собирателю и предмету */
+std::vector<collision_detector::GatheringEvent> BruteForceEvents(const std::vector<model::Position>& item_positions,
+                                                                 const std::vector<double>& item_widths,
+                                                                 const std::vector<collision_detector::Gatherer>& gatherers,
+                                                                 bool fixed_point);
+
+/* Подбор по событиям эталона: предмет достаётся первому собирателю со свободным местом в рюкзаке */
+std::vector<collision_detector::GatheringEvent> BruteForcePickups(const std::vector<model::Position>& item_positions,
+                                                                  const std::vector<double>& item_widths,
+                                                                  const std::vector<collision_detector::Gatherer>& gatherers,
+                                                                  bool fixed_point, size_t bag_capacity);
+
+/* Побитовое совпадение последовательностей событий */
+bool SameEvents(const std::vector<collision_detector::GatheringEvent>& left,
+                const std::vector<collision_detector::GatheringEvent>& right);
+
+} // namespace collision_scenes
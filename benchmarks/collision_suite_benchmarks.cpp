@@ -0,0 +1,165 @@
+/*
+ * Стоимость поиска столкновений за тик на случайных сценах collision_scenes.h.
+ * Перед замерами каждый вариант сверяется с эталонным полным перебором (события совпадают побитово):
+ * - FindGatherEvents() через провайдер и массивами с broad phase NONE, GRID и AUTO
+ * - предметы рядом с собаками из корзин сессии (GameSession::FindLostObjectsNear)
+ * - потоковый подбор с рюкзаками (ProcessGatherEvents)
+ * - доставка в офисы по массивам офисов карты
+ * в режимах double и фиксированной точки.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "collision_scenes.h"
+#include "../src/game_session.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+using collision_detector::BroadPhase;
+using collision_detector::GatheringEvent;
+
+namespace {
+
+constexpr size_t BAG_CAPACITY = 3;
+
+class Provider : public collision_detector::ItemGathererProvider {
+public:
+    explicit Provider(const collision_scenes::Scene& scene)
+        : scene_(scene) {}
+
+    size_t ItemsCount() const override {
+        return scene_.item_positions.size();
+    }
+    collision_detector::Item GetItem(size_t idx) const override {
+        return collision_detector::Item(0, scene_.item_positions[idx], idx, scene_.item_widths[idx]);
+    }
+    size_t GatherersCount() const override {
+        return scene_.gatherers.size();
+    }
+    collision_detector::Gatherer GetGatherer(size_t idx) const override {
+        return scene_.gatherers[idx];
+    }
+
+private:
+    const collision_scenes::Scene& scene_;
+};
+
+class BagsHandler : public collision_detector::GatherEventHandler {
+public:
+    explicit BagsHandler(size_t gatherers_count)
+        : bags_(gatherers_count, 0) {}
+
+    bool IsGathererActive(size_t gatherer_idx) const override {
+        return bags_[gatherer_idx] < BAG_CAPACITY;
+    }
+    collision_detector::GatherDecision OnEvent(const GatheringEvent& event) override {
+        pickups.push_back(event);
+        return (++bags_[event.gatherer_id] < BAG_CAPACITY) ? collision_detector::GatherDecision::TAKE
+                                                           : collision_detector::GatherDecision::TAKE_AND_STOP;
+    }
+
+    std::vector<GatheringEvent> pickups;
+
+private:
+    std::vector<size_t> bags_;
+};
+
+/* Сессия с предметами сцены, id предмета - его индекс в сцене */
+std::shared_ptr<model::GameSession> MakeSession(const collision_scenes::Scene& scene) {
+    auto session = std::make_shared<model::GameSession>(scene.map.get());
+    std::vector<model::LostObject> lost_objects;
+    for (size_t idx = 0; idx != scene.item_positions.size(); ++idx) {
+        lost_objects.emplace_back(0, scene.item_positions[idx], idx, scene.item_widths[idx]);
+    }
+    session->RestoreLostObjects(std::move(lost_objects), scene.item_positions.size());
+    return session;
+}
+
+/* События по предметам рядом с собаками, item_id - индекс предмета в сцене */
+std::vector<GatheringEvent> FindNearbyEvents(model::GameSession& session,
+                                             const std::vector<collision_detector::Gatherer>& gatherers,
+                                             bool fixed_point) {
+    const std::vector<model::GameSession::LostObjectKey> nearby = session.FindLostObjectsNear(gatherers);
+    const model::GameSession::LostObjects& objects = session.GetLostObjects();
+    std::vector<model::Position> positions;
+    std::vector<double> widths;
+    for (const auto& key : nearby) {
+        positions.push_back(objects[key].GetPosition());
+        widths.push_back(objects[key].GetWidth());
+    }
+    std::vector<GatheringEvent> events = collision_detector::FindGatherEvents(positions, widths, gatherers, fixed_point);
+    for (GatheringEvent& event : events) {
+        event.item_id = objects[nearby[event.item_id]].GetId();
+    }
+    return events;
+}
+
+} // namespace
+
+TEST_CASE("Collision scenes", "[benchmark]") {
+    for (const collision_scenes::SceneParams& params : collision_scenes::GetScenes()) {
+        const collision_scenes::Scene scene = collision_scenes::MakeScene(params);
+        const std::vector<double> office_widths = scene.map->GetOfficeWidths();
+        const std::vector<model::Position> office_positions = scene.map->GetOfficePositions();
+        const auto session = MakeSession(scene);
+        const Provider provider(scene);
+        INFO("scene: " << params.name);
+
+        for (const bool fixed_point : {false, true}) {
+            INFO("fixed point: " << fixed_point);
+            const std::vector<GatheringEvent> expected = collision_scenes::BruteForceEvents(
+                scene.item_positions, scene.item_widths, scene.gatherers, fixed_point);
+            for (const BroadPhase broad_phase : {BroadPhase::NONE, BroadPhase::GRID, BroadPhase::AUTO}) {
+                CHECK(collision_scenes::SameEvents(collision_detector::FindGatherEvents(
+                    scene.item_positions, scene.item_widths, scene.gatherers, fixed_point, broad_phase), expected));
+            }
+            CHECK(collision_scenes::SameEvents(collision_detector::FindGatherEvents(provider, fixed_point), expected));
+            CHECK(collision_scenes::SameEvents(FindNearbyEvents(*session, scene.gatherers, fixed_point), expected));
+
+            BagsHandler handler(scene.gatherers.size());
+            collision_detector::ProcessGatherEvents(scene.item_positions, scene.item_widths, scene.gatherers,
+                                                    handler, fixed_point);
+            CHECK(collision_scenes::SameEvents(handler.pickups, collision_scenes::BruteForcePickups(
+                scene.item_positions, scene.item_widths, scene.gatherers, fixed_point, BAG_CAPACITY)));
+
+            CHECK(collision_scenes::SameEvents(
+                collision_detector::FindGatherEvents(office_positions, office_widths, scene.gatherers, fixed_point),
+                collision_scenes::BruteForceEvents(office_positions, office_widths, scene.gatherers, fixed_point)));
+        }
+
+        const std::string suffix = ", "s + params.name + " (dogs: "s + std::to_string(params.dogs) +
+                                   ", items: "s + std::to_string(params.items) + ")"s;
+        BENCHMARK("Brute force oracle"s + suffix) {
+            return collision_scenes::BruteForceEvents(scene.item_positions, scene.item_widths, scene.gatherers, false).size();
+        };
+        BENCHMARK("FindGatherEvents provider"s + suffix) {
+            return collision_detector::FindGatherEvents(provider).size();
+        };
+        const std::pair<BroadPhase, std::string> broad_phases[] = {
+            {BroadPhase::NONE, "none"s}, {BroadPhase::GRID, "grid"s}, {BroadPhase::AUTO, "auto"s}};
+        for (const auto& [broad_phase, name] : broad_phases) {
+            BENCHMARK("FindGatherEvents arrays, "s + name + suffix) {
+                return collision_detector::FindGatherEvents(scene.item_positions, scene.item_widths, scene.gatherers,
+                                                            false, broad_phase).size();
+            };
+        }
+        BENCHMARK("FindGatherEvents fixed point"s + suffix) {
+            return collision_detector::FindGatherEvents(scene.item_positions, scene.item_widths, scene.gatherers,
+                                                        true).size();
+        };
+        BENCHMARK("Nearby objects and FindGatherEvents"s + suffix) {
+            return FindNearbyEvents(*session, scene.gatherers, false).size();
+        };
+        BENCHMARK("ProcessGatherEvents with bags"s + suffix) {
+            BagsHandler handler(scene.gatherers.size());
+            collision_detector::ProcessGatherEvents(scene.item_positions, scene.item_widths, scene.gatherers, handler);
+            return handler.pickups.size();
+        };
+        BENCHMARK("Offices"s + suffix) {
+            return collision_detector::FindGatherEvents(office_positions, office_widths, scene.gatherers).size();
+        };
+    }
+}
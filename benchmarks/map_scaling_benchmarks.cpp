@@ -0,0 +1,176 @@
+/*
+ * Замеры масштабируемости по размеру карты на синтетических картах-городах (map_generator):
+ * - загрузка конфигурации json_loader::LoadGame() и память, занятая картой
+ * - загрузка той же игры из двоичного набора карт map_bundle::LoadBundle() (холодный старт без разбора JSON)
+ * - тик на карте: перемещение собак, поиск дорог по позиции, сбор предметов
+ * - формирование JSON карты для /api/v1/maps/{id}
+ * Карты с 10^3 - 10^5 дорог замеряются всегда, карта с 10^6 дорог - только по тегу [large].
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_message.hpp>
+
+#include "../src/collision_detector.h"
+#include "../src/json_loader.h"
+#include "../src/map_bundle.h"
+#include "../src/map_generator/map_generator.h"
+#include "../src/model.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+using namespace std::literals;
+
+namespace {
+
+constexpr double TICK = 0.05; // 50 мс
+constexpr size_t DOGS_COUNT = 1000;
+
+std::filesystem::path WriteGeneratedConfig(size_t roads_count) {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() /
+                                       ("generated_city_"s + std::to_string(roads_count) + ".json"s);
+    std::ofstream out(path);
+    map_generator::WriteConfig(out, {map_generator::GenerateMap(map_generator::MakeCityParams("city"s, roads_count))});
+    return path;
+}
+
+/* Память процесса в ОЗУ (resident set size) в байтах, 0 - если её не узнать */
+size_t ResidentMemory() {
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    size_t total_pages = 0;
+    size_t resident_pages = 0;
+    if (statm >> total_pages >> resident_pages) {
+        return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+    return 0;
+}
+
+class Gathering : public collision_detector::ItemGathererProvider {
+public:
+    Gathering(std::vector<collision_detector::Item> items, std::vector<collision_detector::Gatherer> gatherers)
+        : items_(std::move(items))
+        , gatherers_(std::move(gatherers)) {}
+
+    size_t ItemsCount() const override {
+        return items_.size();
+    }
+    collision_detector::Item GetItem(size_t idx) const override {
+        return items_[idx];
+    }
+    size_t GatherersCount() const override {
+        return gatherers_.size();
+    }
+    collision_detector::Gatherer GetGatherer(size_t idx) const override {
+        return gatherers_[idx];
+    }
+
+private:
+    std::vector<collision_detector::Item> items_;
+    std::vector<collision_detector::Gatherer> gatherers_;
+};
+
+model::DogsMovement PrepareDogs(const model::Map& map) {
+    const model::Velocity speeds[] = {{0., -3.}, {0., 3.}, {-3., 0.}, {3., 0.}};
+    const model::Direction directions[] = {model::Direction::NORTH, model::Direction::SOUTH,
+                                           model::Direction::WEST, model::Direction::EAST};
+    model::DogsMovement dogs;
+    for (size_t i = 0; i != DOGS_COUNT; ++i) {
+        dogs.Add({map.GetRandomPositionOnRoads(), speeds[i % 4], directions[i % 4]});
+    }
+    return dogs;
+}
+
+Gathering PrepareGathering(const model::Map& map, const model::DogsMovement& dogs) {
+    std::vector<collision_detector::Item> items;
+    std::vector<collision_detector::Gatherer> gatherers;
+    for (size_t i = 0; i != dogs.Size(); ++i) {
+        items.emplace_back(map.GetRandomLootType(), map.GetRandomPositionOnRoads(), i);
+        const model::Position start{dogs.pos_x[i], dogs.pos_y[i]};
+        const model::Position end{start.x + dogs.speed_x[i] * TICK, start.y + dogs.speed_y[i] * TICK};
+        gatherers.push_back({start, end, model::LostObject::GATHERER_HALF_WIDTH});
+    }
+    return Gathering(std::move(items), std::move(gatherers));
+}
+
+void BenchmarkMapScale(size_t roads_count) {
+    const std::filesystem::path config_path = WriteGeneratedConfig(roads_count);
+    const std::string suffix = ", roads: "s + std::to_string(roads_count);
+
+    const size_t memory_before = ResidentMemory();
+    const model::Game game = json_loader::LoadGame(config_path);
+    const size_t memory_after = ResidentMemory();
+    const model::Map& map = game.GetMaps().front();
+    /* ОЗУ процесса может и уменьшиться (аллокатор вернул страницы системе), поэтому разность со знаком */
+    const long long resident_delta = static_cast<long long>(memory_after) - static_cast<long long>(memory_before);
+    WARN("Map memory" << suffix << ": " << resident_delta / 1024 << " KiB resident, "
+                      << map.GetMemoryUsage() / 1024 << " KiB by Map::GetMemoryUsage() ("
+                      << map.GetRoads().size() << " roads, " << map.GetBuildings().size() << " buildings, "
+                      << map.GetOffices().size() << " offices)");
+
+    BENCHMARK("LoadGame"s + suffix) {
+        return json_loader::LoadGame(config_path).GetMaps().size();
+    };
+
+    std::filesystem::path bundle_path = config_path;
+    bundle_path.replace_extension(".bundle");
+    map_bundle::WriteBundle(bundle_path, game);
+    BENCHMARK("LoadBundle"s + suffix) {
+        return map_bundle::LoadBundle(bundle_path).GetMaps().size();
+    };
+    std::filesystem::remove(bundle_path);
+
+    const model::DogsMovement initial = PrepareDogs(map);
+    model::DogsMovement movement = initial;
+    BENCHMARK("MoveDogs, dogs: "s + std::to_string(DOGS_COUNT) + suffix) {
+        movement.pos_x = initial.pos_x;
+        movement.pos_y = initial.pos_y;
+        movement.speed_x = initial.speed_x;
+        movement.speed_y = initial.speed_y;
+        map.MoveDogs(movement, TICK);
+        return movement.pos_x.front();
+    };
+
+    BENCHMARK("GetRoadByPosition x "s + std::to_string(DOGS_COUNT) + suffix) {
+        size_t found = 0;
+        for (size_t i = 0; i != initial.Size(); ++i) {
+            found += map.GetRoadByPosition({initial.pos_x[i], initial.pos_y[i]}).size();
+        }
+        return found;
+    };
+
+    const Gathering gathering = PrepareGathering(map, initial);
+    BENCHMARK("FindGatherEvents, dogs and items: "s + std::to_string(DOGS_COUNT) + suffix) {
+        return collision_detector::FindGatherEvents(gathering).size();
+    };
+
+    BENCHMARK("Map JSON"s + suffix) {
+        boost::json::object map_json;
+        map_json["roads"] = json_loader::GetRoadsArray(map);
+        map_json["buildings"] = json_loader::GetBuildingsArray(map);
+        map_json["offices"] = json_loader::GetOfficesArray(map);
+        return boost::json::serialize(map_json).size();
+    };
+
+    std::filesystem::remove(config_path);
+}
+
+} // namespace
+
+TEST_CASE("Map scaling", "[benchmark]") {
+    for (size_t roads_count : {1'000u, 10'000u, 100'000u}) {
+        BenchmarkMapScale(roads_count);
+    }
+}
+
+TEST_CASE("Map scaling, city-sized map", "[.][benchmark][large]") {
+    BenchmarkMapScale(1'000'000u);
+}
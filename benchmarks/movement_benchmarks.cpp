@@ -0,0 +1,108 @@
+/*
+ * Замеры стоимости одного тика перемещения собак:
+ * - по одной собаке через Map::MoveDog()
+ * - всех собак сессии за один проход через Map::MoveDogs()
+ * - полный тик приложения (Application::MoveDogs): перемещение, подбор, офисы, учёт времени
+ * Перед каждым замером состояния собак восстанавливаются, чтобы собаки не останавливались у концов дорог.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "../src/model.h"
+#include "../src/players.h"
+#include "../tests/grid_map.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+constexpr double TICK = 0.05; // 50 мс
+
+std::vector<model::DogState> PrepareDogStates(const model::Map& map, size_t count) {
+    const model::Velocity speeds[] = {{0., -3.}, {0., 3.}, {-3., 0.}, {3., 0.}};
+    const model::Direction directions[] = {model::Direction::NORTH, model::Direction::SOUTH,
+                                           model::Direction::WEST, model::Direction::EAST};
+    std::vector<model::DogState> states;
+    states.reserve(count);
+    for (size_t i = 0; i != count; ++i) {
+        states.push_back({map.GetRandomPositionOnRoads(), speeds[i % 4], directions[i % 4]});
+    }
+    return states;
+}
+
+void BenchmarkMovement(size_t dogs_count) {
+    const model::Map map = grid_map::MakeGridMap(100, 20);
+    const std::vector<model::DogState> states = PrepareDogStates(map, dogs_count);
+
+    std::vector<std::shared_ptr<model::Dog>> dogs;
+    model::DogsMovement initial;
+    for (size_t i = 0; i != states.size(); ++i) {
+        dogs.emplace_back(std::make_shared<model::Dog>(i, "dog"s, states[i].position));
+        initial.Add(states[i]);
+    }
+
+    BENCHMARK("MoveDog, dogs: "s + std::to_string(dogs_count)) {
+        for (size_t i = 0; i != dogs.size(); ++i) {
+            dogs[i]->SetState(states[i]);
+            dogs[i]->SetState(map.MoveDog(dogs[i], TICK));
+        }
+        return dogs.front()->GetDogState().position.x;
+    };
+
+    model::DogsMovement movement = initial;
+    BENCHMARK("MoveDogs, dogs: "s + std::to_string(dogs_count)) {
+        movement.pos_x = initial.pos_x;
+        movement.pos_y = initial.pos_y;
+        movement.speed_x = initial.speed_x;
+        movement.speed_y = initial.speed_y;
+        map.MoveDogs(movement, TICK);
+        return movement.pos_x.front();
+    };
+}
+
+class NullRepository : public players::ApplicationRepository {
+public:
+    void Save([[maybe_unused]] const players::Champion& result) override {}
+    std::vector<players::Champion> GetChampions([[maybe_unused]] size_t start,
+                                                [[maybe_unused]] size_t max_items) override {
+        return {};
+    }
+};
+
+} // namespace
+
+TEST_CASE("Dogs movement tick", "[benchmark]") {
+    for (size_t dogs_count : {1'000u, 10'000u, 100'000u}) {
+        BenchmarkMovement(dogs_count);
+    }
+}
+
+TEST_CASE("Application tick", "[benchmark]") {
+    for (size_t dogs_count : {1'000u, 10'000u}) {
+        model::Map map = grid_map::MakeGridMap(100, 20);
+        map.AddLootType(model::LootType{"key"sv, "key.obj"sv, "obj"sv, std::nullopt, std::nullopt, 0.1, 5});
+        map.AddOffice({model::Office::Id{"o0"s}, {0, 0}, {5, 0}});
+        model::Game game;
+        game.AddMap(std::move(map));
+        game.SetLootGenerator(std::chrono::milliseconds{5000}, 0.5);
+        game.SetDogRetirementTime(1e9);
+        NullRepository repository;
+        players::Application app(game, true, false, 50, std::nullopt, repository);
+        const players::ActionMove actions[] = {players::ActionMove::LEFT, players::ActionMove::RIGHT,
+                                               players::ActionMove::UP, players::ActionMove::DOWN};
+        for (size_t i = 0; i != dogs_count; ++i) {
+            const players::JoinGameResult joined = app.JoinPlayerToGame(model::Map::Id{"grid"s}, "dog"s + std::to_string(i));
+            app.SetDogAction(app.FindPlayerByToken(*joined.player_token), actions[i % 4]);
+        }
+
+        BENCHMARK("Application::MoveDogs, dogs: "s + std::to_string(dogs_count)) {
+            app.MoveDogs(TICK);
+            return game.GetSessions().size();
+        };
+    }
+}
@@ -0,0 +1,78 @@
+/*
+ * Замеры появления объектов на карте:
+ * - выбор случайной точки на дорогах (вход игрока в игру и появление потерянной вещи)
+ * - появление потерянных вещей в сессии за один тик генератора
+ * - тик генераторов тихих сессий, которым нечего создавать
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "../src/model.h"
+#include "../tests/grid_map.h"
+
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+model::Map PrepareGridMap(int size, int step) {
+    model::Map map = grid_map::MakeGridMap(size, step);
+    map.AddLootType(model::LootType{"key"sv, "key.obj"sv, "obj"sv, 0, "#338844"sv, 0.03, 10});
+    map.AddLootType(model::LootType{"wallet"sv, "wallet.obj"sv, "obj"sv, 0, "#883344"sv, 0.01, 30});
+    return map;
+}
+
+} // namespace
+
+TEST_CASE("Random positions on roads", "[benchmark]") {
+    const model::Map map = PrepareGridMap(100, 20);
+
+    BENCHMARK("GetRandomPositionOnRoads x 1000") {
+        double sum = 0.;
+        for (int i = 0; i != 1000; ++i) {
+            sum += map.GetRandomPositionOnRoads().x;
+        }
+        return sum;
+    };
+}
+
+TEST_CASE("Lost objects spawn", "[benchmark]") {
+    model::Map map = PrepareGridMap(100, 20);
+    loot_gen::LootGenerator loot_generator{1s, 1.};
+
+    /* генератор с вероятностью 1 выдаёт по вещи на каждую собаку сессии без вещей */
+    BENCHMARK_ADVANCED("AddLostObjectsOnSession, 1000 dogs")(Catch::Benchmark::Chronometer meter) {
+        std::vector<model::GameSession> sessions(meter.runs(), model::GameSession(&map, 0, loot_generator));
+        for (model::GameSession& session : sessions) {
+            for (size_t dog_id = 0; dog_id != 1000; ++dog_id) {
+                session.AddDog(model::Dog(dog_id, "dog"s, {}));
+            }
+        }
+        meter.measure([&sessions](int run) {
+            sessions[run].AddLostObjectsOnSession(1s);
+            return sessions[run].CountLostObjects();
+        });
+    };
+}
+
+TEST_CASE("Quiet sessions loot tick", "[benchmark]") {
+    model::Map map = PrepareGridMap(100, 20);
+    const loot_gen::LootGenerator loot_generator{5s, 0.5};
+
+    /* в каждой сессии собака и потерянная вещь: вещей хватает, новых не будет */
+    std::vector<model::GameSession> sessions(1000, model::GameSession(&map, 0, loot_generator));
+    for (size_t idx = 0; idx != sessions.size(); ++idx) {
+        sessions[idx].AddDog(model::Dog(idx, "dog"s, {}));
+        sessions[idx].RestoreLostObjects({model::LostObject(0, map.GetRandomPositionOnRoads(), 0)}, 1);
+    }
+    BENCHMARK("AddLostObjectsOnSession, 1000 quiet sessions") {
+        size_t lost_objects = 0;
+        for (model::GameSession& session : sessions) {
+            session.AddLostObjectsOnSession(50ms);
+            lost_objects += session.CountLostObjects();
+        }
+        return lost_objects;
+    };
+}
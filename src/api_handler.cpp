@@ -235,7 +235,8 @@ namespace http_handler {
             }
         }
 
-        return text_response(http::status::ok, json_loader::GetPlayerAddedAnswer(**(result.player_token), result.dog_id));
+        return text_response(http::status::ok, json_loader::GetPlayerAddedAnswer(**(result.player_token), result.dog_id,
+                                                                                          result.instance_id));
     }
 
     /*
@@ -249,7 +250,7 @@ namespace http_handler {
                                                          std::string allowed_methods = "GET, HEAD"s) {
             return MakeStringResponse(status, text, version, keep_alive, ContentType::JSON, length, allowed_methods);
         };
-       players::Application::Dogs dogs = app_.GetDogsInSession(found_player);
+       const model::SessionDogs& dogs = app_.GetDogsInSession(found_player);
         if (head_only) {
             return text_response(http::status::ok, "", json_loader::GetSessionPlayers(dogs).length());
         }
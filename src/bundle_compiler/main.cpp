@@ -0,0 +1,54 @@
+/*
+ * bundle_compiler - собирает двоичный набор карт (map_bundle.h) из JSON-конфигурации игры:
+ * --config-file (-c) путь к конфигурационному JSON-файлу игры
+ * --output (-o) путь к файлу набора
+ * Сервер загружает набор опцией --map-bundle вместо --config-file.
+ */
+#include "../json_loader.h"
+#include "../map_bundle.h"
+
+#include <boost/program_options.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace std::literals;
+
+int main(int argc, const char* argv[]) {
+    namespace po = boost::program_options;
+
+    std::string config_file;
+    std::string output;
+
+    po::options_description desc{"Allowed options"};
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("config-file,c", po::value(&config_file)->value_name("file"s), "set config file path")
+        ("output,o", po::value(&output)->value_name("file"s), "set map bundle file path");
+
+    try {
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+        if (vm.contains("help"s)) {
+            std::cout << desc;
+            return EXIT_SUCCESS;
+        }
+        if (!vm.contains("config-file"s) || !vm.contains("output"s)) {
+            throw std::runtime_error("config-file and output must be specified"s);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const model::Game game = json_loader::LoadGame(config_file);
+        map_bundle::WriteBundle(output, game);
+        const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        std::cout << "Maps: " << game.GetMaps().size() << ", bundle " << output
+                  << " written in " << duration.count() << " ms" << std::endl;
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
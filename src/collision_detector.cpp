@@ -1,5 +1,15 @@
 #include "collision_detector.h"
+
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <tuple>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define COLLISION_DETECTOR_X86_64
+#include <immintrin.h>
+#endif
 
 namespace collision_detector {
 
@@ -23,31 +33,459 @@ namespace collision_detector {
         return CollectionResult(sq_distance, proj_ratio);
     }
 
-    std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider) {
-        std::vector<GatheringEvent> events;
+    /* Произведения разностей координат превышают 64 бита, поэтому считаем их в 128-битных целых (GCC, Clang) */
+    CollectionResult TryCollectPoint(fixed_point::Point a, fixed_point::Point b, fixed_point::Point c) {
+        using Wide = __int128;
+        assert(b.x != a.x || b.y != a.y);
+        const Wide u_x = c.x - a.x;
+        const Wide u_y = c.y - a.y;
+        const Wide v_x = b.x - a.x;
+        const Wide v_y = b.y - a.y;
+        const Wide u_dot_v = u_x * v_x + u_y * v_y;
+        const Wide u_len2 = u_x * u_x + u_y * u_y;
+        const Wide v_len2 = v_x * v_x + v_y * v_y;
+        const double one2 = static_cast<double>(fixed_point::ONE) * static_cast<double>(fixed_point::ONE);
+        const double proj_ratio = static_cast<double>(u_dot_v) / static_cast<double>(v_len2);
+        /* |u|^2 - (u.v)^2 / |v|^2 = (|u|^2 * |v|^2 - (u.v)^2) / |v|^2, числитель вычисляется точно */
+        const double sq_distance = static_cast<double>(u_len2 * v_len2 - u_dot_v * u_dot_v) /
+                                   static_cast<double>(v_len2) / one2;
 
-        for (size_t g_idx = 0; g_idx != provider.GatherersCount(); ++g_idx) {
-            const auto &gatherer = provider.GetGatherer(g_idx);
-            if ((gatherer.start_pos.x == gatherer.end_pos.x) &&
-                (gatherer.start_pos.y == gatherer.end_pos.y)) {
-                continue;
+        return CollectionResult(sq_distance, proj_ratio);
+    }
+
+    namespace {
+        /* Пакетные ядра читают координаты точек парами x, y подряд */
+        static_assert(sizeof(model::Position) == 2 * sizeof(double));
+
+        void AddHit(CollectionHits& hits, size_t idx, double sq_distance, double proj_ratio) {
+            hits.indices.push_back(idx);
+            hits.results.push_back(CollectionResult(sq_distance, proj_ratio));
+        }
+
+        void CollectPointsScalar(model::Position a, model::Position b, std::span<const model::Position> points,
+                                 std::span<const double> widths, double gatherer_width, size_t from,
+                                 CollectionHits& hits) {
+            for (size_t idx = from; idx != points.size(); ++idx) {
+                const CollectionResult result = TryCollectPoint(a, b, points[idx]);
+                if (result.IsCollected(gatherer_width + widths[idx])) {
+                    AddHit(hits, idx, result.sq_distance, result.proj_ratio);
+                }
+            }
+        }
+
+#ifdef COLLISION_DETECTOR_X86_64
+        /* По две точки за шаг; возвращает индекс первой непроверенной точки */
+        size_t CollectPointsSse2(model::Position a, model::Position b, std::span<const model::Position> points,
+                                 std::span<const double> widths, double gatherer_width, CollectionHits& hits) {
+            const double v_x = b.x - a.x;
+            const double v_y = b.y - a.y;
+            const __m128d ax = _mm_set1_pd(a.x);
+            const __m128d ay = _mm_set1_pd(a.y);
+            const __m128d vx = _mm_set1_pd(v_x);
+            const __m128d vy = _mm_set1_pd(v_y);
+            const __m128d v_len2 = _mm_set1_pd(v_x * v_x + v_y * v_y);
+            const __m128d gw = _mm_set1_pd(gatherer_width);
+            const __m128d zero = _mm_setzero_pd();
+            const __m128d one = _mm_set1_pd(1.);
+
+            size_t idx = 0;
+            for (; idx + 2 <= points.size(); idx += 2) {
+                const __m128d p0 = _mm_loadu_pd(&points[idx].x);
+                const __m128d p1 = _mm_loadu_pd(&points[idx + 1].x);
+                const __m128d ux = _mm_sub_pd(_mm_unpacklo_pd(p0, p1), ax);
+                const __m128d uy = _mm_sub_pd(_mm_unpackhi_pd(p0, p1), ay);
+                const __m128d u_dot_v = _mm_add_pd(_mm_mul_pd(ux, vx), _mm_mul_pd(uy, vy));
+                const __m128d u_len2 = _mm_add_pd(_mm_mul_pd(ux, ux), _mm_mul_pd(uy, uy));
+                const __m128d proj_ratio = _mm_div_pd(u_dot_v, v_len2);
+                const __m128d sq_distance = _mm_sub_pd(u_len2, _mm_div_pd(_mm_mul_pd(u_dot_v, u_dot_v), v_len2));
+                const __m128d radius = _mm_add_pd(gw, _mm_loadu_pd(&widths[idx]));
+                const __m128d collected = _mm_and_pd(_mm_and_pd(_mm_cmpge_pd(proj_ratio, zero),
+                                                                _mm_cmple_pd(proj_ratio, one)),
+                                                     _mm_cmple_pd(sq_distance, _mm_mul_pd(radius, radius)));
+                const int mask = _mm_movemask_pd(collected);
+                if (mask != 0) {
+                    alignas(16) double proj[2];
+                    alignas(16) double sq[2];
+                    _mm_store_pd(proj, proj_ratio);
+                    _mm_store_pd(sq, sq_distance);
+                    for (size_t lane = 0; lane != 2; ++lane) {
+                        if ((mask & (1 << lane)) != 0) {
+                            AddHit(hits, idx + lane, sq[lane], proj[lane]);
+                        }
+                    }
+                }
+            }
+            return idx;
+        }
+
+        /* По четыре точки за шаг. FMA не включается: произведения и суммы округляются, как в TryCollectPoint() */
+        __attribute__((target("avx2")))
+        size_t CollectPointsAvx2(model::Position a, model::Position b, std::span<const model::Position> points,
+                                 std::span<const double> widths, double gatherer_width, CollectionHits& hits) {
+            const double v_x = b.x - a.x;
+            const double v_y = b.y - a.y;
+            const __m256d ax = _mm256_set1_pd(a.x);
+            const __m256d ay = _mm256_set1_pd(a.y);
+            const __m256d vx = _mm256_set1_pd(v_x);
+            const __m256d vy = _mm256_set1_pd(v_y);
+            const __m256d v_len2 = _mm256_set1_pd(v_x * v_x + v_y * v_y);
+            const __m256d gw = _mm256_set1_pd(gatherer_width);
+            const __m256d zero = _mm256_setzero_pd();
+            const __m256d one = _mm256_set1_pd(1.);
+
+            size_t idx = 0;
+            for (; idx + 4 <= points.size(); idx += 4) {
+                // (x0 y0 x1 y1), (x2 y2 x3 y3) -> (x0 x2 x1 x3) -> (x0 x1 x2 x3)
+                const __m256d p01 = _mm256_loadu_pd(&points[idx].x);
+                const __m256d p23 = _mm256_loadu_pd(&points[idx + 2].x);
+                const __m256d cx = _mm256_permute4x64_pd(_mm256_unpacklo_pd(p01, p23), 0xD8);
+                const __m256d cy = _mm256_permute4x64_pd(_mm256_unpackhi_pd(p01, p23), 0xD8);
+                const __m256d ux = _mm256_sub_pd(cx, ax);
+                const __m256d uy = _mm256_sub_pd(cy, ay);
+                const __m256d u_dot_v = _mm256_add_pd(_mm256_mul_pd(ux, vx), _mm256_mul_pd(uy, vy));
+                const __m256d u_len2 = _mm256_add_pd(_mm256_mul_pd(ux, ux), _mm256_mul_pd(uy, uy));
+                const __m256d proj_ratio = _mm256_div_pd(u_dot_v, v_len2);
+                const __m256d sq_distance = _mm256_sub_pd(u_len2,
+                                                          _mm256_div_pd(_mm256_mul_pd(u_dot_v, u_dot_v), v_len2));
+                const __m256d radius = _mm256_add_pd(gw, _mm256_loadu_pd(&widths[idx]));
+                const __m256d collected = _mm256_and_pd(_mm256_and_pd(_mm256_cmp_pd(proj_ratio, zero, _CMP_GE_OQ),
+                                                                      _mm256_cmp_pd(proj_ratio, one, _CMP_LE_OQ)),
+                                                        _mm256_cmp_pd(sq_distance, _mm256_mul_pd(radius, radius),
+                                                                      _CMP_LE_OQ));
+                const int mask = _mm256_movemask_pd(collected);
+                if (mask != 0) {
+                    alignas(32) double proj[4];
+                    alignas(32) double sq[4];
+                    _mm256_store_pd(proj, proj_ratio);
+                    _mm256_store_pd(sq, sq_distance);
+                    for (size_t lane = 0; lane != 4; ++lane) {
+                        if ((mask & (1 << lane)) != 0) {
+                            AddHit(hits, idx + lane, sq[lane], proj[lane]);
+                        }
+                    }
+                }
             }
-            for (size_t i_idx = 0; i_idx != provider.ItemsCount(); ++i_idx) {
-                auto coll_res = TryCollectPoint(gatherer.start_pos,
-                                                gatherer.end_pos,
-                                                provider.GetItem(i_idx).GetPosition());
-                if (coll_res.IsCollected(gatherer.width + provider.GetItem(i_idx).GetWidth())) {
+            return idx;
+        }
+
+        bool HasAvx2() noexcept {
+            static const bool has_avx2 = __builtin_cpu_supports("avx2");
+            return has_avx2;
+        }
+#endif
+
+        fixed_point::Point ToFixed(const model::Position& pos) {
+            return {fixed_point::FromDouble(pos.x), fixed_point::FromDouble(pos.y)};
+        }
+
+        /* Запас к радиусу сбора при отборе клеток: покрывает округление координат до 1/1024
+         * в режиме фиксированной точки и погрешность расчёта расстояния в double */
+        constexpr double GRID_MARGIN = 2. / static_cast<double>(fixed_point::ONE);
+
+        /* Предметы, разложенные по клеткам равномерной сетки. Записи отсортированы по строке, столбцу клетки
+         * и индексу предмета, поэтому клетки одной строки ищутся одним двоичным поиском */
+        class ItemGrid {
+        public:
+            ItemGrid(std::span<const model::Position> positions, double cell_size)
+                : cell_size_(cell_size) {
+                cells_.reserve(positions.size());
+                for (size_t idx = 0; idx != positions.size(); ++idx) {
+                    cells_.push_back({ToCell(positions[idx].y), ToCell(positions[idx].x), idx});
+                }
+                std::sort(cells_.begin(), cells_.end(), Less);
+            }
+
+            /* Индексы предметов (по возрастанию) из клеток, которые задевает прямоугольник [min, max].
+             * Если таких клеток больше, чем предметов, полный перебор дешевле - тогда возвращает false */
+            bool FindItems(const model::Position& min, const model::Position& max, std::vector<size_t>& items) const {
+                const Coord x0 = ToCell(min.x);
+                const Coord x1 = ToCell(max.x);
+                const Coord y0 = ToCell(min.y);
+                const Coord y1 = ToCell(max.y);
+                if (static_cast<double>(x1 - x0 + 1) * static_cast<double>(y1 - y0 + 1) >
+                    static_cast<double>(cells_.size())) {
+                    return false;
+                }
+                items.clear();
+                for (Coord y = y0; y <= y1; ++y) {
+                    auto it = std::lower_bound(cells_.begin(), cells_.end(), Entry{y, x0, 0}, Less);
+                    for (; (it != cells_.end()) && (it->row == y) && (it->column <= x1); ++it) {
+                        items.push_back(it->item);
+                    }
+                }
+                std::sort(items.begin(), items.end());
+                return true;
+            }
+
+        private:
+            using Coord = std::int64_t;
+            struct Entry {
+                Coord row;
+                Coord column;
+                size_t item;
+            };
+            static bool Less(const Entry& left, const Entry& right) noexcept {
+                return std::tie(left.row, left.column, left.item) < std::tie(right.row, right.column, right.item);
+            }
+            Coord ToCell(double value) const noexcept {
+                return static_cast<Coord>(std::floor(value / cell_size_));
+            }
+
+            double cell_size_;
+            std::vector<Entry> cells_;
+        };
+    } // namespace
+
+    bool IsBatchKernelSupported(BatchKernel kernel) noexcept {
+        switch (kernel) {
+        case BatchKernel::SCALAR:
+        case BatchKernel::AUTO:
+            return true;
+#ifdef COLLISION_DETECTOR_X86_64
+        case BatchKernel::SSE2:
+            return true;
+        case BatchKernel::AVX2:
+            return HasAvx2();
+#endif
+        default:
+            return false;
+        }
+    }
+
+    void TryCollectPoints(model::Position a, model::Position b, std::span<const model::Position> points,
+                          std::span<const double> widths, double gatherer_width, CollectionHits& hits,
+                          BatchKernel kernel) {
+        assert(b.x != a.x || b.y != a.y);
+        assert(points.size() == widths.size());
+        size_t from = 0;
+#ifdef COLLISION_DETECTOR_X86_64
+        if (kernel == BatchKernel::AUTO) {
+            kernel = HasAvx2() ? BatchKernel::AVX2 : BatchKernel::SSE2;
+        }
+        if ((kernel == BatchKernel::AVX2) && HasAvx2()) {
+            from = CollectPointsAvx2(a, b, points, widths, gatherer_width, hits);
+        } else if (kernel == BatchKernel::SSE2) {
+            from = CollectPointsSse2(a, b, points, widths, gatherer_width, hits);
+        }
+#endif
+        CollectPointsScalar(a, b, points, widths, gatherer_width, from, hits);
+    }
+
+    namespace {
+        /* Проверка перемещения собирателя g_idx из start в end с предметами points: со всеми или только
+         * с candidates (если не nullptr). Шаблон по типу точки: в цикле нет ветвления по режиму
+         * и виртуальных вызовов, TryCollectPoint() встраивается */
+        template <typename Point>
+        void CollectItems(Point start, Point end, std::span<const Point> points, std::span<const double> widths,
+                          double gatherer_width, size_t g_idx, const std::vector<size_t>* candidates,
+                          std::vector<GatheringEvent>& events) {
+            auto try_collect = [&](size_t i_idx) {
+                const CollectionResult coll_res = TryCollectPoint(start, end, points[i_idx]);
+                if (coll_res.IsCollected(gatherer_width + widths[i_idx])) {
                     events.emplace_back(GatheringEvent(i_idx,
                                                        g_idx,
                                                        coll_res.sq_distance,
                                                        coll_res.proj_ratio));
                 }
+            };
+            if (candidates != nullptr) {
+                for (const size_t i_idx : *candidates) {
+                    try_collect(i_idx);
+                }
+            } else {
+                for (size_t i_idx = 0; i_idx != points.size(); ++i_idx) {
+                    try_collect(i_idx);
+                }
             }
         }
-        std::sort(events.begin(), events.end(), [](const GatheringEvent &left, const GatheringEvent &right) {
+
+        /* Подготовленные для поиска событий предметы: координаты в фиксированной точке и сетка (broad phase).
+         * С сеткой клетка вдвое больше наибольшего радиуса сбора, поэтому короткое перемещение
+         * задевает несколько клеток. Предметы каждого собирателя проверяются по возрастанию индекса,
+         * как и при полном переборе, поэтому события совпадают при любом broad_phase */
+        class EventCollector {
+        public:
+            EventCollector(std::span<const model::Position> item_positions, std::span<const double> item_widths,
+                           std::span<const Gatherer> gatherers, bool fixed_point, BroadPhase broad_phase)
+                : item_positions_(item_positions)
+                , item_widths_(item_widths)
+                , gatherers_(gatherers)
+                , fixed_point_(fixed_point) {
+                assert(item_positions.size() == item_widths.size());
+                const size_t items_count = item_positions.size();
+                if (items_count != 0) {
+                    max_item_width_ = *std::max_element(item_widths.begin(), item_widths.end());
+                }
+                if (fixed_point) {
+                    fixed_positions_.reserve(items_count);
+                    for (const model::Position& pos : item_positions) {
+                        fixed_positions_.push_back(ToFixed(pos));
+                    }
+                }
+
+                double max_gatherer_width = 0.;
+                for (const Gatherer& gatherer : gatherers) {
+                    max_gatherer_width = std::max(max_gatherer_width, gatherer.width);
+                }
+                if ((items_count != 0) && ((broad_phase == BroadPhase::GRID) ||
+                                           ((broad_phase == BroadPhase::AUTO) && (gatherers.size() * items_count >= GRID_MIN_PAIRS)))) {
+                    grid_.emplace(item_positions, 2. * (max_gatherer_width + max_item_width_ + GRID_MARGIN));
+                }
+            }
+
+            /* Добавляет в events события собирателя g_idx в порядке индексов предметов */
+            void Collect(size_t g_idx, std::vector<GatheringEvent>& events) {
+                const Gatherer& gatherer = gatherers_[g_idx];
+                if ((gatherer.start_pos.x == gatherer.end_pos.x) &&
+                    (gatherer.start_pos.y == gatherer.end_pos.y)) {
+                    return;
+                }
+                fixed_point::Point start{};
+                fixed_point::Point end{};
+                if (fixed_point_) {
+                    start = ToFixed(gatherer.start_pos);
+                    end = ToFixed(gatherer.end_pos);
+                    if ((start.x == end.x) && (start.y == end.y)) {
+                        return; // перемещение меньше 1/1024
+                    }
+                }
+
+                const double reach = gatherer.width + max_item_width_ + GRID_MARGIN;
+                const bool use_grid = grid_ && grid_->FindItems({std::min(gatherer.start_pos.x, gatherer.end_pos.x) - reach,
+                                                                 std::min(gatherer.start_pos.y, gatherer.end_pos.y) - reach},
+                                                                {std::max(gatherer.start_pos.x, gatherer.end_pos.x) + reach,
+                                                                 std::max(gatherer.start_pos.y, gatherer.end_pos.y) + reach},
+                                                                candidates_);
+                const std::vector<size_t>* selected = use_grid ? &candidates_ : nullptr;
+                if (fixed_point_) {
+                    CollectItems<fixed_point::Point>(start, end, fixed_positions_, item_widths_, gatherer.width,
+                                                     g_idx, selected, events);
+                } else if (selected != nullptr) {
+                    CollectItems<model::Position>(gatherer.start_pos, gatherer.end_pos, item_positions_, item_widths_,
+                                                  gatherer.width, g_idx, selected, events);
+                } else {
+                    hits_.Clear();
+                    TryCollectPoints(gatherer.start_pos, gatherer.end_pos, item_positions_, item_widths_,
+                                     gatherer.width, hits_);
+                    for (size_t hit = 0; hit != hits_.indices.size(); ++hit) {
+                        events.emplace_back(GatheringEvent(hits_.indices[hit],
+                                                           g_idx,
+                                                           hits_.results[hit].sq_distance,
+                                                           hits_.results[hit].proj_ratio));
+                    }
+                }
+            }
+
+        private:
+            std::span<const model::Position> item_positions_;
+            std::span<const double> item_widths_;
+            std::span<const Gatherer> gatherers_;
+            bool fixed_point_;
+            double max_item_width_ = 0.;
+            std::vector<fixed_point::Point> fixed_positions_;
+            std::optional<ItemGrid> grid_;
+            std::vector<size_t> candidates_;
+            CollectionHits hits_;
+        };
+
+        bool EarlierEvent(const GatheringEvent& left, const GatheringEvent& right) noexcept {
             return left.time < right.time;
-        });
+        }
+    } // namespace
+
+    /* Предметы и собиратели один раз копируются из провайдера в массивы */
+    std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider, bool fixed_point,
+                                                 BroadPhase broad_phase) {
+        const size_t items_count = provider.ItemsCount();
+        std::vector<model::Position> positions;
+        std::vector<double> widths;
+        positions.reserve(items_count);
+        widths.reserve(items_count);
+        for (size_t i_idx = 0; i_idx != items_count; ++i_idx) {
+            const Item item = provider.GetItem(i_idx);
+            positions.push_back(item.GetPosition());
+            widths.push_back(item.GetWidth());
+        }
+
+        const size_t gatherers_count = provider.GatherersCount();
+        std::vector<Gatherer> gatherers;
+        gatherers.reserve(gatherers_count);
+        for (size_t g_idx = 0; g_idx != gatherers_count; ++g_idx) {
+            gatherers.push_back(provider.GetGatherer(g_idx));
+        }
+        return FindGatherEvents(positions, widths, gatherers, fixed_point, broad_phase);
+    }
+
+    std::vector<GatheringEvent> FindGatherEvents(std::span<const model::Position> item_positions,
+                                                 std::span<const double> item_widths,
+                                                 std::span<const Gatherer> gatherers,
+                                                 bool fixed_point, BroadPhase broad_phase) {
+        EventCollector collector(item_positions, item_widths, gatherers, fixed_point, broad_phase);
+        std::vector<GatheringEvent> events;
+        for (size_t g_idx = 0; g_idx != gatherers.size(); ++g_idx) {
+            collector.Collect(g_idx, events);
+        }
+        // события с равным временем остаются в порядке собирателей и предметов, поэтому результат
+        // не зависит от того, передан провайдеру весь список предметов или только предметы рядом с собаками
+        std::stable_sort(events.begin(), events.end(), EarlierEvent);
         return events;
     }
 
-} // namespace collision_detector
\ No newline at end of file
+    /* События каждого собирателя сортируются отдельно (их немного), затем сливаются кучей по (time, собиратель):
+     * порядок тот же, что у FindGatherEvents(). Общий вектор событий не сортируется, а события собирателя,
+     * которому больше ничего не нужно, не попадают в кучу */
+    void ProcessGatherEvents(std::span<const model::Position> item_positions, std::span<const double> item_widths,
+                             std::span<const Gatherer> gatherers, GatherEventHandler& handler,
+                             bool fixed_point, BroadPhase broad_phase) {
+        EventCollector collector(item_positions, item_widths, gatherers, fixed_point, broad_phase);
+        std::vector<GatheringEvent> events;
+        struct Range {
+            size_t next;
+            size_t end;
+        };
+        std::vector<Range> ranges; // события собирателей в events
+        for (size_t g_idx = 0; g_idx != gatherers.size(); ++g_idx) {
+            if (!handler.IsGathererActive(g_idx)) {
+                continue;
+            }
+            const size_t begin = events.size();
+            collector.Collect(g_idx, events);
+            if (events.size() != begin) {
+                std::stable_sort(events.begin() + static_cast<std::ptrdiff_t>(begin), events.end(), EarlierEvent);
+                ranges.push_back({begin, events.size()});
+            }
+        }
+
+        // в вершине кучи - диапазон с самым ранним следующим событием, при равном времени - с меньшим собирателем
+        auto later = [&events, &ranges](size_t left, size_t right) {
+            const GatheringEvent& l = events[ranges[left].next];
+            const GatheringEvent& r = events[ranges[right].next];
+            return std::tie(l.time, l.gatherer_id) > std::tie(r.time, r.gatherer_id);
+        };
+        std::vector<size_t> heap(ranges.size());
+        for (size_t idx = 0; idx != ranges.size(); ++idx) {
+            heap[idx] = idx;
+        }
+        std::make_heap(heap.begin(), heap.end(), later);
+
+        std::vector<bool> item_taken(item_positions.size(), false);
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), later);
+            Range& range = ranges[heap.back()];
+            const GatheringEvent& event = events[range.next++];
+            GatherDecision decision = GatherDecision::SKIP;
+            if (!item_taken[event.item_id]) {
+                decision = handler.OnEvent(event);
+                if (decision != GatherDecision::SKIP) {
+                    item_taken[event.item_id] = true;
+                }
+            }
+            if ((decision == GatherDecision::TAKE_AND_STOP) || (range.next == range.end)) {
+                heap.pop_back();
+            } else {
+                std::push_heap(heap.begin(), heap.end(), later);
+            }
+        }
+    }
+
+} // namespace collision_detector
@@ -1,15 +1,18 @@
 /*
  * Расчёт столкновений объектов, основная функция FindGatherEvents()
- * Для её запуска нужно создать объект класса унаследованного от ItemGathererProvider.
+ * Предметы передаются массивами позиций и радиусов, собиратели - массивом Gatherer.
+ * Для совместимости можно передать объект класса, унаследованного от ItemGathererProvider.
  * Возвращаемое значение: вектор событий столкновения собак (gatherer) и потерянных вещей (item),
  * идущих в хронологическом порядке от первого к последнему
  */
 #pragma once
 
+#include "fixed_point.h"
 #include "game_session.h"
 
 #include <algorithm>
 #include <optional>
+#include <span>
 #include <vector>
 
 namespace collision_detector {
@@ -26,6 +29,39 @@ namespace collision_detector {
     /* Движемся из точки a в точку b и пытаемся подобрать точку c (предмет).
      * Функция корректно работает только при условии ненулевого перемещения. */
     CollectionResult TryCollectPoint(model::Position a, model::Position b, model::Position c);
+    /* То же в целых числах с фиксированной точкой: промежуточные произведения точные (128 бит),
+     * результат переводится в double один раз и не зависит от компилятора и машины */
+    CollectionResult TryCollectPoint(fixed_point::Point a, fixed_point::Point b, fixed_point::Point c);
+
+    /* Подобранные при пакетной проверке точки: индексы по возрастанию и результаты для них */
+    struct CollectionHits {
+        std::vector<size_t> indices;
+        std::vector<CollectionResult> results;
+
+        void Clear() noexcept {
+            indices.clear();
+            results.clear();
+        }
+    };
+
+    /* Набор инструкций пакетной проверки. AUTO - лучший из поддерживаемых процессором:
+     * AVX2 (проверяется при запуске), иначе SSE2 на x86-64, иначе скалярный цикл */
+    enum class BatchKernel {
+        SCALAR,
+        SSE2,
+        AVX2,
+        AUTO
+    };
+    bool IsBatchKernelSupported(BatchKernel kernel) noexcept;
+
+    /* Движемся из точки a в точку b (перемещение ненулевое) и пытаемся подобрать точки points
+     * с радиусами widths собирателем радиуса gatherer_width. Подобранные точки (CollectionResult::IsCollected)
+     * добавляются в hits в порядке индексов. Векторные ядра выполняют те же операции double в том же порядке,
+     * что и TryCollectPoint(), поэтому результаты совпадают побитово (если сборка не включает FMA).
+     * Неподдерживаемый процессором набор инструкций заменяется скалярным циклом */
+    void TryCollectPoints(model::Position a, model::Position b, std::span<const model::Position> points,
+                          std::span<const double> widths, double gatherer_width, CollectionHits& hits,
+                          BatchKernel kernel = BatchKernel::AUTO);
 
     using Item = model::LostObject;
 
@@ -53,17 +89,61 @@ namespace collision_detector {
         double time;
     };
 
+    /* Предварительный отбор предметов (broad phase) для каждого собирателя */
+    enum class BroadPhase {
+        NONE, // собиратель проверяется со всеми предметами
+        GRID, // предметы раскладываются по равномерной сетке, проверяются только предметы из клеток,
+              // которые задевает перемещение собирателя
+        AUTO  // сетка, если пар собиратель-предмет не меньше GRID_MIN_PAIRS
+    };
+    /* Граница, с которой сетка быстрее полного перебора: по замеру "Gathering broad phase"
+     * сетка проигрывает при 4 собаках и 4 предметах (16 пар) и выигрывает уже с 6 собак и 6 предметов (36 пар) */
+    constexpr size_t GRID_MIN_PAIRS = 36;
+
     /* Функция возвращает вектор событий, идущих в хронологическом порядке.
      * Считается, что предметы остаются после столкновений на своём месте — событие добавляется в вектор,
      * даже если другой собиратель уже сталкивался с этим предметом.
-     * Порядок одновременно произошедших событий может быть любым.
+     * Одновременно произошедшие события идут по возрастанию индекса собирателя, затем предмета.
      *
      * Столкновение засчитывается при совпадении двух факторов:
      * 1) расстояние от предмета до прямой перемещения собирателя не превышает величины w + W,
      * где w — радиус предмета, а W — радиус собирателя,
      * 2) проекция предмета на прямую перемещения собирателя попадает на отрезок перемещения.
      * Если объект не переместился, считайте, что он не совершил столкновений.
-     * При этом учитывайте перемещение на любое ненулевое расстояние — погрешностью можно пренебречь.*/
-    std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider &provider);
+     * При этом учитывайте перемещение на любое ненулевое расстояние — погрешностью можно пренебречь.
+     * item_positions[i], item_widths[i] - позиция и радиус предмета i (item_id события).
+     * fixed_point == true - координаты переводятся в фиксированную точку и считаются в целых числах.
+     * broad_phase не влияет на результат: события и их порядок такие же, как при полном переборе */
+    std::vector<GatheringEvent> FindGatherEvents(std::span<const model::Position> item_positions,
+                                                 std::span<const double> item_widths,
+                                                 std::span<const Gatherer> gatherers,
+                                                 bool fixed_point = false, BroadPhase broad_phase = BroadPhase::AUTO);
+    /* То же для предметов и собирателей провайдера: они один раз копируются в массивы.
+     * item_id события - индекс предмета провайдера */
+    std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider &provider, bool fixed_point = false,
+                                                 BroadPhase broad_phase = BroadPhase::AUTO);
+
+    /* Решение обработчика по событию потоковой обработки */
+    enum class GatherDecision {
+        SKIP,         // предмет не взят
+        TAKE,         // предмет взят: следующие события с ним пропускаются
+        TAKE_AND_STOP // предмет взят, собирателю больше ничего не нужно (например, заполнен рюкзак)
+    };
+
+    class GatherEventHandler {
+    protected:
+        ~GatherEventHandler() = default;
+
+    public:
+        /* Собиратели, для которых false (например, с заполненным рюкзаком), не проверяются */
+        virtual bool IsGathererActive(size_t gatherer_idx) const = 0;
+        virtual GatherDecision OnEvent(const GatheringEvent& event) = 0;
+    };
+
+    /* Потоковая обработка событий сбора: handler получает события в том же порядке, что и в FindGatherEvents(),
+     * кроме событий неактивных и остановленных собирателей и событий с уже взятыми предметами */
+    void ProcessGatherEvents(std::span<const model::Position> item_positions, std::span<const double> item_widths,
+                             std::span<const Gatherer> gatherers, GatherEventHandler& handler,
+                             bool fixed_point = false, BroadPhase broad_phase = BroadPhase::AUTO);
 
 } // namespace collision_detector
\ No newline at end of file
@@ -4,16 +4,22 @@
  * Если этот параметр указан, каждые N миллисекунд сервер должен обновлять координаты объектов.
  * Если этот параметр не указан, время в игре должно управляться с помощью запроса /api/v1/game/tick к REST API.
  * --config-file (-c) задаёт путь к конфигурационному JSON-файлу игры.
+ * --map-bundle <путь-к-файлу> задаёт двоичный набор карт (собирается bundle_compiler), который загружается
+ * вместо конфигурационного файла - без разбора JSON и построения индексов дорог.
  * --www-root (-w) задаёт путь к каталогу со статическими файлами игры.
  * --randomize-spawn-points включает режим, при котором пёс игрока появляется в случайной точке случайно выбранной дороги карты.
  * --save-state-period <игровое-время-в-миллисекундах> задаёт период автоматического сохранения состояния сервера.
  * --state-file <путь-к-файлу> задаёт путь к файлу, в который приложение должно сохранять своё состояние в процессе работы,
  * а при старте — восстанавливать.
+ * --seed <число> задаёт зерно генераторов случайных чисел игрового мира: при одинаковом зерне
+ * игра воспроизводится одинаково (для замеров и сравнения результатов). Токены игроков от зерна не зависят.
+ * --fixed-point включает режим фиксированной точки: перемещение собак и сбор предметов считаются в целых числах.
  * --help (-h) должен выводить информацию о параметрах командной строки.
  */
 #pragma once
 #include <boost/program_options.hpp>
 
+#include <cstdint>
 #include <iostream>
 #include <optional>
 #include <string>
@@ -25,17 +31,21 @@ using namespace std::literals;
 struct Args{
     unsigned int tick_period = 0;   // получаем в миллисекундах
     std::string config_file;        // файл JSON с настройками игры (карты...)
+    std::string map_bundle;         // двоичный набор карт, если задан - config_file не нужен
     std::string www_root;           // каталог с файлами игры (веб-странички, скрипты, картинки...)
     bool randomize_spawn_points = false;    // true - персонажи на карте появляются в случайных местах
     bool test_mode = false;         // если true, то tick_period не задан
     unsigned int autosave_period = 0;   // получаем в миллисекундах
     std::string state_file;        // файл с сохранённым состоянием игры
+    std::optional<std::uint64_t> seed;  // зерно генераторов случайных чисел (если не задано - случайное)
+    bool fixed_point = false;       // true - координаты собак считаются с фиксированной точкой (1/1024)
 };
 
 [[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
     namespace po = boost::program_options;
 
     Args args;
+    std::uint64_t seed = 0;
     po::options_description desc{"Allowed options"};
 
     desc.add_options()
@@ -45,12 +55,18 @@ struct Args{
         ("tick-period,t", po::value<unsigned int>(&args.tick_period)->value_name("milliseconds"s), "set tick period")
         // задаёт путь к конфигурационному JSON-файлу игры
         ("config-file,c", po::value(&args.config_file)->value_name("file"s), "set config file path")
+        // задаёт путь к двоичному набору карт вместо конфигурационного файла
+        ("map-bundle", po::value(&args.map_bundle)->value_name("file"s), "set map bundle file path")
         // задаёт путь к каталогу со статическими файлами игры
         ("www-root,w", po::value(&args.www_root)->value_name("dir"s), "set static files root")
         // включает режим, при котором пёс игрока появляется в случайной точке случайно выбранной дороги карты
         ("randomize-spawn-points", po::bool_switch(&args.randomize_spawn_points), "spawn dogs at random positions")
         ("save-state-period", po::value<unsigned int>(&args.autosave_period)->value_name("milliseconds"s), "set autosave period")
-        ("state-file", po::value(&args.state_file)->value_name("file"s), "set autosave file path");
+        ("state-file", po::value(&args.state_file)->value_name("file"s), "set autosave file path")
+        // задаёт зерно генераторов случайных чисел для воспроизводимой игры
+        ("seed", po::value<std::uint64_t>(&seed)->value_name("number"s), "set random seed")
+        // включает режим фиксированной точки для перемещения собак и сбора предметов
+        ("fixed-point", po::bool_switch(&args.fixed_point), "use fixed-point coordinates");
 
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -61,8 +77,8 @@ struct Args{
         std::cout << desc;
         return std::nullopt;
     }
-    if (!vm.contains("config-file"s)) {
-        throw std::runtime_error("config-file is not specified"s);
+    if (!vm.contains("config-file"s) && !vm.contains("map-bundle"s)) {
+        throw std::runtime_error("config-file or map-bundle is not specified"s);
     }
     if (!vm.contains("www-root"s)) {
         throw std::runtime_error("www-root directory path is not specified"s);
@@ -73,6 +89,9 @@ struct Args{
     if (!vm.contains("state-file")) {
         args.autosave_period = 0;
     }
+    if (vm.contains("seed"s)) {
+        args.seed = seed;
+    }
     return args;
 }
 
@@ -0,0 +1,64 @@
+/*
+ * Координаты с фиксированной точкой: целое число 1/1024 долей единицы карты.
+ * Любое такое значение точно представимо в double, поэтому состояние собак в режиме фиксированной точки
+ * хранится в тех же double (API, JSON и файл состояния не меняются), а перемещение и сбор предметов
+ * считаются в целых числах и дают одинаковый результат на любых компиляторах и машинах.
+ */
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace fixed_point {
+
+using Fixed = std::int64_t;
+
+constexpr int FRACTION_BITS = 10;
+constexpr Fixed ONE = Fixed{1} << FRACTION_BITS;
+/* Половина ширины дороги (0.4), округлённая вниз до 1/1024: точки сетки 1/1024 относятся
+ * к тем же точкам дороги, что и при расчёте в double */
+constexpr Fixed HALF_ROAD_WIDE = 409;
+/* Граница точек дороги: точка k содержит значения [k - ROUND_DELTA, k + HALF_ROAD_WIDE] (для k < 0 симметрично).
+ * Для значений сетки 1/1024 это те же точки, что и у detail::RoundPosition() для double (порог 0.5999) */
+constexpr Fixed ROUND_DELTA = ONE - HALF_ROAD_WIDE - 1;
+
+struct Point {
+    Fixed x;
+    Fixed y;
+};
+
+/* Ближайшее значение с фиксированной точкой (половины округляются от нуля) */
+inline Fixed FromDouble(double value) noexcept {
+    return static_cast<Fixed>(std::llround(value * static_cast<double>(ONE)));
+}
+
+inline double ToDouble(Fixed value) noexcept {
+    return static_cast<double>(value) / static_cast<double>(ONE);
+}
+
+/* Смещение за time секунд со скоростью speed: одно умножение и округление, результат не зависит от платформы */
+inline Fixed Displacement(Fixed speed, double time) noexcept {
+    return static_cast<Fixed>(std::llround(static_cast<double>(speed) * time));
+}
+
+inline Fixed FromCell(Fixed cell) noexcept {
+    return cell * ONE;
+}
+
+/* Точка дороги, в которой лежит координата (аналог detail::RoundPosition() для double) */
+inline Fixed ToCell(Fixed value) noexcept {
+    if (value >= 0) {
+        return (value + ROUND_DELTA) >> FRACTION_BITS;
+    }
+    return -((-value + ROUND_DELTA) >> FRACTION_BITS);
+}
+
+/* Позиция value из double, лежащая в точке дороги cell (detail::RoundPosition()). Ближайшее значение у края
+ * дороги может попасть в соседнюю точку (k + 0.4 даёт k + 410/1024), поэтому оно сдвигается к центру дороги */
+inline Fixed FromPosition(double value, Fixed cell) noexcept {
+    const Fixed low = FromCell(cell) - (cell > 0 ? ROUND_DELTA : HALF_ROAD_WIDE);
+    const Fixed high = FromCell(cell) + (cell < 0 ? ROUND_DELTA : HALF_ROAD_WIDE);
+    return std::clamp(FromDouble(value), low, high);
+}
+
+} // namespace fixed_point
@@ -1,60 +1,218 @@
 #include "game_session.h"
+#include "collision_detector.h"
 #include "loot_generator.h"
 #include "model.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iterator>
-#include <random>
 
 namespace model {
 
     /* 1) Получаем от генератора количество новых потерянных предметов случайным образом.
      * 2) Генерируем для каждого из них:
      *      - Тип предмета — целое число от 0 до K−1 включительно, где K — количество элементов в массиве lootTypes
-     *      - Объект генерируется в случайно выбранной точке на случайно выбранной дороге карты. */
-    void GameSession::AddLostObjectsOnSession(loot_gen::LootGenerator& loot_generator,
-                                  		loot_gen::LootGenerator::TimeInterval time_delta) {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<size_t> random_gen(0, map_->GetLootTypesCount() - 1);
-
-        size_t lost_obj_count = loot_generator.Generate(time_delta, lost_objects_.size(), dog_ids_.size());
+     *      - Объект генерируется в случайно выбранной точке на случайно выбранной дороге карты.
+     * 3) Добавляем новые предметы в массив сессии одной пачкой, затем раскладываем по корзинам */
+    void GameSession::AddLostObjectsOnSession(loot_gen::LootGenerator::TimeInterval time_delta) {
+        const size_t lost_obj_count = loot_generator_.Generate(time_delta, lost_objects_.size(), dogs_.Size());
+        if (lost_obj_count == 0) {
+            return;
+        }
+        LostObjects::Values spawned;
+        spawned.reserve(lost_obj_count);
         for (size_t i = 0; i < lost_obj_count; ++i) {
-            lost_objects_.emplace_back(std::make_shared<LostObject>(random_gen(gen),
-                                                        map_->GetRandomPositionOnRoads(),
-                                                        last_object_id_++));
+            spawned.emplace_back(map_->GetRandomLootType(),
+                                 map_->GetRandomPositionOnRoads(),
+                                 last_object_id_++);
+        }
+        const size_t first_idx = lost_objects_.size();
+        lost_objects_.Append(std::move(spawned));
+        for (size_t idx = first_idx; idx != lost_objects_.size(); ++idx) {
+            AddToLootBucket(lost_objects_.GetKey(idx));
         }
     }
 
-    /* Удаление всех элементов списка, индексы которых отмечены true */
+    /* Ключи собираются до удаления: удаление переносит вещи внутри массива */
     void GameSession::RemoveObjectsFromLost(const std::vector<bool>& idxs_to_remove) {
         assert(lost_objects_.size() == idxs_to_remove.size());
 
-        std::vector<LostObjects::iterator> its_to_erase;
+        std::vector<LostObjectKey> keys_to_erase;
         for (size_t idx = 0; idx != idxs_to_remove.size(); ++idx) {
             if (idxs_to_remove[idx]) {
-                auto it = lost_objects_.begin();
-                std::advance(it, idx);
-                its_to_erase.push_back(it);
+                keys_to_erase.push_back(lost_objects_.GetKey(idx));
             }
         }
-        for (auto& it : its_to_erase) {
-            lost_objects_.erase(it);
+        RemoveLostObjects(keys_to_erase);
+    }
+
+    /* Собиратель подбирает предметы не дальше своего радиуса и радиуса предмета от отрезка перемещения,
+     * неподвижный собиратель ничего не подбирает */
+    std::vector<GameSession::LostObjectKey> GameSession::FindLostObjectsNear(
+                                            const std::vector<collision_detector::Gatherer>& gatherers) const {
+        std::vector<size_t> buckets;
+        for (const collision_detector::Gatherer& gatherer : gatherers) {
+            if ((gatherer.start_pos.x != gatherer.end_pos.x) || (gatherer.start_pos.y != gatherer.end_pos.y)) {
+                map_->FindLootBucketsNear(gatherer.start_pos, gatherer.end_pos, gatherer.width + max_loot_width_, buckets);
+            }
+        }
+        buckets.push_back(Map::NO_LOOT_BUCKET);
+        std::sort(buckets.begin(), buckets.end());
+        buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+
+        std::vector<LostObjectKey> result;
+        for (const size_t key : buckets) {
+            if (auto bucket = loot_buckets_.find(key); bucket != loot_buckets_.end()) {
+                result.insert(result.end(), bucket->second.begin(), bucket->second.end());
+            }
+        }
+        std::sort(result.begin(), result.end(), [this](const LostObjectKey& left, const LostObjectKey& right) {
+            return lost_objects_[left].GetId() < lost_objects_[right].GetId();
+        });
+        return result;
+    }
+
+    void GameSession::RemoveLostObjects(const std::vector<LostObjectKey>& objects) {
+        for (const LostObjectKey& object : objects) {
+            auto bucket = loot_buckets_.find(GetLootBucket(lost_objects_[object]));
+            assert(bucket != loot_buckets_.end());
+            std::vector<LostObjectKey>& keys = bucket->second;
+            *std::find(keys.begin(), keys.end(), object) = keys.back();
+            keys.pop_back();
+            if (keys.empty()) {
+                loot_buckets_.erase(bucket);
+            }
+            lost_objects_.Erase(object);
         }
     }
 
+    void GameSession::RestoreLostObjects(std::vector<LostObject> objects, size_t last_obj_id) {
+        lost_objects_.Clear();
+        lost_objects_.Reserve(objects.size());
+        for (LostObject& object : objects) {
+            lost_objects_.Emplace(std::move(object));
+        }
+        last_object_id_ = last_obj_id;
+        RebuildLootBuckets();
+    }
+
+    size_t GameSession::GetLootBucket(const LostObject& object) const {
+        return (map_ != nullptr) ? map_->FindLootBucket(object.GetPosition()) : Map::NO_LOOT_BUCKET;
+    }
+
+    void GameSession::AddToLootBucket(LostObjectKey key) {
+        const LostObject& object = lost_objects_[key];
+        loot_buckets_[GetLootBucket(object)].push_back(key);
+        max_loot_width_ = std::max(max_loot_width_, object.GetWidth());
+    }
+
+    void GameSession::RebuildLootBuckets() {
+        loot_buckets_.clear();
+        for (size_t idx = 0; idx != lost_objects_.size(); ++idx) {
+            AddToLootBucket(lost_objects_.GetKey(idx));
+        }
+    }
+
+    void GameSession::SetMap(Map* map) {
+        map_ = map;
+        std::vector<LostObjectKey> keys_to_erase;
+        for (size_t idx = 0; idx != lost_objects_.size(); ++idx) {
+            const LostObject& object = lost_objects_.GetValues()[idx];
+            if ((object.GetType() >= map->GetLootTypesCount()) || map->GetRoadByPosition(object.GetPosition()).empty()) {
+                keys_to_erase.push_back(lost_objects_.GetKey(idx));
+            }
+        }
+        for (const LostObjectKey& key : keys_to_erase) {
+            lost_objects_.Erase(key);
+        }
+        RebuildLootBuckets();
+    }
+
+    GameSession::DogHandle GameSession::AddDog(Dog dog) {
+        dog.SetRoad(map_->FindDogRoad(dog.GetDogState().position));
+        const size_t dog_id = dog.GetDogId();
+        const DogHandle handle = dogs_.Add(std::move(dog));
+        dog_id_to_handle_[dog_id] = handle;
+        return handle;
+    }
+
+    std::optional<GameSession::DogHandle> GameSession::FindDog(size_t dog_id) const {
+        if (auto it = dog_id_to_handle_.find(dog_id); it != dog_id_to_handle_.end()) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    /* С последней собакой сессия засыпает, её предметы никто не подберёт */
     void GameSession::DeleteDog(size_t dog_id) {
-        if (map_id_to_it_.count(dog_id) > 0) {
-            dog_ids_.erase(map_id_to_it_.at(dog_id));
-            map_id_to_it_.erase(dog_id);
+        if (auto it = dog_id_to_handle_.find(dog_id); it != dog_id_to_handle_.end()) {
+            dogs_.Erase(it->second);
+            dog_id_to_handle_.erase(it);
+            if (IsHibernated()) {
+                ReleaseLostObjects();
+            }
+        }
+    }
+
+    void GameSession::ReleaseLostObjects() noexcept {
+        lost_objects_.Clear();
+        lost_objects_.ShrinkToFit();
+        loot_buckets_ = {};
+        max_loot_width_ = 0.;
+    }
+
+namespace {
+    /* Удаление элемента idx переносом последнего на его место */
+    template <typename T>
+    void SwapRemove(std::vector<T>& values, size_t idx) {
+        if (idx + 1 != values.size()) {
+            values[idx] = std::move(values.back());
+        }
+        values.pop_back();
+    }
+} // namespace
+
+    SessionDogs::Handle SessionDogs::Add(Dog dog) {
+        movement_.Add(dog.GetDogState(), dog.GetRoad());
+        names_.push_back(dog.GetDogName());
+        bags_.push_back(dog.GetPickedObjects());
+        scores_.push_back(dog.GetScores());
+        inactive_time_.push_back(dog.GetInactiveTime());
+        total_time_.push_back(dog.GetTotalTime());
+        return ids_.Emplace(dog.GetDogId());
+    }
+
+    /* Массивы компонентов повторяют перенос последней собаки, который делает ids_.Erase() */
+    void SessionDogs::Erase(Handle handle) {
+        const size_t idx = ids_.GetIndex(handle);
+        movement_.Erase(idx);
+        SwapRemove(names_, idx);
+        SwapRemove(bags_, idx);
+        SwapRemove(scores_, idx);
+        SwapRemove(inactive_time_, idx);
+        SwapRemove(total_time_, idx);
+        ids_.Erase(handle);
+    }
+
+    Dog SessionDogs::GetDog(size_t idx) const {
+        Dog dog{GetIds()[idx], names_[idx], GetState(idx), bags_[idx], scores_[idx], inactive_time_[idx], total_time_[idx]};
+        dog.SetRoad(GetRoad(idx));
+        return dog;
+    }
+
+    bool SessionDogs::AddPickedObject(size_t idx, const PickedObject& object, size_t bag_capacity) {
+        if (bags_[idx].size() >= bag_capacity) {
+            return false;
         }
+        bags_[idx].PushBack(object);
+        return true;
     }
 
     /* Добавляет подобранный предмет в сумку собаки и возвращает true,
     * возвращает false если сумка полна*/
     bool Dog::AddPickedObject(const PickedObject object, size_t bag_capacity) {
         if (objects_.size() < bag_capacity) {
-            objects_.emplace_back(std::move(object));
+            objects_.PushBack(object);
         } else {
             return false;
         }
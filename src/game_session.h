@@ -5,16 +5,23 @@
  * - игровые сессии
  */
 #pragma once
+#include "inline_vector.h"
 #include "loot_generator.h"
+#include "slot_map.h"
 #include "tagged.h"
 
-#include <list>
+#include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+namespace collision_detector {
+    struct Gatherer; // описан в collision_detector.h
+} // namespace collision_detector
+
 namespace model {
 
     class Map; // описан в model.h
@@ -46,11 +53,82 @@ namespace model {
     };
     bool operator==(const DogState& left, const DogState& right);
 
+    /* Дорога, на которой находится собака (подсказка для Map::MoveDog, чтобы не искать дороги каждый тик):
+     * road - индекс дороги в массиве дорог карты (NO_ROAD - дорога неизвестна),
+     * [free_from, free_to] - участок дороги (координаты вдоль неё), на котором других дорог нет.
+     * junction == true - собака стоит на перекрёстке в точке free_from == free_to, там сходятся несколько дорог,
+     * segment - участок графа дорог карты, на котором лежит дорога road */
+    struct DogRoad {
+        static constexpr size_t NO_ROAD = std::numeric_limits<size_t>::max();
+
+        size_t road = NO_ROAD;
+        int free_from = 0;
+        int free_to = -1;
+        bool junction = false;
+        size_t segment = NO_ROAD;
+    };
+
+    /* Состояния собак одной сессии в виде параллельных массивов (structure of arrays)
+     * для пакетного перемещения Map::MoveDogs(). future_x, future_y - расчётные положения до учёта дорог */
+    struct DogsMovement {
+        std::vector<double> pos_x;
+        std::vector<double> pos_y;
+        std::vector<double> speed_x;
+        std::vector<double> speed_y;
+        std::vector<Direction> direction;
+        std::vector<DogRoad> road;
+        std::vector<double> future_x;
+        std::vector<double> future_y;
+
+        size_t Size() const noexcept {
+            return pos_x.size();
+        }
+        /* Память массивов сохраняется между тиками */
+        void Clear() noexcept {
+            pos_x.clear();
+            pos_y.clear();
+            speed_x.clear();
+            speed_y.clear();
+            direction.clear();
+            road.clear();
+        }
+        void Add(const DogState& state, const DogRoad& dog_road = {}) {
+            pos_x.push_back(state.position.x);
+            pos_y.push_back(state.position.y);
+            speed_x.push_back(state.velocity.x);
+            speed_y.push_back(state.velocity.y);
+            direction.push_back(state.direction);
+            road.push_back(dog_road);
+        }
+        DogState GetState(size_t idx) const {
+            return {{pos_x[idx], pos_y[idx]}, {speed_x[idx], speed_y[idx]}, direction[idx]};
+        }
+        void SetState(size_t idx, const DogState& state) {
+            pos_x[idx] = state.position.x;
+            pos_y[idx] = state.position.y;
+            speed_x[idx] = state.velocity.x;
+            speed_y[idx] = state.velocity.y;
+            direction[idx] = state.direction;
+        }
+        /* Последняя собака переносится на место удалённой */
+        void Erase(size_t idx) {
+            SetState(idx, GetState(Size() - 1));
+            road[idx] = road.back();
+            pos_x.pop_back();
+            pos_y.pop_back();
+            speed_x.pop_back();
+            speed_y.pop_back();
+            direction.pop_back();
+            road.pop_back();
+        }
+    };
+
     /* --------------------------------------- Найденные вещи --------------------------------------- */
     /* id_ - идентификатор, который при сборе копируется из LostObject::id_
      * type_ - индекс в векторе model::Map::LootTypes */
     class PickedObject {
     public:
+        PickedObject() = default;
         explicit PickedObject(const size_t obj_id, const size_t obj_type) noexcept
                     : id_(obj_id)
                     , type_(obj_type) {}
@@ -65,6 +143,13 @@ namespace model {
         size_t type_ = 0;
     };
 
+    /* Вместимость сумки на карте по умолчанию (Map, defaultBagCapacity) */
+    constexpr size_t DEFAULT_BAG_CAPACITY = 3;
+    /* Сумка собаки: при вместимости карты до DEFAULT_BAG_CAPACITY предметы лежат в самой сумке без выделения памяти,
+     * при большей - переезжают в кучу один раз */
+    using Bag = util::InlineVector<PickedObject, DEFAULT_BAG_CAPACITY>;
+    static_assert(sizeof(Bag) <= 64, "bag with its size must fit in a cache line");
+
     /* --------------------------------------- Собака --------------------------------------- */
     class Dog {
     public:
@@ -74,7 +159,7 @@ namespace model {
             state_.position = pos;
         }
         Dog(size_t id, std::string name, DogState state,
-                std::vector<PickedObject> objects, size_t scores,
+                Bag objects, size_t scores,
                 double inactive_time, double total_time)
                 : id_(id)
                 , name_(std::move(name))
@@ -105,18 +190,28 @@ namespace model {
         void SetState(const DogState& state) {
             state_ = state;
         }
+        const DogRoad& GetRoad() const noexcept {
+            return road_;
+        }
+        void SetRoad(const DogRoad& road) noexcept {
+            road_ = road;
+        }
         bool AddPickedObject(const PickedObject object, size_t bag_capacity);
 
-        const std::vector<PickedObject>& GetPickedObjects() const noexcept {
+        const Bag& GetPickedObjects() const noexcept {
             return objects_;
         }
         const bool IsBagEmpty() const noexcept {
             return objects_.empty();
         }
-        std::vector<PickedObject> FlushPickedObjects() {
-            std::vector<PickedObject> result(objects_.begin(), objects_.end());
-            objects_.clear();
-            return result;
+        /* Удаляет из сумки предметы, типов которых нет среди loot_types_count типов карты */
+        void RemoveUnknownObjects(size_t loot_types_count) {
+            objects_.EraseIf([loot_types_count](const PickedObject& object) {
+                return object.GetType() >= loot_types_count;
+            });
+        }
+        void ClearPickedObjects() noexcept {
+            objects_.Clear();
         }
         const size_t GetScores() const noexcept {
             return scores_;
@@ -144,12 +239,181 @@ namespace model {
         size_t id_;
         std::string name_;
         DogState state_;
-        std::vector<PickedObject> objects_;
+        DogRoad road_;
+        Bag objects_;
         size_t scores_ = 0;
         double inactive_time_ = 0.; // время в секундах
         double total_time_ = 0.;  // время в игре в секундах
     };
 
+    /* --------------------------------------- Собаки сессии --------------------------------------- */
+    /* Собаки одной сессии: состояние с дорогой (DogsMovement), сумки, очки и время лежат в параллельных массивах
+     * по индексу собаки, тик проходит по ним подряд. При удалении собаки на её место переносится последняя,
+     * поэтому индекс собаки меняется, а Handle остаётся действительным, пока собака в сессии */
+    class SessionDogs {
+    public:
+        using Handle = util::SlotMap<size_t>::Key;
+
+        Handle Add(Dog dog);
+        void Erase(Handle handle);
+
+        size_t Size() const noexcept {
+            return ids_.size();
+        }
+        bool Contains(Handle handle) const noexcept {
+            return ids_.Contains(handle);
+        }
+        size_t GetIndex(Handle handle) const noexcept {
+            return ids_.GetIndex(handle);
+        }
+        Handle GetHandle(size_t idx) const noexcept {
+            return ids_.GetKey(idx);
+        }
+        /* Копия собаки с индексом idx */
+        Dog GetDog(size_t idx) const;
+
+        /* id собак по индексам */
+        const std::vector<size_t>& GetIds() const noexcept {
+            return ids_.GetValues();
+        }
+        const std::string& GetName(size_t idx) const noexcept {
+            return names_[idx];
+        }
+        /* Состояния и дороги всех собак для пакетного перемещения Map::MoveDogs() */
+        DogsMovement& GetMovement() noexcept {
+            return movement_;
+        }
+        const DogsMovement& GetMovement() const noexcept {
+            return movement_;
+        }
+        DogState GetState(size_t idx) const noexcept {
+            return movement_.GetState(idx);
+        }
+        void SetState(size_t idx, const DogState& state) noexcept {
+            movement_.SetState(idx, state);
+        }
+        const DogRoad& GetRoad(size_t idx) const noexcept {
+            return movement_.road[idx];
+        }
+        void SetRoad(size_t idx, const DogRoad& road) noexcept {
+            movement_.road[idx] = road;
+        }
+
+        const Bag& GetBag(size_t idx) const noexcept {
+            return bags_[idx];
+        }
+        /* Добавляет предмет в сумку и возвращает true, возвращает false если сумка полна */
+        bool AddPickedObject(size_t idx, const PickedObject& object, size_t bag_capacity);
+        /* Опустошает сумку на месте (сдача в офис): предметы читаются через GetBag() до вызова */
+        void ClearBag(size_t idx) noexcept {
+            bags_[idx].Clear();
+        }
+        /* Удаляет из сумки предметы, типов которых нет среди loot_types_count типов карты */
+        void RemoveUnknownObjects(size_t idx, size_t loot_types_count) {
+            bags_[idx].EraseIf([loot_types_count](const PickedObject& object) {
+                return object.GetType() >= loot_types_count;
+            });
+        }
+
+        size_t GetScores(size_t idx) const noexcept {
+            return scores_[idx];
+        }
+        void AddScores(size_t idx, size_t scores) noexcept {
+            scores_[idx] += scores;
+        }
+        double GetInactiveTime(size_t idx) const noexcept {
+            return inactive_time_[idx];
+        }
+        double GetTotalTime(size_t idx) const noexcept {
+            return total_time_[idx];
+        }
+        /* Учёт времени в игре, время неактивности сбрасывается, если собака за время time_delta сдвинулась */
+        void AddTime(size_t idx, double time_delta, bool active) noexcept {
+            total_time_[idx] += time_delta;
+            inactive_time_[idx] = active ? 0. : inactive_time_[idx] + time_delta;
+        }
+
+    private:
+        util::SlotMap<size_t> ids_; // id собак, ключи - Handle
+        std::vector<std::string> names_;
+        DogsMovement movement_;
+        std::vector<Bag> bags_;
+        std::vector<size_t> scores_;
+        std::vector<double> inactive_time_; // время в секундах
+        std::vector<double> total_time_;    // время в игре в секундах
+    };
+
+    /* Собака сессии по Handle (для обращений вне тика): индекс в массивах SessionDogs ищется при каждом вызове */
+    class DogRef {
+    public:
+        DogRef(SessionDogs& dogs, SessionDogs::Handle handle) noexcept
+                : dogs_(&dogs)
+                , handle_(handle) {}
+
+        size_t GetDogId() const noexcept {
+            return dogs_->GetIds()[Index()];
+        }
+        const std::string& GetDogName() const noexcept {
+            return dogs_->GetName(Index());
+        }
+        DogState GetDogState() const noexcept {
+            return dogs_->GetState(Index());
+        }
+        void SetPosition(const Position& pos) noexcept {
+            DogState state = GetDogState();
+            state.position = pos;
+            SetState(state);
+        }
+        void SetVelocity(const Velocity& vel) noexcept {
+            DogState state = GetDogState();
+            state.velocity = vel;
+            SetState(state);
+        }
+        void SetDirection(Direction dir) noexcept {
+            DogState state = GetDogState();
+            state.direction = dir;
+            SetState(state);
+        }
+        void SetState(const DogState& state) noexcept {
+            dogs_->SetState(Index(), state);
+        }
+        const DogRoad& GetRoad() const noexcept {
+            return dogs_->GetRoad(Index());
+        }
+        void SetRoad(const DogRoad& road) noexcept {
+            dogs_->SetRoad(Index(), road);
+        }
+        bool AddPickedObject(const PickedObject& object, size_t bag_capacity) {
+            return dogs_->AddPickedObject(Index(), object, bag_capacity);
+        }
+        const Bag& GetPickedObjects() const noexcept {
+            return dogs_->GetBag(Index());
+        }
+        bool IsBagEmpty() const noexcept {
+            return GetPickedObjects().empty();
+        }
+        void RemoveUnknownObjects(size_t loot_types_count) {
+            dogs_->RemoveUnknownObjects(Index(), loot_types_count);
+        }
+        size_t GetScores() const noexcept {
+            return dogs_->GetScores(Index());
+        }
+        double GetInactiveTime() const noexcept {
+            return dogs_->GetInactiveTime(Index());
+        }
+        double GetTotalTime() const noexcept {
+            return dogs_->GetTotalTime(Index());
+        }
+
+    private:
+        size_t Index() const noexcept {
+            return dogs_->GetIndex(handle_);
+        }
+
+        SessionDogs* dogs_;
+        SessionDogs::Handle handle_;
+    };
+
     /* --------------------------------------- Потерянные вещи --------------------------------------- */
     /* type_ - индекс в векторе model::Map::LootTypes
      * position_ - положение на одной из дорог на карте
@@ -191,27 +455,62 @@ namespace model {
     /* --------------------------------------- Игровая сессия --------------------------------------- */
     class GameSession {
     public:
-        using DogIds = std::list<size_t>;
-        using DogIdsIt = DogIds::const_iterator;
-        using LostObjects = std::list<std::shared_ptr<LostObject>>; // Одна сессия на одну карту!!!!!!!!!!!
+        using DogHandle = SessionDogs::Handle;
+        /* Потерянные вещи лежат подряд, ключ LostObjectKey действителен, пока вещь не подобрана.
+         * Удаление переносит последнюю вещь на место удалённой, поэтому порядок перебора - не порядок id */
+        using LostObjects = util::SlotMap<LostObject>;
+        using LostObjectKey = LostObjects::Key;
+
+        /* instance_id - номер экземпляра сессии среди сессий карты (Game::PlacePlayerOnMap),
+         * loot_generator - собственный генератор предметов сессии (копия настроек Game::GetLootGenerator()),
+         * по умолчанию предметы не появляются */
+	    explicit GameSession(model::Map* map, size_t instance_id = 0,
+                             loot_gen::LootGenerator loot_generator = {std::chrono::seconds{1}, 0.})
+            : map_{map}
+            , instance_id_{instance_id}
+            , loot_generator_{std::move(loot_generator)} {}
 
-	    explicit GameSession(model::Map* map) : map_{map} {}
+        size_t GetInstanceId() const noexcept {
+            return instance_id_;
+        }
 
-        void AddDog(size_t dog_id) {
-            map_id_to_it_[dog_id] = dog_ids_.emplace(std::cend(dog_ids_), dog_id);
+        /* Собака добавляется в конец массивов сессии, дорога собаки ищется по её позиции на карте сессии */
+        DogHandle AddDog(Dog dog);
+        /* Handle собаки с идентификатором dog_id, если она есть в сессии */
+        std::optional<DogHandle> FindDog(size_t dog_id) const;
+        DogRef GetDog(DogHandle handle) noexcept {
+            return {dogs_, handle};
         }
 
-        const DogIds& GetDogIds() const noexcept {
-            return dog_ids_;
+        SessionDogs& GetDogs() noexcept {
+            return dogs_;
+        }
+        const SessionDogs& GetDogs() const noexcept {
+            return dogs_;
+        }
+        /* id собак в порядке массивов сессии */
+        const std::vector<size_t>& GetDogIds() const noexcept {
+            return dogs_.GetIds();
         }
 
         const size_t CountDogsInSession() const noexcept {
-            return dog_ids_.size();
+            return dogs_.Size();
+        }
+
+        /* Сессия без собак спит: тик её пропускает (Application::MoveDogs), память потерянных предметов
+         * освобождается при уходе последней собаки (DeleteDog). Новая собака (AddDog) будит сессию */
+        bool IsHibernated() const noexcept {
+            return dogs_.Size() == 0;
         }
+        /* Освобождает память потерянных предметов, номера новых предметов продолжают прежние */
+        void ReleaseLostObjects() noexcept;
 
         Map* GetMap() const noexcept {
             return map_;
         }
+        /* Переход сессии на новую версию карты (Game::ReplaceMaps): предметы, тип которых пропал из карты
+         * или которые оказались вне её дорог, удаляются */
+        void SetMap(Map* map);
 
         const size_t CountLostObjects() const noexcept {
             return lost_objects_.size();
@@ -220,33 +519,53 @@ namespace model {
         const LostObjects& GetLostObjects() const noexcept {
             return lost_objects_;
         }
-        /* Удаление всех элементов списка, индексы которых отмечены true */
+        /* Удаление всех вещей, индексы которых в GetLostObjects() отмечены true */
         void RemoveObjectsFromLost(const std::vector<bool>& idxs_to_remove);
 
-        /* 1) Получаем от генератора количество новых потерянных предметов случайным образом.
+        /* Предметы, которые могут подобрать собиратели gatherers: предметы участков дорог рядом с отрезками
+         * перемещений собирателей и предметы вне дорог, по возрастанию id (порядок не зависит от хранения).
+         * Предметы хранятся по корзинам - кускам участков графа дорог (Map::FindLootBucket), поэтому стоимость зависит от числа
+         * предметов рядом с собаками, а не от числа всех предметов сессии */
+        std::vector<LostObjectKey> FindLostObjectsNear(const std::vector<collision_detector::Gatherer>& gatherers) const;
+        /* Удаление предметов, найденных FindLostObjectsNear() */
+        void RemoveLostObjects(const std::vector<LostObjectKey>& objects);
+
+        /* 1) Получаем от генератора сессии количество новых потерянных предметов случайным образом.
          * 2) Генерируем для каждого из них:
          *      - Тип предмета — целое число от 0 до K−1 включительно, где K — количество элементов в массиве lootTypes
-         *      - Объект генерируется в случайно выбранной точке на случайно выбранной дороге карты. */
-        void AddLostObjectsOnSession(loot_gen::LootGenerator& loot_generator,
-                                    loot_gen::LootGenerator::TimeInterval time_delta);
+         *      - Объект генерируется в случайно выбранной точке на случайно выбранной дороге карты.
+         * До срока генератора (LootGenerator::GetSpawnDeadline) тик сессии ничего не считает */
+        void AddLostObjectsOnSession(loot_gen::LootGenerator::TimeInterval time_delta);
+
+        const loot_gen::LootGenerator& GetLootGenerator() const noexcept {
+            return loot_generator_;
+        }
 
         size_t GetLastObjectId() const noexcept {
             return last_object_id_;
         }
 
-        void RestoreLostObjects(LostObjects objects, size_t last_obj_id) {
-            lost_objects_ = std::move(objects);
-            last_object_id_ = last_obj_id;
-        }
+        /* Вещи добавляются в порядке objects, поэтому перебор восстановленной сессии идёт в том же порядке,
+         * что и у сохранённой */
+        void RestoreLostObjects(std::vector<LostObject> objects, size_t last_obj_id);
 
         void DeleteDog(size_t dog_id);
 
     private:
+        size_t GetLootBucket(const LostObject& object) const;
+        void AddToLootBucket(LostObjectKey key);
+        void RebuildLootBuckets();
+
         model::Map* map_;
-        DogIds dog_ids_;
-        std::unordered_map<size_t, DogIdsIt> map_id_to_it_; // <dog_id, iterator_to_dog_ids_>
+        size_t instance_id_;
+        SessionDogs dogs_;
+        std::unordered_map<size_t, DogHandle> dog_id_to_handle_;
         LostObjects lost_objects_;
+        /* Предметы по корзинам карты: <корзина, ключи lost_objects_>, предметы вне дорог - в Map::NO_LOOT_BUCKET */
+        std::unordered_map<size_t, std::vector<LostObjectKey>> loot_buckets_;
+        double max_loot_width_ = 0.; // наибольший радиус предмета, с которым сессия встречалась
         size_t last_object_id_ = 0;
+        loot_gen::LootGenerator loot_generator_;
     };
 
 } // namespace model
@@ -0,0 +1,164 @@
+/*
+ * Массив с местом под N значений внутри объекта.
+ * Пока значений не больше N, они лежат в самом объекте (без выделения памяти), при большем числе
+ * значения переносятся в кучу и остаются там до уничтожения объекта: Clear() не освобождает память,
+ * поэтому массив, однажды переехавший в кучу, дальше работает без выделений.
+ * Место под значения и указатель на кучу делят одну память, поэтому объект больше места под N значений
+ * только на размер и вместимость.
+ */
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace util {
+
+template <typename T, size_t N>
+class InlineVector {
+    static_assert(N > 0);
+    static_assert(std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>,
+                  "values are copied by assignment and moved to the heap without constructors");
+
+public:
+    using value_type = T;
+    using const_iterator = const T*;
+
+    InlineVector() noexcept
+        : inline_{} {}
+
+    template <typename It>
+    InlineVector(It first, It last)
+        : InlineVector() {
+        for (; first != last; ++first) {
+            PushBack(*first);
+        }
+    }
+
+    InlineVector(const InlineVector& other)
+        : InlineVector(other.begin(), other.end()) {}
+
+    InlineVector(InlineVector&& other) noexcept
+        : InlineVector() {
+        Steal(other);
+    }
+
+    InlineVector& operator=(const InlineVector& other) {
+        if (this != &other) {
+            Clear();
+            for (const T& value : other) {
+                PushBack(value);
+            }
+        }
+        return *this;
+    }
+
+    InlineVector& operator=(InlineVector&& other) noexcept {
+        if (this != &other) {
+            Release();
+            Steal(other);
+        }
+        return *this;
+    }
+
+    ~InlineVector() {
+        Release();
+    }
+
+    void PushBack(const T& value) {
+        if (size_ == capacity_) {
+            Grow();
+        }
+        Data()[size_++] = value;
+    }
+
+    /* Удаляет значения, для которых pred возвращает true, порядок остальных сохраняется */
+    template <typename Pred>
+    void EraseIf(Pred pred) {
+        size_ = static_cast<std::uint32_t>(std::remove_if(Data(), Data() + size_, pred) - Data());
+    }
+
+    void Clear() noexcept {
+        size_ = 0;
+    }
+
+    /* Значения лежат внутри объекта */
+    bool IsInline() const noexcept {
+        return capacity_ == N;
+    }
+
+    size_t size() const noexcept {
+        return size_;
+    }
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+    const T* data() const noexcept {
+        return IsInline() ? inline_.data() : heap_;
+    }
+    const_iterator begin() const noexcept {
+        return data();
+    }
+    const_iterator end() const noexcept {
+        return data() + size_;
+    }
+    const T& operator[](size_t idx) const noexcept {
+        return data()[idx];
+    }
+    const T& front() const noexcept {
+        return data()[0];
+    }
+
+    friend bool operator==(const InlineVector& left, const InlineVector& right) {
+        return std::equal(left.begin(), left.end(), right.begin(), right.end());
+    }
+
+private:
+    T* Data() noexcept {
+        return IsInline() ? inline_.data() : heap_;
+    }
+
+    /* Переезд в кучу вдвое большей вместимости, вызывается только при полном массиве */
+    [[gnu::noinline]] void Grow() {
+        const std::uint32_t capacity = 2 * capacity_;
+        const std::uint32_t size = size_;
+        T* buffer = new T[capacity];
+        std::copy(data(), data() + size, buffer);
+        Release();
+        heap_ = buffer;
+        size_ = size;
+        capacity_ = capacity;
+    }
+
+    void Release() noexcept {
+        if (!IsInline()) {
+            delete[] heap_;
+            inline_ = {};
+            capacity_ = N;
+        }
+        size_ = 0;
+    }
+
+    /* Забирает значения other (this пуст и в режиме inline), other становится пустым */
+    void Steal(InlineVector& other) noexcept {
+        if (other.IsInline()) {
+            inline_ = other.inline_;
+        } else {
+            heap_ = std::exchange(other.heap_, nullptr);
+            other.inline_ = {};
+        }
+        size_ = std::exchange(other.size_, 0);
+        capacity_ = std::exchange(other.capacity_, static_cast<std::uint32_t>(N));
+    }
+
+    union {
+        std::array<T, N> inline_; // значения, пока вместимость N
+        T* heap_;                 // значения после переезда в кучу
+    };
+    std::uint32_t size_ = 0;
+    std::uint32_t capacity_ = N;
+};
+
+} // namespace util
@@ -1,79 +1,145 @@
 #include "json_loader.h"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <fstream>
 #include <memory>
+#include <thread>
 #include <utility>
 
 namespace json_loader {
 
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/* Разбор файла потоковым парсером: файл читается блоками, без копии всего файла в строке,
+ * а значения JSON размещаются в resource и освобождаются вместе с ним */
+boost::json::value ParseConfigFile(const std::filesystem::path& json_path, boost::json::monotonic_resource& resource) {
+    std::ifstream json_file(json_path, std::ios::in | std::ios::binary);
+    if (!json_file.is_open()) {
+        throw std::runtime_error("Can't open file:" + json_path.string());
+    }
+    boost::json::stream_parser parser;
+    parser.reset(&resource);
+    std::vector<char> buffer(64 * 1024);
+    while (json_file) {
+        json_file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        parser.write(buffer.data(), static_cast<size_t>(json_file.gcount()));
+    }
+    parser.finish();
+    return parser.release();
+}
+
+/* Карты независимы и значения JSON только читаются, поэтому карты строятся на нескольких потоках
+ * (текущий поток тоже строит карты). Ошибка построения карты запоминается, а в игру карты добавляются
+ * после построения всех карт по порядку: выбрасывается та же ошибка, что и при последовательной загрузке */
+void AddMaps(const boost::json::array& maps_arr, double default_dog_speed, size_t default_bag_capacity,
+             model::Game& game, std::vector<std::chrono::microseconds>& times) {
+    const size_t count = maps_arr.size();
+    std::vector<std::optional<model::Map>> maps(count);
+    std::vector<std::exception_ptr> errors(count);
+    times.assign(count, std::chrono::microseconds{});
+
+    std::atomic<size_t> next_map = 0;
+    auto build = [&]() {
+        for (size_t idx = next_map++; idx < count; idx = next_map++) {
+            const auto start = Clock::now();
+            try {
+                maps[idx].emplace(LoadMap(maps_arr[idx], default_dog_speed, default_bag_capacity));
+            } catch (...) {
+                errors[idx] = std::current_exception();
+            }
+            times[idx] = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+        }
+    };
+    {
+        const size_t threads_count = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), count);
+        std::vector<std::jthread> workers;
+        for (size_t i = 1; i < threads_count; ++i) {
+            workers.emplace_back(build);
+        }
+        build();
+    }
+
+    for (size_t idx = 0; idx != count; ++idx) {
+        if (errors[idx]) {
+            std::rethrow_exception(errors[idx]);
+        }
+        game.AddMap(std::move(*maps[idx]));
+    }
+}
+
+} // namespace
+
 /* Открыть файл настроек игры и разобрать в объект boost::json
  * Создать объект игры и загрузить модель игры из файла:
  *      1) получить настройки игры (в том числе необязательные)
  *      2) получить массив карт
- *      3) в цикле массива карт:
- *      3.1) создать карту model::Map
- *      3.2) заполнить карту объектами: дорогами, офисами, зданиями, типами вещей
- *      3.3) добавить карту в игру */
-model::Game LoadGame(const std::filesystem::path& json_path) {
+ *      3) построить карты параллельно (LoadMap) и добавить их в игру в порядке конфигурации */
+model::Game LoadGame(const std::filesystem::path& json_path, LoadTimes* times) {
     const std::string maps_str              = "maps";
-    const std::string id_str                = "id";
-    const std::string name_str              = "name";
-    const std::string roads_str             = "roads";
-    const std::string buildings_str         = "buildings";
-    const std::string offices_str           = "offices";
     const std::string loot_gen_config_str   = "lootGeneratorConfig";
-    const std::string loot_types_str        = "lootTypes";
     // Опциональные параметры:
     const std::string defaultdogspeed_str   = "defaultDogSpeed";
-    const std::string dogspeed_str          = "dogSpeed";
     const std::string defaultbagcapacity_str = "defaultBagCapacity";
-    const std::string bagcapacity_str       = "bagCapacity";
     const std::string dog_retirement_time_str = "dogRetirementTime";
+    const std::string max_dogs_per_session_str = "maxDogsPerSession";
 
-    // Загрузить содержимое файла json_path, в виде строки
-    std::ifstream json_file(json_path, std::ios::in);
-    if (!json_file.is_open()) {
-        throw std::runtime_error("Can't open file:" + json_path.string());
-    }
-    std::string json_str{std::istreambuf_iterator<char>(json_file), std::istreambuf_iterator<char>()};
-    // Распарсить строку как JSON, используя boost::json::parse
-    auto config_data = boost::json::parse(std::forward<std::string>(json_str));
+    LoadTimes load_times;
+    const auto parse_start = Clock::now();
+    boost::json::monotonic_resource resource;
+    const boost::json::value config_data = ParseConfigFile(json_path, resource);
+    load_times.parse = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - parse_start);
 
     model::Game game;
 
     double default_dog_speed = ReadOptionalValue(config_data, defaultdogspeed_str, static_cast<double>(1.));
-    size_t default_bag_capacity = ReadOptionalValue(config_data, defaultbagcapacity_str, static_cast<size_t>(3));
+    size_t default_bag_capacity = ReadOptionalValue(config_data, defaultbagcapacity_str, model::DEFAULT_BAG_CAPACITY);
 
-    auto loot_settings_obj = config_data.at(loot_gen_config_str).as_object();
+    const auto& loot_settings_obj = config_data.at(loot_gen_config_str).as_object();
     LoadAndSetLootSettings(loot_settings_obj, game);
 
     game.SetDogRetirementTime(ReadOptionalValue(config_data, dog_retirement_time_str, static_cast<double>(60.)));
+    game.SetMaxDogsPerSession(ReadOptionalValue(config_data, max_dogs_per_session_str, model::Game::MAX_DOGS_ON_MAP));
 
-    auto maps_arr = config_data.at(maps_str).as_array();
-    for (auto it_map = maps_arr.begin(); it_map != maps_arr.end(); ++it_map) {
-        double dog_speed = ReadOptionalValue(*it_map, dogspeed_str, default_dog_speed);
-        size_t bag_capacity = ReadOptionalValue(*it_map, bagcapacity_str, default_bag_capacity);
+    const auto& maps_arr = config_data.at(maps_str).as_array();
+    AddMaps(maps_arr, default_dog_speed, default_bag_capacity, game, load_times.maps);
 
-        model::Map map(model::Map::Id(std::string{it_map->at(id_str).as_string()}),
-                        std::string{it_map->at(name_str).as_string()},
-                        dog_speed,
-                        bag_capacity);
-        auto loot_types_arr = it_map->at(loot_types_str).as_array();
-        LoadAndAddLootTypes(loot_types_arr, map);
-
-        auto roads_arr = it_map->at(roads_str).as_array();
-        LoadAndAddRoads(roads_arr, map);
+    if (times != nullptr) {
+        *times = std::move(load_times);
+    }
+    return game;
+}
 
-        auto buildings_arr = it_map->at(buildings_str).as_array();
-        LoadAndAddBuildings(buildings_arr, map);
+/* Создать карту model::Map, заполнить её объектами: типами вещей, дорогами, зданиями, офисами
+ * и завершить загрузку карты (Map::Freeze) */
+model::Map LoadMap(const boost::json::value& map_value, double default_dog_speed, size_t default_bag_capacity) {
+    const std::string id_str                = "id";
+    const std::string name_str              = "name";
+    const std::string roads_str             = "roads";
+    const std::string buildings_str         = "buildings";
+    const std::string offices_str           = "offices";
+    const std::string loot_types_str        = "lootTypes";
+    // Опциональные параметры:
+    const std::string dogspeed_str          = "dogSpeed";
+    const std::string bagcapacity_str       = "bagCapacity";
 
-        auto offices_arr = it_map->at(offices_str).as_array();
-        LoadAndAddOffices(offices_arr, map);
+    double dog_speed = ReadOptionalValue(map_value, dogspeed_str, default_dog_speed);
+    size_t bag_capacity = ReadOptionalValue(map_value, bagcapacity_str, default_bag_capacity);
 
-        game.AddMap(map);
-    }
+    model::Map map(model::Map::Id(std::string{map_value.at(id_str).as_string()}),
+                    std::string{map_value.at(name_str).as_string()},
+                    dog_speed,
+                    bag_capacity);
+    LoadAndAddLootTypes(map_value.at(loot_types_str).as_array(), map);
+    LoadAndAddRoads(map_value.at(roads_str).as_array(), map);
+    LoadAndAddBuildings(map_value.at(buildings_str).as_array(), map);
+    LoadAndAddOffices(map_value.at(offices_str).as_array(), map);
 
-    return game;
+    map.Freeze();
+    return map;
 }
 
 void LoadAndSetLootSettings(const boost::json::object& loot_settings, model::Game& game_obj) {
@@ -95,15 +161,20 @@ void LoadAndAddRoads(const boost::json::array& roads_arr, model::Map& map) {
     const std::string road_x1_str = "x1";
     const std::string road_y1_str = "y1";
 
+    model::Map::Roads roads;
+    roads.reserve(roads_arr.size());
     for (auto it_road = roads_arr.begin(); it_road != roads_arr.end(); ++it_road) {
         model::Point start_road = {static_cast<int>(it_road->at(road_x0_str).as_int64()),
                                    static_cast<int>(it_road->at(road_y0_str).as_int64())};
-        try {
-            map.AddRoad({model::Road::HORIZONTAL, start_road, static_cast<int>(it_road->at(road_x1_str).as_int64())});
-        } catch (const std::out_of_range&) {
-            map.AddRoad({model::Road::VERTICAL, start_road, static_cast<int>(it_road->at(road_y1_str).as_int64())});
+        // вертикальные дороги без x1 не должны стоить исключения на каждую дорогу
+        if (const boost::json::value* x1 = it_road->as_object().if_contains(road_x1_str)) {
+            roads.emplace_back(model::Road::HORIZONTAL, start_road, static_cast<int>(x1->as_int64()));
+        } else {
+            roads.emplace_back(model::Road::VERTICAL, start_road, static_cast<int>(it_road->at(road_y1_str).as_int64()));
         }
     }
+    // граф дорог собирается один раз после добавления всех дорог карты
+    map.AddRoads(roads);
 }
 
 void LoadAndAddBuildings(const boost::json::array& buildings_arr, model::Map& map) {
@@ -294,25 +365,27 @@ boost::json::array GetLootTypesArray(const model::Map &map) {
     return loot_types_arr;
 }
 
-std::string GetPlayerAddedAnswer(std::string auth_token, size_t player_id) {
+std::string GetPlayerAddedAnswer(std::string auth_token, size_t player_id, size_t instance_id) {
     const std::string auth_token_str = "authToken";
     const std::string player_id_str = "playerId";
+    const std::string instance_id_str = "instanceId";
 
     boost::json::object res_obj;
     res_obj[auth_token_str] = auth_token;
     res_obj[player_id_str] = player_id;
+    res_obj[instance_id_str] = instance_id;
     boost::json::value val_json(res_obj);
     return {boost::json::serialize(val_json)};
 }
 
-std::string GetSessionPlayers(const players::Application::Dogs& dogs) {
+std::string GetSessionPlayers(const model::SessionDogs& dogs) {
     const std::string player_name_str = "name";
 
     boost::json::object res_obj;
-    for (const auto dog : dogs) {
+    for (size_t idx = 0; idx != dogs.Size(); ++idx) {
         boost::json::object player_obj;
-        player_obj[player_name_str] = dog->GetDogName(); /* Имя пса и пользователья совпадают (здесб выводится имя пользователя) */
-        res_obj[std::to_string(dog->GetDogId())] = player_obj;
+        player_obj[player_name_str] = dogs.GetName(idx); /* Имя пса и пользователья совпадают (здесб выводится имя пользователя) */
+        res_obj[std::to_string(dogs.GetIds()[idx])] = player_obj;
     }
     boost::json::value val_json(res_obj);
     return {boost::json::serialize(val_json)};
@@ -358,8 +431,8 @@ std::string MakeGameStateAnswer(const std::vector<players::GameState>& game_stat
     size_t idx = 0;
     for (const auto& object : lost_objects) {
         boost::json::object obj_obj;
-        obj_obj[type_str] = object->GetType();
-        obj_obj[pos_str] = boost::json::array{object->GetPosition().x, object->GetPosition().y};
+        obj_obj[type_str] = object.GetType();
+        obj_obj[pos_str] = boost::json::array{object.GetPosition().x, object.GetPosition().y};
         lost_objs_obj[std::to_string(idx++)] = obj_obj;
     }
     res_obj[lost_objects_str] = lost_objs_obj;
@@ -528,6 +601,61 @@ std::string GetLogResponse(const std::string timestamp,
     return {boost::json::serialize(val_json)};
 }
 
+std::string GetLogMapLoaded(const std::string timestamp,
+                            const model::Map& map,
+                            const std::optional<std::chrono::microseconds> build_time) {
+    boost::json::object res_obj;
+    res_obj["timestamp"] = timestamp;
+
+    boost::json::object data_obj;
+    data_obj["id"] = *map.GetId();
+    data_obj["roads"] = map.GetRoads().size();
+    data_obj["buildings"] = map.GetBuildings().size();
+    data_obj["offices"] = map.GetOffices().size();
+    data_obj["memory"] = map.GetMemoryUsage();
+    if (build_time) {
+        data_obj["build_time"] = static_cast<double>(build_time->count()) / 1000.; // в миллисекундах
+    }
+
+    res_obj["data"] = data_obj;
+    res_obj["message"] = "map loaded";
+    boost::json::value val_json(res_obj);
+    return {boost::json::serialize(val_json)};
+}
+
+std::string GetLogConfigParsed(const std::string timestamp,
+                               const std::chrono::microseconds parse_time) {
+    boost::json::object res_obj;
+    res_obj["timestamp"] = timestamp;
+
+    boost::json::object data_obj;
+    data_obj["parse_time"] = static_cast<double>(parse_time.count()) / 1000.; // в миллисекундах
+
+    res_obj["data"] = data_obj;
+    res_obj["message"] = "config parsed";
+    boost::json::value val_json(res_obj);
+    return {boost::json::serialize(val_json)};
+}
+
+std::string GetLogMapsReloaded(const std::string timestamp,
+                               const size_t maps_count,
+                               const std::string exception_what) {
+    boost::json::object res_obj;
+    res_obj["timestamp"] = timestamp;
+
+    boost::json::object data_obj;
+    if (exception_what.empty()) {
+        data_obj["maps"] = maps_count;
+    } else {
+        data_obj["exception"] = exception_what;
+    }
+
+    res_obj["data"] = data_obj;
+    res_obj["message"] = exception_what.empty() ? "maps reloaded" : "maps reload failed";
+    boost::json::value val_json(res_obj);
+    return {boost::json::serialize(val_json)};
+}
+
 std::string GetLogError(const std::string timestamp,
                         const int error_code,
                         const std::string error_text,
@@ -2,17 +2,27 @@
 
 #include <boost/json.hpp>
 
+#include <chrono>
 #include <cstdint>
 #include <filesystem>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "model.h"
 #include "players.h"
 
 namespace json_loader {
 
-model::Game LoadGame(const std::filesystem::path& json_path);
+/* Время загрузки конфигурации: parse - чтение и разбор файла, maps - построение каждой карты
+ * (индексы соответствуют картам игры). Карты строятся параллельно, поэтому их время не складывается */
+struct LoadTimes {
+    std::chrono::microseconds parse{};
+    std::vector<std::chrono::microseconds> maps;
+};
+
+model::Game LoadGame(const std::filesystem::path& json_path, LoadTimes* times = nullptr);
+model::Map LoadMap(const boost::json::value& map_value, double default_dog_speed, size_t default_bag_capacity);
 
 template <typename BoostJSONType, typename ValueType>
 ValueType ReadOptionalValue(const BoostJSONType& obj, std::string_view optional_str, ValueType default_value) {
@@ -39,8 +49,8 @@ boost::json::array GetBuildingsArray(const model::Map& map);
 boost::json::array GetOfficesArray(const model::Map& map);
 boost::json::array GetLootTypesArray(const model::Map &map);
 
-std::string GetPlayerAddedAnswer(std::string auth_token, size_t player_id);
-std::string GetSessionPlayers(const players::Application::Dogs& dogs);
+std::string GetPlayerAddedAnswer(std::string auth_token, size_t player_id, size_t instance_id);
+std::string GetSessionPlayers(const model::SessionDogs& dogs);
 
 std::string MakeGameStateAnswer(const std::vector<players::GameState>& game_state,
                                 const model::GameSession::LostObjects& lost_objects);
@@ -78,6 +88,16 @@ std::string GetLogResponse(const std::string timestamp,
                             const int response_time_msec,
                             const int response_code,
                             const std::string content_type);
+// memory - память карты в байтах (Map::GetMemoryUsage), build_time - время построения карты (LoadTimes::maps)
+std::string GetLogMapLoaded(const std::string timestamp,
+                            const model::Map& map,
+                            const std::optional<std::chrono::microseconds> build_time = std::nullopt);
+std::string GetLogConfigParsed(const std::string timestamp,
+                               const std::chrono::microseconds parse_time);
+// exception_what - причина, по которой карты не перезагружены (пустая строка, если перезагружены)
+std::string GetLogMapsReloaded(const std::string timestamp,
+                               const size_t maps_count,
+                               const std::string exception_what);
 std::string GetLogError(const std::string timestamp,
                             const int error_code,
                             const std::string error_text,
@@ -33,6 +33,30 @@ namespace logging_handler {
                                                     exception_what);
     }
 
+    /* Размер каждой загруженной карты в памяти, а если известно время загрузки (json_loader::LoadGame) -
+     * время разбора конфигурации и построения каждой карты */
+    void LogMapsLoaded(const model::Game& game, const json_loader::LoadTimes* times) {
+        if (times != nullptr) {
+            BOOST_LOG_TRIVIAL(info) << json_loader::GetLogConfigParsed(GetTimeStampString(), times->parse);
+        }
+        for (size_t idx = 0; idx != game.GetMaps().size(); ++idx) {
+            std::optional<std::chrono::microseconds> build_time;
+            if ((times != nullptr) && (idx < times->maps.size())) {
+                build_time = times->maps[idx];
+            }
+            BOOST_LOG_TRIVIAL(info) << json_loader::GetLogMapLoaded(GetTimeStampString(), game.GetMaps()[idx], build_time);
+        }
+    }
+
+    void LogMapsReloaded(const model::Game& game) {
+        LogMapsLoaded(game);
+        BOOST_LOG_TRIVIAL(info) << json_loader::GetLogMapsReloaded(GetTimeStampString(), game.GetMaps().size(), "");
+    }
+
+    void LogMapsReloadFailed(const std::string exception_what) {
+        BOOST_LOG_TRIVIAL(info) << json_loader::GetLogMapsReloaded(GetTimeStampString(), 0, exception_what);
+    }
+
     void LogNetworkError(const int error_code,
                          const std::string_view error_text,
                          const std::string_view where) {
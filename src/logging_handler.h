@@ -35,6 +35,9 @@ const std::string GetTimeStampString();
 
 void LogStartServer(const net::ip::tcp::endpoint &endpoint);
 void LogStopServer(const int return_code, const std::string exception_what);
+void LogMapsLoaded(const model::Game& game, const json_loader::LoadTimes* times = nullptr);
+void LogMapsReloaded(const model::Game& game);
+void LogMapsReloadFailed(const std::string exception_what);
 void LogNetworkError(const int error_code,
                      const std::string_view error_text,
                      const std::string_view where);
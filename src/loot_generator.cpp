@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 
 namespace loot_gen {
 
@@ -9,6 +10,9 @@ unsigned LootGenerator::Generate(TimeInterval time_delta, unsigned loot_count,
                                  unsigned looter_count) {
     time_without_loot_ += time_delta;
     const unsigned loot_shortage = loot_count > looter_count ? 0u : looter_count - loot_count;
+    if (time_without_loot_ < GetSpawnDeadline(loot_shortage)) {
+        return 0;
+    }
     const double ratio = std::chrono::duration<double>{time_without_loot_} / base_interval_;
     const double probability
         = std::clamp((1.0 - std::pow(1.0 - probability_, ratio)) * random_generator_(), 0.0, 1.0);
@@ -19,4 +23,32 @@ unsigned LootGenerator::Generate(TimeInterval time_delta, unsigned loot_count,
     return generated_loot;
 }
 
+/* Трофей появляется, когда round(loot_shortage * (1 - (1 - probability)^ratio) * random) > 0.
+ * Случайное число не больше 1, поэтому нужно loot_shortage * (1 - (1 - probability)^ratio) >= 0.5, откуда
+ * ratio >= ln(1 - 0.5 / loot_shortage) / ln(1 - probability). Срок берётся на 1 мс раньше, чтобы ошибки
+ * округления не отложили появление трофея */
+LootGenerator::TimeInterval LootGenerator::GetSpawnDeadline(unsigned loot_shortage) const {
+    if ((loot_shortage == 0) || (probability_ <= 0.)) {
+        return TimeInterval::max();
+    }
+    if (loot_shortage == deadline_shortage_) {
+        return deadline_;
+    }
+    deadline_shortage_ = loot_shortage;
+    if (probability_ >= 1.) {
+        deadline_ = TimeInterval{};
+        return deadline_;
+    }
+    const double min_ratio = std::log(1. - 0.5 / loot_shortage) / std::log(1. - probability_);
+    const double deadline_ms = min_ratio * std::chrono::duration<double, std::milli>{base_interval_}.count() - 1.;
+    if (deadline_ms <= 0.) {
+        deadline_ = TimeInterval{};
+    } else if (deadline_ms >= static_cast<double>(std::numeric_limits<TimeInterval::rep>::max() / 2)) {
+        deadline_ = TimeInterval::max();
+    } else {
+        deadline_ = TimeInterval{static_cast<TimeInterval::rep>(deadline_ms)};
+    }
+    return deadline_;
+}
+
 } // namespace loot_gen
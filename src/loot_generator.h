@@ -33,14 +33,30 @@ public:
      * time_delta - отрезок времени, прошедший с момента предыдущего вызова Generate
      * loot_count - количество трофеев на карте до вызова Generate
      * looter_count - количество мародёров на карте
+     *
+     * До срока GetSpawnDeadline() трофеи не появляются при любом случайном числе, поэтому
+     * генератор случайных чисел не вызывается и время без трофеев только накапливается.
      */
     unsigned Generate(TimeInterval time_delta, unsigned loot_count, unsigned looter_count);
 
+    /*
+     * Время без трофеев, раньше которого при нехватке трофеев loot_shortage (мародёров больше, чем трофеев)
+     * Generate() вернёт 0. TimeInterval::max() - трофеи не появятся никогда.
+     * Срок запоминается для последней нехватки и пересчитывается только при её изменении.
+     */
+    TimeInterval GetSpawnDeadline(unsigned loot_shortage) const;
+
+    TimeInterval GetTimeWithoutLoot() const noexcept {
+        return time_without_loot_;
+    }
+
     void SetLootPeriod(TimeInterval period) noexcept {
         base_interval_ = period;
+        deadline_shortage_ = NO_SHORTAGE;
     }
     void SetLootProbability(double probability) noexcept {
         probability_ = probability;
+        deadline_shortage_ = NO_SHORTAGE;
     }
     TimeInterval GetLootPeriod() const noexcept {
         return base_interval_;
@@ -53,10 +69,14 @@ private:
     static double DefaultGenerator() noexcept {
         return 1.0;
     };
+    static constexpr unsigned NO_SHORTAGE = 0; // при нулевой нехватке срок не нужен
+
     TimeInterval base_interval_;
     double probability_;
     TimeInterval time_without_loot_{};
     RandomGenerator random_generator_;
+    mutable unsigned deadline_shortage_ = NO_SHORTAGE; // нехватка, для которой посчитан deadline_
+    mutable TimeInterval deadline_{};
 };
 
 }  // namespace loot_gen
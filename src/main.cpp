@@ -2,6 +2,8 @@
 
 #include <boost/asio/signal_set.hpp>
 #include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/strand.hpp>
 #include <iostream>
 #include <fstream>
 #include <thread>
@@ -10,6 +12,7 @@
 #include "http_server.h"
 #include "json_loader.h"
 #include "logging_handler.h"
+#include "map_bundle.h"
 #include "players.h"
 #include "postgres/postgres.h"
 #include "ticker.h"
@@ -45,6 +48,42 @@ std::string GetDBURLFromEnv() {
     return db_url;
 }
 
+using Strand = net::strand<net::io_context::executor_type>;
+
+/* Перезагрузка карт по SIGHUP: конфигурация читается и карты строятся в пуле потоков ioc,
+ * в api_strand между тиками выполняется только сверка настроек игры (Game::CheckReloadSettings)
+ * и замена карт (Application::ReloadMaps), прежние карты освобождаются снова в пуле.
+ * При ошибке загрузки или изменённых настройках игры игра продолжается на прежних картах */
+void WaitReloadSignal(net::signal_set& signals, net::io_context& ioc, Strand api_strand,
+                      players::Application& app, const model::Game& game, const start_options::Args& args) {
+    signals.async_wait([&signals, &ioc, api_strand, &app, &game, &args](const boost::system::error_code& ec,
+                                                                        [[maybe_unused]] int signal_number) {
+        if (ec) {
+            return;
+        }
+        net::post(ioc, [&ioc, api_strand, &app, &game, &args] {
+            try {
+                model::Game loaded = args.map_bundle.empty() ? json_loader::LoadGame(args.config_file)
+                                                             : map_bundle::LoadBundle(args.map_bundle);
+                net::post(api_strand, [&ioc, &app, &game, loaded = std::move(loaded)]() mutable {
+                    try {
+                        game.CheckReloadSettings(loaded);
+                        model::Game::Maps old_maps = app.ReloadMaps(loaded.ReleaseMaps());
+                        logging_handler::LogMapsReloaded(game);
+                        // прежние карты удалит обработчик, выполненный в пуле потоков
+                        net::post(ioc, [old_maps = std::move(old_maps)] {});
+                    } catch (const std::exception& ex) {
+                        logging_handler::LogMapsReloadFailed(ex.what());
+                    }
+                });
+            } catch (const std::exception& ex) {
+                logging_handler::LogMapsReloadFailed(ex.what());
+            }
+        });
+        WaitReloadSignal(signals, ioc, api_strand, app, game, args);
+    });
+}
+
 }  // namespace
 
 int main(int argc, const char* argv[]) {
@@ -70,7 +109,14 @@ int main(int argc, const char* argv[]) {
         if ((args->autosave_period > 0) && !args->state_file.empty()) {
             autosave_file_name = args->state_file;
         }
-        model::Game game = json_loader::LoadGame(args->config_file);
+        json_loader::LoadTimes load_times;
+        model::Game game = args->map_bundle.empty() ? json_loader::LoadGame(args->config_file, &load_times)
+                                                    : map_bundle::LoadBundle(args->map_bundle);
+        logging_handler::LogMapsLoaded(game, args->map_bundle.empty() ? &load_times : nullptr);
+        if (args->seed) {
+            game.SetRandomSeed(*args->seed);
+        }
+        game.SetFixedPoint(args->fixed_point);
         players::Application app(game,
                                 args->randomize_spawn_points,
                                 args->test_mode,
@@ -114,6 +160,12 @@ int main(int argc, const char* argv[]) {
         // 8. strand для выполнения запросов к API
         auto api_strand = net::make_strand(ioc);
 
+#ifdef SIGHUP
+        // 8.1 По SIGHUP перечитываем карты без перезапуска сервера
+        net::signal_set reload_signals(ioc, SIGHUP);
+        WaitReloadSignal(reload_signals, ioc, api_strand, app, game, *args);
+#endif
+
         // 9. Создаём и запускаем обработчик передвижений игровых персонажей по карте
         if (!args->test_mode) {
             std::shared_ptr<ticker::Ticker> time_sheduler = std::make_shared<ticker::Ticker>(api_strand,
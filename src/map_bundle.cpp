@@ -0,0 +1,223 @@
+#include "map_bundle.h"
+
+#include <boost/interprocess/exceptions.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <utility>
+
+namespace map_bundle {
+
+using namespace std::literals;
+
+namespace {
+
+constexpr size_t ALIGNMENT = 8;
+constexpr std::array<char, 8> SIGNATURE = {'G', 'S', 'B', 'U', 'N', 'D', 'L', 'E'};
+constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+size_t AlignedSize(size_t size) noexcept {
+    return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+/* Наборы другой версии или собранные на другой платформе отличаются версией, порядком байтов
+ * или размерами записей, которые копируются из набора целиком */
+struct Header {
+    std::array<char, 8> signature = SIGNATURE;
+    std::uint32_t version = VERSION;
+    std::uint32_t byte_order = BYTE_ORDER_MARK;
+    std::uint32_t size_t_size = sizeof(size_t);
+    std::uint32_t road_size = sizeof(model::Road);
+    std::uint32_t building_size = sizeof(model::Building);
+    std::uint32_t interval_size = sizeof(road_index::Interval);
+    std::uint32_t segment_size = sizeof(road_graph::Segment);
+    std::uint32_t junction_size = sizeof(road_graph::Junction);
+
+    friend bool operator==(const Header&, const Header&) = default;
+};
+
+void WriteMap(Writer& ar, const model::Map& map) {
+    ar.String(*map.GetId());
+    ar.String(map.GetName());
+    ar.Value(map.GetSpeed());
+    ar.Value(map.GetBagCapacity());
+
+    ar.Size(map.GetLootTypesCount());
+    for (const model::LootType& loot_type : map.GetLootTypes()) {
+        ar.String(loot_type.GetName());
+        ar.String(loot_type.GetFile());
+        ar.String(loot_type.GetType());
+        ar.Optional(loot_type.GetRotation());
+        ar.Value(loot_type.GetColor().has_value());
+        ar.String(loot_type.GetColor().value_or(""sv));
+        ar.Value(loot_type.GetScale());
+        ar.Value(loot_type.GetScores());
+    }
+
+    map.SerializeRoads(ar);
+    ar.Array(map.GetBuildings());
+
+    ar.Size(map.GetOffices().size());
+    for (const model::Office& office : map.GetOffices()) {
+        ar.String(*office.GetId());
+        ar.Value(office.GetPosition());
+        ar.Value(office.GetOffset());
+    }
+}
+
+model::Map ReadMap(Reader& ar) {
+    std::string id;
+    std::string name;
+    double speed = 1.;
+    size_t bag_capacity = 0;
+    ar.String(id);
+    ar.String(name);
+    ar.Value(speed);
+    ar.Value(bag_capacity);
+    model::Map map(model::Map::Id{std::move(id)}, std::move(name), speed, bag_capacity);
+
+    size_t loot_types_count = 0;
+    ar.Size(loot_types_count);
+    for (size_t i = 0; i != loot_types_count; ++i) {
+        std::string loot_name;
+        std::string file;
+        std::string type;
+        std::optional<int> rotation;
+        bool has_color = false;
+        std::string color;
+        double scale = 0.;
+        size_t scores = 0;
+        ar.String(loot_name);
+        ar.String(file);
+        ar.String(type);
+        ar.Optional(rotation);
+        ar.Value(has_color);
+        ar.String(color);
+        ar.Value(scale);
+        ar.Value(scores);
+        map.AddLootType(model::LootType{loot_name, file, type, rotation,
+                                        has_color ? std::optional<std::string_view>{color} : std::nullopt,
+                                        scale, scores});
+    }
+
+    map.SerializeRoads(ar);
+    model::Map::Buildings buildings;
+    ar.Array(buildings);
+    for (const model::Building& building : buildings) {
+        map.AddBuilding(building);
+    }
+
+    size_t offices_count = 0;
+    ar.Size(offices_count);
+    for (size_t i = 0; i != offices_count; ++i) {
+        std::string office_id;
+        model::Point position{};
+        model::Offset offset{};
+        ar.String(office_id);
+        ar.Value(position);
+        ar.Value(offset);
+        map.AddOffice({model::Office::Id{std::move(office_id)}, position, offset});
+    }
+
+    map.Freeze();
+    return map;
+}
+
+} // namespace
+
+void Writer::Bytes(const void* data, size_t size) {
+    static constexpr std::array<char, ALIGNMENT> padding{};
+    out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    out_.write(padding.data(), static_cast<std::streamsize>(AlignedSize(size) - size));
+}
+
+const char* Reader::Take(size_t size) {
+    const size_t aligned_size = AlignedSize(size);
+    if ((aligned_size < size) || (aligned_size > size_ - pos_)) {
+        throw std::runtime_error("Map bundle is truncated");
+    }
+    const char* result = data_ + pos_;
+    pos_ += aligned_size;
+    return result;
+}
+
+void WriteBundle(std::ostream& out, const model::Game& game) {
+    Writer ar(out);
+    ar.Value(Header{});
+
+    // настройки игры, которые LoadGame() читает из конфигурации
+    const loot_gen::LootGenerator& loot_generator = game.GetLootGenerator();
+    ar.Value(static_cast<std::int64_t>(loot_generator.GetLootPeriod().count()));
+    ar.Value(loot_generator.GetLootProbability());
+    ar.Value(game.GetDogRetirementTime());
+    ar.Value(static_cast<std::uint64_t>(game.GetMaxDogsPerSession()));
+
+    ar.Size(game.GetMaps().size());
+    for (const model::Map& map : game.GetMaps()) {
+        WriteMap(ar, map);
+    }
+    if (!out) {
+        throw std::runtime_error("Can't write map bundle");
+    }
+}
+
+void WriteBundle(const std::filesystem::path& path, const model::Game& game) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) {
+        throw std::runtime_error("Can't open file:" + path.string());
+    }
+    WriteBundle(out, game);
+}
+
+model::Game LoadBundle(const char* data, size_t size) {
+    Reader ar(data, size);
+    Header header;
+    ar.Value(header);
+    if (header.signature != SIGNATURE) {
+        throw std::runtime_error("Not a map bundle");
+    }
+    if (!(header == Header{})) {
+        throw std::runtime_error("Map bundle version "s + std::to_string(header.version) +
+                                 " is incompatible with this server, rebuild it with bundle_compiler"s);
+    }
+
+    model::Game game;
+    std::int64_t loot_period_ms = 0;
+    double loot_probability = 0.;
+    double dog_retirement_time = 0.;
+    std::uint64_t max_dogs_per_session = 0;
+    ar.Value(loot_period_ms);
+    ar.Value(loot_probability);
+    ar.Value(dog_retirement_time);
+    ar.Value(max_dogs_per_session);
+    game.GetLootGenerator().SetLootPeriod(std::chrono::milliseconds{loot_period_ms});
+    game.GetLootGenerator().SetLootProbability(loot_probability);
+    game.SetDogRetirementTime(dog_retirement_time);
+    game.SetMaxDogsPerSession(static_cast<size_t>(max_dogs_per_session));
+
+    size_t maps_count = 0;
+    ar.Size(maps_count);
+    for (size_t i = 0; i != maps_count; ++i) {
+        game.AddMap(ReadMap(ar));
+    }
+    if (!ar.AtEnd()) {
+        throw std::runtime_error("Map bundle is corrupted");
+    }
+    return game;
+}
+
+model::Game LoadBundle(const std::filesystem::path& path) {
+    namespace bip = boost::interprocess;
+    try {
+        const bip::file_mapping file(path.string().c_str(), bip::read_only);
+        const bip::mapped_region region(file, bip::read_only);
+        return LoadBundle(static_cast<const char*>(region.get_address()), region.get_size());
+    } catch (const bip::interprocess_exception& ex) {
+        throw std::runtime_error("Can't map file " + path.string() + ": " + ex.what());
+    }
+}
+
+} // namespace map_bundle
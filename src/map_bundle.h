@@ -0,0 +1,154 @@
+/*
+ * Двоичный набор карт (map bundle) для быстрого старта сервера.
+ * Набор собирается заранее из JSON-конфигурации (bundle_compiler) и содержит настройки игры и карты
+ * вместе с уже построенными индексом и графом дорог. Сервер отображает файл в память (mmap)
+ * и копирует массивы карт целиком, без разбора JSON и без пересборки индексов.
+ *
+ * Формат: заголовок (сигнатура, версия, размеры записей массивов), затем значения и массивы подряд.
+ * Массив - число элементов и их байты. Каждое значение и массив дополняются до кратного 8 размера,
+ * поэтому массивы в отображённом файле выровнены. Набор читается только той же версией сервера
+ * на той же платформе: иначе LoadBundle() выбрасывает std::runtime_error.
+ * Набор - доверенный файл, собранный заранее: содержимое массивов индексов не перепроверяется.
+ */
+#pragma once
+#include "model.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace map_bundle {
+
+/* Увеличивается при любом изменении формата или записей массивов */
+constexpr std::uint32_t VERSION = 3;
+
+/* Записи копируются в набор байт в байт: байты выравнивания в них сделали бы набор зависящим
+ * от содержимого памяти, поэтому такие записи пишутся по полям */
+template <typename T>
+constexpr bool IS_PACKED = std::has_unique_object_representations_v<T> || std::is_floating_point_v<T>;
+
+/* Запись набора. Объекты модели пишутся константными перегрузками SerializeBundle(),
+ * читаются - неконстантными, выбор по Archive::IS_LOADING */
+class Writer {
+public:
+    static constexpr bool IS_LOADING = false;
+
+    explicit Writer(std::ostream& out)
+        : out_(out) {}
+
+    template <typename T>
+    void Value(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T> && IS_PACKED<T>);
+        Bytes(&value, sizeof(T));
+    }
+    void Size(const size_t& size) {
+        Value(static_cast<std::uint64_t>(size));
+    }
+    template <typename T>
+    void Array(const std::vector<T>& array) {
+        static_assert(std::is_trivially_copyable_v<T> && IS_PACKED<T>);
+        Size(array.size());
+        Bytes(array.data(), array.size() * sizeof(T));
+    }
+    void String(std::string_view str) {
+        Size(str.size());
+        Bytes(str.data(), str.size());
+    }
+    template <typename T>
+    void Optional(const std::optional<T>& value) {
+        Value(value.has_value());
+        if (value) {
+            Value(*value);
+        }
+    }
+
+private:
+    void Bytes(const void* data, size_t size);
+
+    std::ostream& out_;
+};
+
+/* Чтение набора из памяти (отображённого файла) с проверкой границ */
+class Reader {
+public:
+    static constexpr bool IS_LOADING = true;
+
+    Reader(const char* data, size_t size) noexcept
+        : data_(data)
+        , size_(size) {}
+
+    template <typename T>
+    void Value(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        std::memcpy(&value, Take(sizeof(T)), sizeof(T));
+    }
+    void Size(size_t& size) {
+        std::uint64_t value = 0;
+        Value(value);
+        if (value > size_) {
+            throw std::runtime_error("Map bundle is corrupted");
+        }
+        size = static_cast<size_t>(value);
+    }
+    /* Записи копируются прямо из набора: массивы в нём выровнены, а у записей может не быть
+     * конструктора по умолчанию (Road, Building) */
+    template <typename T>
+    void Array(std::vector<T>& array) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        size_t count = 0;
+        Size(count);
+        const char* bytes = Take(count * sizeof(T));
+        if (reinterpret_cast<std::uintptr_t>(bytes) % alignof(T) != 0) {
+            throw std::runtime_error("Map bundle data is not aligned");
+        }
+        const T* first = reinterpret_cast<const T*>(bytes);
+        array.assign(first, first + count);
+    }
+    void String(std::string& str) {
+        size_t size = 0;
+        Size(size);
+        str.assign(Take(size), size);
+    }
+    template <typename T>
+    void Optional(std::optional<T>& value) {
+        bool has_value = false;
+        Value(has_value);
+        if (has_value) {
+            T result{};
+            Value(result);
+            value = result;
+        } else {
+            value.reset();
+        }
+    }
+
+    bool AtEnd() const noexcept {
+        return pos_ == size_;
+    }
+
+private:
+    const char* Take(size_t size);
+
+    const char* data_;
+    size_t size_;
+    size_t pos_ = 0;
+};
+
+/* Записывает настройки игры и все её карты (карты должны быть загружены полностью) */
+void WriteBundle(std::ostream& out, const model::Game& game);
+void WriteBundle(const std::filesystem::path& path, const model::Game& game);
+
+/* Отображает файл набора в память и создаёт по нему игру */
+model::Game LoadBundle(const std::filesystem::path& path);
+/* То же для набора, уже находящегося в памяти */
+model::Game LoadBundle(const char* data, size_t size);
+
+} // namespace map_bundle
@@ -0,0 +1,82 @@
+/*
+ * map_generator - записывает конфигурацию игры с большими синтетическими картами:
+ * --roads (-r) число дорог каждой карты (по умолчанию 1000)
+ * --buildings, --offices число зданий и офисов (по умолчанию - пропорционально числу дорог)
+ * --loot-types число типов вещей (по умолчанию 3)
+ * --maps число карт (по умолчанию 1), карты получают разные зёрна
+ * --seed зерно генератора (по умолчанию 0)
+ * --output (-o) файл конфигурации (по умолчанию - стандартный вывод)
+ */
+#include "map_generator.h"
+
+#include <boost/program_options.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+int main(int argc, const char* argv[]) {
+    namespace po = boost::program_options;
+
+    size_t roads = 1000;
+    size_t buildings = 0;
+    size_t offices = 0;
+    size_t loot_types = 3;
+    size_t maps_count = 1;
+    std::uint64_t seed = 0;
+    std::string output;
+
+    po::options_description desc{"Allowed options"};
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("roads,r", po::value(&roads)->value_name("count"s), "set roads count of every map")
+        ("buildings", po::value(&buildings)->value_name("count"s), "set buildings count")
+        ("offices", po::value(&offices)->value_name("count"s), "set offices count")
+        ("loot-types", po::value(&loot_types)->value_name("count"s), "set loot types count")
+        ("maps", po::value(&maps_count)->value_name("count"s), "set maps count")
+        ("seed", po::value(&seed)->value_name("number"s), "set random seed")
+        ("output,o", po::value(&output)->value_name("file"s), "set output config file path");
+
+    try {
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+        if (vm.contains("help"s)) {
+            std::cout << desc;
+            return EXIT_SUCCESS;
+        }
+
+        std::vector<map_generator::MapData> maps;
+        for (size_t i = 0; i != maps_count; ++i) {
+            map_generator::MapParams params = map_generator::MakeCityParams("city"s + std::to_string(i), roads, seed + i);
+            if (vm.contains("buildings"s)) {
+                params.buildings = buildings;
+            }
+            if (vm.contains("offices"s)) {
+                params.offices = offices;
+            }
+            params.loot_types = loot_types;
+            maps.push_back(map_generator::GenerateMap(params));
+        }
+
+        if (output.empty()) {
+            map_generator::WriteConfig(std::cout, maps);
+        } else {
+            std::ofstream out(output);
+            if (!out.is_open()) {
+                throw std::runtime_error("Can't open file:" + output);
+            }
+            map_generator::WriteConfig(out, maps);
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,195 @@
+#include "map_generator.h"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <random>
+#include <set>
+#include <sstream>
+#include <utility>
+
+namespace map_generator {
+
+namespace {
+
+/* Доля отрезков сетки, которые остаются дорогами: остальные выбрасываются, и в сети появляются тупики */
+constexpr double ROADS_DENSITY = 0.9;
+
+/* Отступ здания от осей улиц, ширина дороги 0.8 */
+constexpr int BUILDING_MARGIN = 2;
+
+/* Число перекрёстков на стороне сетки: отрезков в ней 2 * side * (side - 1) */
+int GridSide(size_t roads) {
+    int side = 2;
+    while (static_cast<double>(2 * side * (side - 1)) * ROADS_DENSITY < static_cast<double>(roads)) {
+        ++side;
+    }
+    return side;
+}
+
+/* count разных индексов из [0, total) в порядке возрастания */
+std::vector<size_t> SampleIndices(size_t total, size_t count, std::mt19937_64& generator) {
+    std::vector<size_t> indices(total);
+    std::iota(indices.begin(), indices.end(), 0);
+    std::shuffle(indices.begin(), indices.end(), generator);
+    indices.resize(std::min(count, total));
+    std::sort(indices.begin(), indices.end());
+    return indices;
+}
+
+void AddRoads(const MapParams& params, int side, std::mt19937_64& generator, MapData& map) {
+    /* отрезки сетки: сначала горизонтальные (side строк по side - 1), затем вертикальные */
+    const size_t horizontal_count = static_cast<size_t>(side) * (side - 1);
+    std::bernoulli_distribution reverse_gen(0.5);
+    map.roads.reserve(params.roads);
+    for (size_t idx : SampleIndices(2 * horizontal_count, params.roads, generator)) {
+        const bool horizontal = (idx < horizontal_count);
+        const size_t local = horizontal ? idx : idx - horizontal_count;
+        const int line = static_cast<int>(local / (side - 1)) * BLOCK_STEP;
+        const int from = static_cast<int>(local % (side - 1)) * BLOCK_STEP;
+        int start = from;
+        int end = from + BLOCK_STEP;
+        // в настоящих конфигурациях дороги задаются в обе стороны
+        if (reverse_gen(generator)) {
+            std::swap(start, end);
+        }
+        if (horizontal) {
+            map.roads.push_back(Road{start, line, end, line, true});
+        } else {
+            map.roads.push_back(Road{line, start, line, end, false});
+        }
+    }
+}
+
+void AddBuildings(const MapParams& params, int side, std::mt19937_64& generator, MapData& map) {
+    const size_t blocks_in_row = static_cast<size_t>(side - 1);
+    std::uniform_int_distribution<int> shrink_gen(0, BLOCK_STEP / 4);
+    map.buildings.reserve(params.buildings);
+    for (size_t idx : SampleIndices(blocks_in_row * blocks_in_row, params.buildings, generator)) {
+        const int x = static_cast<int>(idx % blocks_in_row) * BLOCK_STEP + BUILDING_MARGIN;
+        const int y = static_cast<int>(idx / blocks_in_row) * BLOCK_STEP + BUILDING_MARGIN;
+        const int size = BLOCK_STEP - 2 * BUILDING_MARGIN;
+        map.buildings.push_back(Building{x, y, size - shrink_gen(generator), size - shrink_gen(generator)});
+    }
+}
+
+/* Офисы ставятся в начала случайных дорог, поэтому всегда лежат на дороге */
+void AddOffices(const MapParams& params, std::mt19937_64& generator, MapData& map) {
+    std::set<std::pair<int, int>> used;
+    std::uniform_int_distribution<int> offset_gen(-5, 5);
+    for (size_t idx : SampleIndices(map.roads.size(), map.roads.size(), generator)) {
+        if (map.offices.size() == params.offices) {
+            break;
+        }
+        const Road& road = map.roads[idx];
+        if (!used.emplace(road.x0, road.y0).second) {
+            continue;
+        }
+        map.offices.push_back(Office{"o" + std::to_string(map.offices.size()), road.x0, road.y0,
+                                     offset_gen(generator), offset_gen(generator)});
+    }
+}
+
+void AddLootTypes(const MapParams& params, MapData& map) {
+    const std::array<const char*, 4> files = {"assets/key.obj", "assets/wallet.obj", "assets/bag.obj", "assets/cup.obj"};
+    const std::array<const char*, 4> colors = {"#338844", "#883344", "#334488", "#888833"};
+    for (size_t i = 0; i != params.loot_types; ++i) {
+        map.loot_types.push_back(LootType{"loot" + std::to_string(i), files[i % files.size()],
+                                          static_cast<int>(i % 4) * 90, colors[i % colors.size()],
+                                          0.01 * static_cast<double>(1 + i % 3), static_cast<int>(10 * (i + 1))});
+    }
+}
+
+/* Значения, которые LoadGame() читает через as_double(), должны быть записаны с дробной частью */
+std::string FormatDouble(double value) {
+    std::ostringstream out;
+    out << value;
+    std::string result = out.str();
+    if (result.find_first_of(".e") == std::string::npos) {
+        result += ".0";
+    }
+    return result;
+}
+
+std::string Quote(const std::string& str) {
+    std::string result = "\"";
+    for (char c : str) {
+        if ((c == '"') || (c == '\\')) {
+            result += '\\';
+        }
+        result += c;
+    }
+    result += '"';
+    return result;
+}
+
+void WriteMap(std::ostream& out, const MapData& map) {
+    out << "{\"id\":" << Quote(map.params.id) << ",\"name\":" << Quote("Generated " + map.params.id)
+        << ",\"dogSpeed\":" << FormatDouble(map.params.dog_speed)
+        << ",\"bagCapacity\":" << map.params.bag_capacity << ",\n\"lootTypes\":[";
+    for (size_t i = 0; i != map.loot_types.size(); ++i) {
+        const LootType& loot = map.loot_types[i];
+        out << (i == 0 ? "\n" : ",\n") << "{\"name\":" << Quote(loot.name) << ",\"file\":" << Quote(loot.file)
+            << ",\"type\":\"obj\",\"rotation\":" << loot.rotation << ",\"color\":" << Quote(loot.color)
+            << ",\"scale\":" << FormatDouble(loot.scale) << ",\"value\":" << loot.value << '}';
+    }
+    out << "],\n\"roads\":[";
+    for (size_t i = 0; i != map.roads.size(); ++i) {
+        const Road& road = map.roads[i];
+        out << (i == 0 ? "\n" : ",\n") << "{\"x0\":" << road.x0 << ",\"y0\":" << road.y0;
+        if (road.horizontal) {
+            out << ",\"x1\":" << road.x1 << '}';
+        } else {
+            out << ",\"y1\":" << road.y1 << '}';
+        }
+    }
+    out << "],\n\"buildings\":[";
+    for (size_t i = 0; i != map.buildings.size(); ++i) {
+        const Building& building = map.buildings[i];
+        out << (i == 0 ? "\n" : ",\n") << "{\"x\":" << building.x << ",\"y\":" << building.y
+            << ",\"w\":" << building.w << ",\"h\":" << building.h << '}';
+    }
+    out << "],\n\"offices\":[";
+    for (size_t i = 0; i != map.offices.size(); ++i) {
+        const Office& office = map.offices[i];
+        out << (i == 0 ? "\n" : ",\n") << "{\"id\":" << Quote(office.id) << ",\"x\":" << office.x
+            << ",\"y\":" << office.y << ",\"offsetX\":" << office.offset_x << ",\"offsetY\":" << office.offset_y << '}';
+    }
+    out << "]}";
+}
+
+} // namespace
+
+MapParams MakeCityParams(std::string id, size_t roads, std::uint64_t seed) {
+    MapParams params;
+    params.id = std::move(id);
+    params.roads = roads;
+    params.buildings = roads / 4;
+    params.offices = std::max<size_t>(1, roads / 1000);
+    params.seed = seed;
+    return params;
+}
+
+MapData GenerateMap(const MapParams& params) {
+    MapData map;
+    map.params = params;
+    std::mt19937_64 generator(params.seed);
+    const int side = GridSide(params.roads);
+    AddRoads(params, side, generator, map);
+    AddBuildings(params, side, generator, map);
+    AddOffices(params, generator, map);
+    AddLootTypes(params, map);
+    return map;
+}
+
+void WriteConfig(std::ostream& out, const std::vector<MapData>& maps) {
+    out << "{\"defaultDogSpeed\":3.0,\n\"lootGeneratorConfig\":{\"period\":5.0,\"probability\":0.5},\n"
+        << "\"dogRetirementTime\":60.0,\n\"maps\":[";
+    for (size_t i = 0; i != maps.size(); ++i) {
+        out << (i == 0 ? "\n" : ",\n");
+        WriteMap(out, maps[i]);
+    }
+    out << "]}\n";
+}
+
+} // namespace map_generator
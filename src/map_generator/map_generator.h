@@ -0,0 +1,81 @@
+/*
+ * Генератор больших синтетических карт для замеров масштабируемости.
+ * Карта - квартальная сетка города: перекрёстки с шагом BLOCK_STEP, дороги - отрезки улиц между
+ * соседними перекрёстками (часть отрезков выбрасывается, чтобы сеть не была идеальной),
+ * здания стоят внутри кварталов, офисы - на перекрёстках.
+ * Конфигурация записывается в формате, который читает json_loader::LoadGame().
+ * При одинаковом зерне генератор всегда выдаёт одну и ту же конфигурацию.
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace map_generator {
+
+constexpr int BLOCK_STEP = 20;
+
+struct MapParams {
+    std::string id;
+    size_t roads = 1000;
+    size_t buildings = 250;
+    size_t offices = 10;
+    size_t loot_types = 3;
+    double dog_speed = 3.;
+    size_t bag_capacity = 3;
+    std::uint64_t seed = 0;
+};
+
+struct Road {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+    bool horizontal;
+};
+
+struct Building {
+    int x;
+    int y;
+    int w;
+    int h;
+};
+
+struct Office {
+    std::string id;
+    int x;
+    int y;
+    int offset_x;
+    int offset_y;
+};
+
+struct LootType {
+    std::string name;
+    std::string file;
+    int rotation;
+    std::string color;
+    double scale;
+    int value;
+};
+
+struct MapData {
+    MapParams params;
+    std::vector<Road> roads;
+    std::vector<Building> buildings;
+    std::vector<Office> offices;
+    std::vector<LootType> loot_types;
+};
+
+/* Параметры карты, у которой число зданий и офисов выбрано пропорционально числу дорог */
+MapParams MakeCityParams(std::string id, size_t roads, std::uint64_t seed = 0);
+
+/* Генерирует карту по параметрам. Здания занимают кварталы без повторов, поэтому их не больше числа кварталов,
+ * офисы стоят на разных перекрёстках - их не больше числа перекрёстков */
+MapData GenerateMap(const MapParams& params);
+
+/* Записывает конфигурацию игры со всеми картами maps */
+void WriteConfig(std::ostream& out, const std::vector<MapData>& maps);
+
+} // namespace map_generator
@@ -9,10 +9,12 @@ namespace model {
 using namespace std::literals;
 
 void Map::AddLootType(LootType loot_type) {
+    ThrowIfFrozen();
     loot_types_.emplace_back(std::move(loot_type));
 }
 
 void Map::AddOffice(Office office) {
+    ThrowIfFrozen();
     if (warehouse_id_to_index_.contains(office.GetId())) {
         throw std::invalid_argument("Duplicate warehouse");
     }
@@ -25,17 +27,43 @@ void Map::AddOffice(Office office) {
         offices_.pop_back();
         throw;
     }
+    office_positions_.push_back({static_cast<double>(o.GetPosition().x), static_cast<double>(o.GetPosition().y)});
+    office_widths_.push_back(LostObject::OFFICE_HALF_WIDTH);
 }
 
 /*
  * Считаем что в каждой координате может быть от ноля до двух вертикальных дорог
  * и от ноля до двух горизонтальных. (Могут быть перекрёстки 3-х и 4-х дорог)
- * К массиву дорог добавляется 3 вспомогательных контейнера:
- * - normal_roads_  - массив дорог с нормализованными координатами (координаты начала меньше координат конца)
- * - hor_roads_     - unordered_map< Y-координата дороги, индекс в normal_roads_ >
- * - vert_roads_    - unordered_map< X-координата дороги, индекс в normal_roads_ >
+ * К массиву дорог добавляется 2 вспомогательных контейнера:
+ * - road_index_    - отсортированные отрезки дорог по строкам (Y-координата) и столбцам (X-координата),
+ *                    координаты начала отрезка меньше координат конца
+ * - road_graph_    - участки и перекрёстки, собранные из road_index_. Добавление дорог только помечает граф
+ *                    устаревшим, он собирается один раз в Freeze() или при первом обращении (GetRoadGraph())
  */
 void Map::AddRoad(const Road &road) {
+    ThrowIfFrozen();
+    StoreRoad(road);
+    road_graph_dirty_ = true;
+}
+
+void Map::AddRoads(const Roads& roads) {
+    ThrowIfFrozen();
+    roads_.reserve(roads_.size() + roads.size());
+    for (const Road& road : roads) {
+        StoreRoad(road);
+    }
+    road_graph_dirty_ = true;
+}
+
+const road_graph::RoadGraph& Map::GetRoadGraph() const {
+    if (road_graph_dirty_) {
+        road_graph_.Build(road_index_);
+        road_graph_dirty_ = false;
+    }
+    return road_graph_;
+}
+
+void Map::StoreRoad(const Road &road) {
     Point start = road.GetStart();
     Point end = road.GetEnd();
 
@@ -45,16 +73,57 @@ void Map::AddRoad(const Road &road) {
     if (start.y > end.y) {
         std::swap(start.y, end.y);
     }
+    const size_t road_idx = roads_.size();
     if (road.IsHorizontal()) {
-        normal_roads_.emplace_back(Road::HORIZONTAL, start, end.x);
-        hor_roads_.insert({start.y, normal_roads_.size() - 1});
+        road_index_.AddHorizontal(start.y, start.x, end.x, road_idx);
     } else {
-        normal_roads_.emplace_back(Road::VERTICAL, start, end.y);
-        vert_roads_.insert({start.x, normal_roads_.size() - 1});
+        road_index_.AddVertical(start.x, start.y, end.y, road_idx);
     }
     roads_.emplace_back(road);
 }
 
+void Map::ThrowIfFrozen() const {
+    if (frozen_) {
+        throw std::logic_error("Map "s + *id_ + " is frozen"s);
+    }
+}
+
+void Map::Freeze() {
+    GetRoadGraph();
+    roads_.shrink_to_fit();
+    buildings_.shrink_to_fit();
+    offices_.shrink_to_fit();
+    office_positions_.shrink_to_fit();
+    office_widths_.shrink_to_fit();
+    loot_types_.shrink_to_fit();
+    OfficeIdToIndex{}.swap(warehouse_id_to_index_);
+    road_index_.ShrinkToFit();
+    frozen_ = true;
+}
+
+size_t Map::GetMemoryUsage() const noexcept {
+    const size_t empty_string_capacity = std::string{}.capacity();
+    auto string_memory = [empty_string_capacity](const std::string& str) -> size_t {
+        return (str.capacity() > empty_string_capacity) ? str.capacity() + 1 : 0;
+    };
+    size_t memory = sizeof(Map) + string_memory(*id_) + string_memory(name_);
+    memory += roads_.capacity() * sizeof(Road);
+    memory += buildings_.capacity() * sizeof(Building);
+    memory += offices_.capacity() * sizeof(Office);
+    memory += office_positions_.capacity() * sizeof(Position) + office_widths_.capacity() * sizeof(double);
+    for (const Office& office : offices_) {
+        memory += string_memory(*office.GetId());
+    }
+    // узел, указатель корзины и значение с копией id
+    memory += warehouse_id_to_index_.bucket_count() * sizeof(void*);
+    for (const auto& [office_id, index] : warehouse_id_to_index_) {
+        memory += 2 * sizeof(void*) + sizeof(std::pair<const Office::Id, size_t>) + string_memory(*office_id);
+    }
+    memory += loot_types_.capacity() * sizeof(LootType);
+    memory += road_index_.GetMemoryUsage() + road_graph_.GetMemoryUsage();
+    return memory;
+}
+
 void Game::AddMap(Map map) {
     const size_t index = maps_.size();
     if (auto [it, inserted] = map_id_to_index_.emplace(map.GetId(), index); !inserted) {
@@ -62,49 +131,154 @@ void Game::AddMap(Map map) {
     } else {
         try {
             maps_.emplace_back(std::move(map));
-            sessions_.push_back(Sessions{});
+            maps_.back().SetRandomEngine(random_source_.MakeEngine(RandomSource::Stream::MAP, next_map_stream_));
+            maps_.back().SetFixedPoint(fixed_point_);
+            ++next_map_stream_;
         } catch (...) {
             map_id_to_index_.erase(it);
-            sessions_.pop_back();
             throw;
         }
     }
 }
 
+void Game::SetRandomSeed(RandomSource::Seed seed) {
+    random_source_ = RandomSource(seed);
+    for (size_t index = 0; index != maps_.size(); ++index) {
+        maps_[index].SetRandomEngine(random_source_.MakeEngine(RandomSource::Stream::MAP,
+                                                               static_cast<std::uint32_t>(index)));
+    }
+    next_map_stream_ = static_cast<std::uint32_t>(maps_.size());
+}
+
+void Game::SetFixedPoint(bool fixed_point) noexcept {
+    fixed_point_ = fixed_point;
+    for (Map& map : maps_) {
+        map.SetFixedPoint(fixed_point);
+    }
+}
+
+Game::Maps Game::ReplaceMaps(Maps maps) {
+    MapIdToIndex map_id_to_index;
+    for (size_t index = 0; index != maps.size(); ++index) {
+        if (!map_id_to_index.emplace(maps[index].GetId(), index).second) {
+            throw std::invalid_argument("Map with id "s + *maps[index].GetId() + " already exists"s);
+        }
+    }
+    std::vector<Sessions> sessions;
+    std::vector<size_t> session_map_indices;
+    for (const Sessions& session : sessions_) {
+        const Map::Id& map_id = session->GetMap()->GetId();
+        if (auto it = map_id_to_index.find(map_id); it != map_id_to_index.end()) {
+            sessions.push_back(session);
+            session_map_indices.push_back(it->second);
+        } else if (session->CountDogsInSession() != 0) {
+            throw std::invalid_argument("Map "s + *map_id + " has players and can't be removed"s);
+        }
+    }
+    std::uint32_t next_map_stream = next_map_stream_;
+    for (Map& map : maps) {
+        if (auto it = map_id_to_index_.find(map.GetId()); it != map_id_to_index_.end()) {
+            map.SetRandomEngine(maps_[it->second].GetRandomEngine());
+        } else {
+            map.SetRandomEngine(random_source_.MakeEngine(RandomSource::Stream::MAP, next_map_stream++));
+        }
+        map.SetFixedPoint(fixed_point_);
+    }
+
+    maps_.swap(maps);
+    map_id_to_index_.swap(map_id_to_index);
+    sessions_.swap(sessions);
+    next_map_stream_ = next_map_stream;
+    for (size_t index = 0; index != sessions_.size(); ++index) {
+        sessions_[index]->SetMap(&maps_[session_map_indices[index]]);
+    }
+    return maps;
+}
+
+void Game::CheckReloadSettings(const Game& loaded) const {
+    if ((loaded.loot_generator_.GetLootPeriod() != loot_generator_.GetLootPeriod()) ||
+        (loaded.loot_generator_.GetLootProbability() != loot_generator_.GetLootProbability())) {
+        throw std::invalid_argument("Loot generator settings can't be changed without restart"s);
+    }
+    if (loaded.dog_retirement_time_ != dog_retirement_time_) {
+        throw std::invalid_argument("Dog retirement time can't be changed without restart"s);
+    }
+    if (loaded.max_dogs_per_session_ != max_dogs_per_session_) {
+        throw std::invalid_argument("Max dogs per session can't be changed without restart"s);
+    }
+}
+
+Game::Maps Game::ReleaseMaps() noexcept {
+    Maps maps = std::move(maps_);
+    maps_.clear();
+    map_id_to_index_.clear();
+    sessions_.clear();
+    return maps;
+}
+
+size_t Game::CountActiveSessions() const noexcept {
+    return sessions_.size() - CountHibernatedSessions();
+}
+
+size_t Game::CountHibernatedSessions() const noexcept {
+    return std::count_if(sessions_.begin(), sessions_.end(), [](const Sessions& session) {
+        return session->IsHibernated();
+    });
+}
+
 std::shared_ptr<GameSession> Game::PlacePlayerOnMap(const Map::Id& map_id) {
     if (map_id_to_index_.count(map_id) == 0) {
         return nullptr;
     }
-    const size_t map_index = map_id_to_index_.at(map_id);
-    if (sessions_[map_index] == nullptr) {
-        sessions_[map_index] = std::make_shared<model::GameSession>(model::GameSession(&maps_[map_index]));
+    Map* map = &maps_[map_id_to_index_.at(map_id)];
+    std::shared_ptr<GameSession> least_loaded;
+    size_t next_instance_id = 0;
+    for (const Sessions& session : sessions_) {
+        if (session->GetMap() != map) {
+            continue;
+        }
+        next_instance_id = std::max(next_instance_id, session->GetInstanceId() + 1);
+        const size_t dogs = session->CountDogsInSession();
+        if ((dogs < max_dogs_per_session_) &&
+            ((least_loaded == nullptr) || (dogs < least_loaded->CountDogsInSession()))) {
+            least_loaded = session;
+        }
     }
-    return sessions_[map_index];
+    if (least_loaded == nullptr) {
+        least_loaded = std::make_shared<GameSession>(map, next_instance_id, loot_generator_);
+        sessions_.push_back(least_loaded);
+    }
+    return least_loaded;
 }
 
 Position Map::GetRandomPositionOnRoads() const {
     Position res_pos;
-    // определить дорогу
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> road_gen(0, normal_roads_.size() - 1);
-    const Road& rand_road = normal_roads_[road_gen(gen)];
-    // определить позицию на дороге
-    if (rand_road.IsHorizontal()) {
-        res_pos.y = rand_road.GetStart().y;
-        std::uniform_int_distribution<> coord_gen(rand_road.GetStart().x, rand_road.GetEnd().x);
-        res_pos.x = coord_gen(gen);
+    if (GetRoadGraph().GetSegments().empty()) {
+        return res_pos;
+    }
+    // определить участок дороги
+    const road_graph::Segment& segment = GetRoadGraph().GetSegment(GetRoadGraph().SampleSegment(random_engine_));
+    // определить позицию на участке
+    std::uniform_int_distribution<Coord> coord_gen(segment.start, segment.end);
+    if (segment.axis == road_graph::Axis::HORIZONTAL) {
+        res_pos.x = coord_gen(random_engine_);
+        res_pos.y = segment.key;
     } else {
-        res_pos.x = rand_road.GetStart().x;
-        std::uniform_int_distribution<> coord_gen(rand_road.GetStart().y, rand_road.GetEnd().y);
-        res_pos.y = coord_gen(gen);
+        res_pos.x = segment.key;
+        res_pos.y = coord_gen(random_engine_);
     }
     return res_pos;
 }
 
+size_t Map::GetRandomLootType() const {
+    std::uniform_int_distribution<size_t> type_gen(0, loot_types_.size() - 1);
+    return type_gen(random_engine_);
+}
+
 Position Map::GetTestPositionOnRoads() const noexcept {
-    return {static_cast<double>(normal_roads_[0].GetStart().x),
-            static_cast<double>(normal_roads_[0].GetStart().y)};
+    const Road& road = roads_[0];
+    return {static_cast<double>(std::min(road.GetStart().x, road.GetEnd().x)),
+            static_cast<double>(std::min(road.GetStart().y, road.GetEnd().y))};
 }
 
 namespace detail {
@@ -117,26 +291,8 @@ namespace detail {
         return static_cast<Coord>(pos - round_delta);
     }
 
-    /* Дороги общие для начальной точки пути и для конечной точки пути */
-    bool FoundRoad(const std::vector<size_t> &roads_now, const std::vector<size_t> &roads_future) {
-        if (!roads_now.empty() && !roads_future.empty()) {
-            /* предполагается малое число элементов в векторах */
-            return std::any_of(roads_now.begin(), roads_now.end(), [&roads_future](size_t road_n) {
-                return (std::find(roads_future.begin(), roads_future.end(), road_n) != roads_future.end());
-            });
-        }
-
-        return false;
-    }
-
-    /* Нашли ли мы дорогу длиннее */
-    bool FoundBigger(double &max_length, size_t &long_road_idx, double length, size_t j) {
-        if (max_length < length) {
-            max_length = length;
-            long_road_idx = j;
-            return true;
-        }
-        return false;
+    Point RoundPoint(const Position& pos) {
+        return {RoundPosition(pos.x), RoundPosition(pos.y)};
     }
 
     bool DoubleIsZero(double val) {
@@ -147,67 +303,113 @@ namespace detail {
         return false;
     }
 
+    /* Та же дорога с координатами начала не больше координат конца */
+    Road NormalRoad(const Road& road) noexcept {
+        const Point start = road.GetStart();
+        const Point end = road.GetEnd();
+        if (road.IsHorizontal()) {
+            return Road(Road::HORIZONTAL, {std::min(start.x, end.x), start.y}, std::max(start.x, end.x));
+        }
+        return Road(Road::VERTICAL, {start.x, std::min(start.y, end.y)}, std::max(start.y, end.y));
+    }
+
 } // namespace detail
 
 /*
  * Расчёт передвижения собаки по дорогам (возвращает новое разрешённое состояние собаки):
- * 1) Находим перечень дорог на которых может находиться собака (сейчас)
- * 2) Расчитываем ожидаемое положение
- * 3) Находим перечень дорог где может находиться собака (после перемещения)
- * 4) Если есть общая дорога для шагов 1 и 3, значит перемещаем собаку
- * 5) Если общей дороги нет, то перемещаем собаку на границу дороги и останавливаем
- * 5.1) Поиск границы дороги вдоль осуществляется исходя из направления движения перебором всех текущих дорог
- * 5.2) Если собака находится в крайней точке дороги, то перемещаем её на 0.4 (по направлению движения) и останавливаем
- * 5.3) Если движемся поперёк дороги, то перемещаем собаку на 0.4 (по направлению движения) и останавливаем
+ * 1) Расчитываем ожидаемое положение
+ * 2) Находим участок графа дорог, на котором стоит собака, в направлении её движения
+ * 3) Если ожидаемое положение лежит на этом участке, значит перемещаем собаку
+ * 4) Иначе перемещаем собаку на границу участка и останавливаем
+ * 4.1) Если собака находится в крайней точке участка, то перемещаем её на 0.4 (по направлению движения) и останавливаем
+ * 4.2) Если движемся поперёк дороги, то перемещаем собаку на 0.4 (по направлению движения) и останавливаем
  */
 DogState Map::MoveDog(const std::shared_ptr<Dog> dog, double time) const {
-    Position pos_now = dog->GetDogState().position;
-    Velocity dog_speed = dog->GetDogState().velocity;
-    DogState new_dog_state = dog->GetDogState();
+    const DogState& state = dog->GetDogState();
+    if (fixed_point_) {
+        DogRoad dog_road = dog->GetRoad();
+        DogState new_state = ResolveMoveFixed(state, time, dog_road);
+        dog->SetRoad(dog_road);
+        return new_state;
+    }
+    Position pos_future = {state.position.x + (time * state.velocity.x),
+                           state.position.y + (time * state.velocity.y)};
+    DogRoad dog_road = dog->GetRoad();
+    DogState new_state = ResolveMove(state, pos_future, dog_road);
+    dog->SetRoad(dog_road);
+    return new_state;
+}
+
+/*
+ * Пакетное перемещение всех собак сессии:
+ * 1) расчёт ожидаемых положений - простой цикл по массивам, который компилятор может векторизовать
+ * 2) ограничение перемещения дорогами карты - для каждой собаки так же, как в MoveDog()
+ */
+void Map::MoveDogs(DogsMovement& dogs, double time) const {
+    const size_t count = dogs.Size();
+    if (fixed_point_) {
+        for (size_t i = 0; i < count; ++i) {
+            dogs.SetState(i, ResolveMoveFixed(dogs.GetState(i), time, dogs.road[i]));
+        }
+        return;
+    }
+    dogs.future_x.resize(count);
+    dogs.future_y.resize(count);
+
+    const double* __restrict pos_x = dogs.pos_x.data();
+    const double* __restrict pos_y = dogs.pos_y.data();
+    const double* __restrict speed_x = dogs.speed_x.data();
+    const double* __restrict speed_y = dogs.speed_y.data();
+    double* __restrict future_x = dogs.future_x.data();
+    double* __restrict future_y = dogs.future_y.data();
+    for (size_t i = 0; i < count; ++i) {
+        future_x[i] = pos_x[i] + (time * speed_x[i]);
+        future_y[i] = pos_y[i] + (time * speed_y[i]);
+    }
 
-    std::vector<size_t> roads_now = GetRoadByPosition(pos_now);
+    for (size_t i = 0; i < count; ++i) {
+        DogState state = ResolveMove(dogs.GetState(i), {dogs.future_x[i], dogs.future_y[i]}, dogs.road[i]);
+        dogs.SetState(i, state);
+    }
+}
 
-    Position pos_future = {pos_now.x + (time * dog_speed.x), pos_now.y + (time * dog_speed.y)};
-    std::vector<size_t> roads_future = GetRoadByPosition(pos_future);
+/* Возвращает разрешённое состояние собаки, которая из состояния state пытается попасть в точку pos_future.
+ * Собака движется по прямой в направлении state.direction и может дойти до конца участка графа дорог,
+ * на котором стоит, поэтому даже большой шаг по времени ограничивается за одно сравнение с концом участка.
+ * dog_road - дорога собаки: пока собака остаётся на её участке, участок не ищется,
+ * после перемещения подсказка обновляется для новой позиции */
+DogState Map::ResolveMove(const DogState& state, const Position& pos_future, DogRoad& dog_road) const {
+    Position pos_now = state.position;
+    Velocity dog_speed = state.velocity;
+    DogState new_dog_state = state;
 
-    if (detail::FoundRoad(roads_now, roads_future)) { // можно переместиться в конечную точку
+    const Point cell_now = detail::RoundPoint(pos_now);
+    const Point cell_future = detail::RoundPoint(pos_future);
+    const bool horizontal = (state.direction == Direction::EAST) || (state.direction == Direction::WEST);
+    const road_graph::Axis axis = horizontal ? road_graph::Axis::HORIZONTAL : road_graph::Axis::VERTICAL;
+    const road_graph::Segment* segment = FindDogSegment(dog_road, cell_now, axis);
+
+    if (CanMove(dog_road, segment, cell_now, cell_future, axis)) { // можно переместиться в конечную точку
         new_dog_state.position = pos_future;
-    } else { // нельзя переместиться в конечную точку - нужно найти максимальную доступную крайнюю точку
-        /* Ищем дорогу, которая позволяет уехать максимально далеко в нужном направлении */
+    } else { // нельзя переместиться в конечную точку - идём до конца участка в направлении движения
         bool calculated = false;
-        size_t long_road_idx = 0;
         double max_length = 0.;
-        for (size_t i = 0; i < roads_now.size(); ++i) {
-            switch (dog->GetDogState().direction) {
-            case Direction::EAST: { // "R" — задаёт направление движения персонажа вправо (на восток) - скорость равна {s, 0}.
-                size_t j = roads_now[i];
-                if (normal_roads_[j].IsHorizontal()) {
-                    calculated = detail::FoundBigger(max_length, long_road_idx, (normal_roads_[j].GetEnd().x - pos_now.x), j);
-                }
+        if (segment != nullptr) {
+            switch (state.direction) {
+            case Direction::EAST: // "R" — задаёт направление движения персонажа вправо (на восток) - скорость равна {s, 0}.
+                max_length = segment->end - pos_now.x;
                 break;
-            }
-            case Direction::WEST: { // "L" — задаёт направление движения персонажа влево (на запад) - скорость равна {-s, 0}.
-                size_t j = roads_now[i];
-                if (normal_roads_[j].IsHorizontal()) {
-                    calculated = detail::FoundBigger(max_length, long_road_idx, (pos_now.x - normal_roads_[j].GetStart().x), j);
-                }
+            case Direction::WEST: // "L" — задаёт направление движения персонажа влево (на запад) - скорость равна {-s, 0}.
+                max_length = pos_now.x - segment->start;
                 break;
-            }
-            case Direction::NORTH: { // "U" — задаёт направление движения персонажа вверх (на север) - скорость равна {0, -s}.
-                size_t j = roads_now[i];
-                if (normal_roads_[j].IsVertical()) {
-                    calculated = detail::FoundBigger(max_length, long_road_idx, (pos_now.y - normal_roads_[j].GetStart().y), j);
-                }
+            case Direction::NORTH: // "U" — задаёт направление движения персонажа вверх (на север) - скорость равна {0, -s}.
+                max_length = pos_now.y - segment->start;
                 break;
-            }
-            case Direction::SOUTH: { // "D" — задаёт направление движения персонажа вниз (на юг) - скорость равна {0, s}.
-                size_t j = roads_now[i];
-                if (normal_roads_[j].IsVertical()) {
-                    calculated = detail::FoundBigger(max_length, long_road_idx, (normal_roads_[j].GetEnd().y - pos_now.y), j);
-                }
+            case Direction::SOUTH: // "D" — задаёт направление движения персонажа вниз (на юг) - скорость равна {0, s}.
+                max_length = segment->end - pos_now.y;
                 break;
             }
-            }
+            calculated = (max_length > 0.);
         }
         double speed_sign_x = 1.;
         double speed_sign_y = 1.;
@@ -218,7 +420,7 @@ DogState Map::MoveDog(const std::shared_ptr<Dog> dog, double time) const {
             speed_sign_y = dog_speed.y / std::fabs(dog_speed.y);
         }
         if (calculated) { /* Движемся вдоль дороги и не в крайней точке */
-            if (normal_roads_[long_road_idx].IsHorizontal()) {
+            if (horizontal) {
                 if (!detail::DoubleIsZero(max_length)) {
                     new_dog_state.position.x += ((max_length + HALF_ROAD_WIDE) * speed_sign_x);
                 } else {
@@ -244,33 +446,199 @@ DogState Map::MoveDog(const std::shared_ptr<Dog> dog, double time) const {
         new_dog_state.velocity.x = 0.;
         new_dog_state.velocity.y = 0.;
     }
+    UpdateDogRoad(dog_road, detail::RoundPoint(new_dog_state.position));
     return new_dog_state;
 }
 
-std::vector<size_t> Map::GetRoadByPosition(const Position &pos) const {
-    Point cur_pos{detail::RoundPosition(pos.x), detail::RoundPosition(pos.y)};
-    std::vector<size_t> found_road_idxs;
-    if (hor_roads_.count(cur_pos.y) > 0) {
-        // Нашли хотя бы одну горизонтальную дорогу
-        auto bucket_idx = hor_roads_.bucket(cur_pos.y);
-        for (auto it = hor_roads_.begin(bucket_idx); it != hor_roads_.end(bucket_idx); ++it) {
-            if ((cur_pos.x >= normal_roads_[it->second].GetStart().x) &&
-                (cur_pos.x <= normal_roads_[it->second].GetEnd().x)) {
-                found_road_idxs.push_back(it->second);
+/* Перемещение в режиме фиксированной точки: те же правила, что в ResolveMove(), но в целых числах.
+ * Положение в ответе точно равно значению с фиксированной точкой, поэтому следующий тик начинается без потерь */
+DogState Map::ResolveMoveFixed(const DogState& state, double time, DogRoad& dog_road) const {
+    using namespace fixed_point;
+
+    const Fixed speed_x = FromDouble(state.velocity.x);
+    const Fixed speed_y = FromDouble(state.velocity.y);
+    Fixed pos_x = FromPosition(state.position.x, detail::RoundPosition(state.position.x));
+    Fixed pos_y = FromPosition(state.position.y, detail::RoundPosition(state.position.y));
+    const Fixed future_x = pos_x + Displacement(speed_x, time);
+    const Fixed future_y = pos_y + Displacement(speed_y, time);
+
+    const Point cell_now{static_cast<Coord>(ToCell(pos_x)), static_cast<Coord>(ToCell(pos_y))};
+    const Point cell_future{static_cast<Coord>(ToCell(future_x)), static_cast<Coord>(ToCell(future_y))};
+    const bool horizontal = (state.direction == Direction::EAST) || (state.direction == Direction::WEST);
+    const road_graph::Axis axis = horizontal ? road_graph::Axis::HORIZONTAL : road_graph::Axis::VERTICAL;
+    const road_graph::Segment* segment = FindDogSegment(dog_road, cell_now, axis);
+
+    DogState new_dog_state = state;
+    if (CanMove(dog_road, segment, cell_now, cell_future, axis)) {
+        pos_x = future_x;
+        pos_y = future_y;
+    } else {
+        Fixed max_length = 0;
+        if (segment != nullptr) {
+            switch (state.direction) {
+            case Direction::EAST:
+                max_length = FromCell(segment->end) - pos_x;
+                break;
+            case Direction::WEST:
+                max_length = pos_x - FromCell(segment->start);
+                break;
+            case Direction::NORTH:
+                max_length = pos_y - FromCell(segment->start);
+                break;
+            case Direction::SOUTH:
+                max_length = FromCell(segment->end) - pos_y;
+                break;
             }
         }
-    }
-    if (vert_roads_.count(cur_pos.x)) {
-        // Нашли хотя бы одну вертикальную дорогу
-        auto bucket_idx = vert_roads_.bucket(cur_pos.x);
-        for (auto it = vert_roads_.begin(bucket_idx); it != vert_roads_.end(bucket_idx); ++it) {
-            if ((cur_pos.y >= normal_roads_[it->second].GetStart().y) &&
-                (cur_pos.y <= normal_roads_[it->second].GetEnd().y)) {
-                found_road_idxs.push_back(it->second);
+        const Fixed sign_x = (speed_x < 0) ? -1 : 1;
+        const Fixed sign_y = (speed_y < 0) ? -1 : 1;
+        if (max_length > 0) { /* Движемся вдоль дороги и не в крайней точке */
+            if (horizontal) {
+                pos_x += (max_length + fixed_point::HALF_ROAD_WIDE) * sign_x;
+            } else {
+                pos_y += (max_length + fixed_point::HALF_ROAD_WIDE) * sign_y;
+            }
+        } else { /* Движемся поперёк дороги или в крайней точке дороги */
+            if (speed_x != 0) {
+                pos_x = FromCell(ToCell(pos_x)) + fixed_point::HALF_ROAD_WIDE * sign_x;
+            }
+            if (speed_y != 0) {
+                pos_y = FromCell(ToCell(pos_y)) + fixed_point::HALF_ROAD_WIDE * sign_y;
             }
         }
+        new_dog_state.velocity.x = 0.;
+        new_dog_state.velocity.y = 0.;
     }
-    return found_road_idxs;
+    new_dog_state.position = {ToDouble(pos_x), ToDouble(pos_y)};
+    UpdateDogRoad(dog_road, {static_cast<Coord>(ToCell(pos_x)), static_cast<Coord>(ToCell(pos_y))});
+    return new_dog_state;
+}
+
+/* Можно ли из точки cell_now попасть в точку cell_future, двигаясь вдоль участка segment направления axis */
+bool Map::CanMove(const DogRoad& dog_road, const road_graph::Segment* segment,
+                  Point cell_now, Point cell_future, road_graph::Axis axis) const {
+    if ((cell_now.x == cell_future.x) && (cell_now.y == cell_future.y)) {
+        /* остаёмся в той же точке - достаточно стоять на любой дороге */
+        return (segment != nullptr) ||
+               (FindDogSegment(dog_road, cell_now, (axis == road_graph::Axis::HORIZONTAL) ? road_graph::Axis::VERTICAL
+                                                                                          : road_graph::Axis::HORIZONTAL) != nullptr);
+    }
+    return (segment != nullptr) && segment->Contains(cell_future.x, cell_future.y);
+}
+
+/* Участок направления axis в точке cell: берётся из подсказки, если она его описывает, иначе ищется в графе.
+ * На участке дороги без перекрёстков других дорог нет, поэтому и поперечного участка там нет */
+const road_graph::Segment* Map::FindDogSegment(const DogRoad& dog_road, Point cell, road_graph::Axis axis) const {
+    if (dog_road.segment < GetRoadGraph().GetSegments().size()) {
+        const road_graph::Segment& segment = GetRoadGraph().GetSegment(dog_road.segment);
+        if ((segment.axis == axis) && segment.Contains(cell.x, cell.y)) {
+            return &segment;
+        }
+        if ((segment.axis != axis) && !dog_road.junction && IsDogRoadAt(dog_road, cell)) {
+            return nullptr;
+        }
+    }
+    const size_t segment_idx = GetRoadGraph().FindSegment(axis, cell.x, cell.y);
+    if (segment_idx == road_graph::RoadGraph::NO_SEGMENT) {
+        return nullptr;
+    }
+    return &GetRoadGraph().GetSegment(segment_idx);
+}
+
+/* Описывает ли подсказка dog_road точку cell */
+bool Map::IsDogRoadAt(const DogRoad& dog_road, Point cell) const noexcept {
+    if (dog_road.road >= roads_.size()) {
+        return false;
+    }
+    const Road& road = roads_[dog_road.road];
+    if (road.IsHorizontal()) {
+        return (cell.y == road.GetStart().y) && (cell.x >= dog_road.free_from) && (cell.x <= dog_road.free_to);
+    }
+    return (cell.x == road.GetStart().x) && (cell.y >= dog_road.free_from) && (cell.y <= dog_road.free_to);
+}
+
+/* Дороги ищутся заново, только если собака ушла с участка, описанного подсказкой:
+ * пересекла перекрёсток или вышла за конец дороги */
+void Map::UpdateDogRoad(DogRoad& dog_road, Point cell) const {
+    if (IsDogRoadAt(dog_road, cell)) {
+        return;
+    }
+    dog_road = FindDogRoadInCell(cell);
+}
+
+DogRoad Map::FindDogRoadInCell(Point cell) const {
+    road_index::RoadIndex::Roads roads = road_index_.FindRoads(cell.x, cell.y);
+    if (roads.empty()) {
+        return {};
+    }
+    const size_t road_idx = roads.front();
+    const Road road = detail::NormalRoad(roads_[road_idx]);
+    const Coord along = road.IsHorizontal() ? cell.x : cell.y;
+    const size_t segment = GetRoadGraph().FindSegment(road.IsHorizontal() ? road_graph::Axis::HORIZONTAL
+                                                                       : road_graph::Axis::VERTICAL,
+                                                   cell.x, cell.y);
+    if (roads.size() > 1) {
+        return {road_idx, along, along, true, segment};
+    }
+    road_index::Span span;
+    if (road.IsHorizontal()) {
+        span = road_index_.FindFreeSpanOnRow(road.GetStart().y,
+                                             {road.GetStart().x, road.GetEnd().x, road_idx}, cell.x);
+    } else {
+        span = road_index_.FindFreeSpanOnColumn(road.GetStart().x,
+                                                {road.GetStart().y, road.GetEnd().y, road_idx}, cell.y);
+    }
+    return {road_idx, span.from, span.to, false, segment};
+}
+
+DogRoad Map::FindDogRoad(const Position& pos) const {
+    return FindDogRoadInCell(detail::RoundPoint(pos));
+}
+
+namespace {
+
+size_t MakeLootBucket(size_t segment, Coord chunk) noexcept {
+    return (segment << 32) | static_cast<size_t>(chunk);
+}
+
+} // namespace
+
+size_t Map::FindLootBucket(const Position& pos) const {
+    const Point cell = detail::RoundPoint(pos);
+    size_t segment = GetRoadGraph().FindSegment(road_graph::Axis::HORIZONTAL, cell.x, cell.y);
+    if (segment == road_graph::RoadGraph::NO_SEGMENT) {
+        segment = GetRoadGraph().FindSegment(road_graph::Axis::VERTICAL, cell.x, cell.y);
+        if (segment == road_graph::RoadGraph::NO_SEGMENT) {
+            return NO_LOOT_BUCKET;
+        }
+    }
+    const road_graph::Segment& road = GetRoadGraph().GetSegment(segment);
+    const Coord along = (road.axis == road_graph::Axis::HORIZONTAL) ? cell.x : cell.y;
+    return MakeLootBucket(segment, (along - road.start) / LOOT_BUCKET_LENGTH);
+}
+
+/* Позиция относится к точке дороги, отстоящей от неё меньше чем на 1 по каждой оси,
+ * поэтому прямоугольник вокруг отрезка расширяется ещё на 1 */
+void Map::FindLootBucketsNear(const Position& from, const Position& to, double distance,
+                              std::vector<size_t>& buckets) const {
+    const Coord x0 = static_cast<Coord>(std::floor(std::min(from.x, to.x) - distance)) - 1;
+    const Coord y0 = static_cast<Coord>(std::floor(std::min(from.y, to.y) - distance)) - 1;
+    const Coord x1 = static_cast<Coord>(std::ceil(std::max(from.x, to.x) + distance)) + 1;
+    const Coord y1 = static_cast<Coord>(std::ceil(std::max(from.y, to.y) + distance)) + 1;
+    GetRoadGraph().ForEachSegmentIn(x0, y0, x1, y1, [&](size_t segment) {
+        const road_graph::Segment& road = GetRoadGraph().GetSegment(segment);
+        const bool horizontal = (road.axis == road_graph::Axis::HORIZONTAL);
+        const Coord along0 = std::max(horizontal ? x0 : y0, road.start);
+        const Coord along1 = std::min(horizontal ? x1 : y1, road.end);
+        for (Coord chunk = (along0 - road.start) / LOOT_BUCKET_LENGTH;
+             chunk <= (along1 - road.start) / LOOT_BUCKET_LENGTH; ++chunk) {
+            buckets.push_back(MakeLootBucket(segment, chunk));
+        }
+    });
+}
+
+road_index::RoadIndex::Roads Map::GetRoadByPosition(const Position &pos) const {
+    return road_index_.FindRoads(detail::RoundPosition(pos.x), detail::RoundPosition(pos.y));
 }
 
 }  // namespace model
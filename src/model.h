@@ -11,11 +11,18 @@
 #pragma once
 #include <limits>
 #include <optional>
+#include <random>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "fixed_point.h"
 #include "loot_generator.h"
+#include "random_source.h"
+#include "road_graph.h"
+#include "road_index.h"
+#include "string_pool.h"
 #include "tagged.h"
 #include "game_session.h"
 
@@ -43,6 +50,11 @@ struct Offset {
     Dimension dx, dy;
 };
 
+namespace detail {
+    /* Округление позиции на дороге до координат (точки дороги, в которой лежит позиция) */
+    Coord RoundPosition(double pos);
+} // namespace detail
+
 class Road {
     struct HorizontalTag {
         explicit HorizontalTag() = default;
@@ -129,18 +141,22 @@ private:
     Offset offset_;
 };
 
+/* Строки типа вещи хранятся в общем пуле (string_pool.h): у разных карт они обычно совпадают */
 class LootType {
 public:
     explicit LootType(std::string_view name, std::string_view file, std::string_view type,
                   std::optional<int> rotation, std::optional<std::string_view> color,
                   double scale, size_t scores)
-                  : name_{name}
-                  , file_{file}
-                  , type_{type}
+                  : name_{util::InternString(name)}
+                  , file_{util::InternString(file)}
+                  , type_{util::InternString(type)}
                   , rotation_(rotation)
-                  , color_{color}
                   , scale_(scale)
-                  , scores_cost_(scores) {}
+                  , scores_cost_(scores) {
+        if (color) {
+            color_ = util::InternString(*color);
+        }
+    }
 
     std::string_view GetName() const noexcept {
         return name_;
@@ -165,11 +181,11 @@ public:
     }
 
 private:
-    std::string name_;
-    std::string file_;
-    std::string type_;
+    std::string_view name_;
+    std::string_view file_;
+    std::string_view type_;
     std::optional<int> rotation_;
-    std::optional<std::string> color_;
+    std::optional<std::string_view> color_;
     double scale_;
     size_t scores_cost_;
 };
@@ -182,7 +198,7 @@ public:
     using Offices = std::vector<Office>;
 
     Map(Id id, std::string name,
-            double speed = 1., size_t bag_capacity = 3) noexcept
+            double speed = 1., size_t bag_capacity = DEFAULT_BAG_CAPACITY) noexcept
         : id_(std::move(id))
         , name_(std::move(name))
         , speed_(speed)
@@ -208,25 +224,118 @@ public:
         return offices_;
     }
 
+    /* Офисы для поиска столкновений (collision_detector::FindGatherEvents): позиции и радиусы
+     * в порядке GetOffices(). Заполняются в AddOffice(), офисы после загрузки карты не меняются */
+    const std::vector<Position>& GetOfficePositions() const noexcept {
+        return office_positions_;
+    }
+    const std::vector<double>& GetOfficeWidths() const noexcept {
+        return office_widths_;
+    }
+
     double GetSpeed() const noexcept {
         return speed_;
     }
 
+    /* Дорога сразу попадает в индекс дорог, а граф дорог строится лениво: один раз при первом
+     * обращении к нему после добавления дорог (GetRoadGraph(), перемещение собак) или в Freeze() */
     void AddRoad(const Road& road);
+    void AddRoads(const Roads& roads);
 
     void AddBuilding(const Building& building) {
+        ThrowIfFrozen();
         buildings_.emplace_back(building);
     }
 
     void AddOffice(Office office);
 
+    /* Завершает загрузку карты (вызывается в конце json_loader::LoadGame()): массивы карты ужимаются
+     * до своего размера, вспомогательные данные загрузки освобождаются. После этого карта неизменяема -
+     * добавление объектов выбрасывает std::logic_error */
+    void Freeze();
+    bool IsFrozen() const noexcept {
+        return frozen_;
+    }
+
+    /* Память, занятая картой в куче и в самом объекте, в байтах (без общего пула строк) */
+    size_t GetMemoryUsage() const noexcept;
+
+    /* Дороги карты вместе с построенными индексом и графом дорог, для двоичного набора карт (map_bundle.h).
+     * Читаются только в карту без дорог - индекс и граф не пересобираются */
+    template <typename Archive>
+        requires(!Archive::IS_LOADING)
+    void SerializeRoads(Archive& ar) const {
+        ar.Array(roads_);
+        road_index_.SerializeBundle(ar);
+        GetRoadGraph().SerializeBundle(ar);
+    }
+    template <typename Archive>
+        requires Archive::IS_LOADING
+    void SerializeRoads(Archive& ar) {
+        ThrowIfFrozen();
+        if (!roads_.empty()) {
+            throw std::logic_error("Roads can be loaded only into a map without roads");
+        }
+        ar.Array(roads_);
+        road_index_.SerializeBundle(ar);
+        road_graph_.SerializeBundle(ar);
+        road_graph_dirty_ = false;
+    }
+
+    /* Случайная точка дороги: все точки всех дорог карты равновероятны (выбор участка по его длине).
+     * Как и все изменения модели, вызывается последовательно (в api strand) - генератор карты общий */
     Position GetRandomPositionOnRoads() const;
     Position GetTestPositionOnRoads() const noexcept;
 
+    /* Режим фиксированной точки: перемещение считается в целых долях 1/1024 (fixed_point.h),
+     * положения собак после перемещения кратны 1/1024 */
+    void SetFixedPoint(bool fixed_point) noexcept {
+        fixed_point_ = fixed_point;
+    }
+    bool IsFixedPoint() const noexcept {
+        return fixed_point_;
+    }
+
     DogState MoveDog(const std::shared_ptr<Dog> dog, double time) const;
+    /* Перемещение всех собак сессии за один проход, результат совпадает с MoveDog() для каждой собаки */
+    void MoveDogs(DogsMovement& dogs, double time) const;
+
+    /* Дорога собаки в позиции pos (подсказка для MoveDog) */
+    DogRoad FindDogRoad(const Position& pos) const;
+
+    /* Индексы дорог (в массиве GetRoads()), на которых находится позиция pos */
+    road_index::RoadIndex::Roads GetRoadByPosition(const Position& pos) const;
+
+    /* Граф дорог собирается здесь при первом обращении после добавления дорог (AddRoad, AddRoads),
+     * у замороженной карты он уже собран в Freeze() и только читается */
+    const road_graph::RoadGraph& GetRoadGraph() const;
+
+    /* Корзины предметов: участок графа дорог делится на куски длиной LOOT_BUCKET_LENGTH,
+     * корзина - номер участка в старших 32 битах и номер куска в младших */
+    static constexpr Coord LOOT_BUCKET_LENGTH = 8;
+    static constexpr size_t NO_LOOT_BUCKET = std::numeric_limits<size_t>::max();
+
+    /* Корзина точки дороги позиции pos (горизонтальный участок, иначе вертикальный);
+     * NO_LOOT_BUCKET - позиция не на дороге */
+    size_t FindLootBucket(const Position& pos) const;
+    /* Добавляет в buckets корзины, к которым может относиться (FindLootBucket) позиция,
+     * отстоящая от отрезка [from, to] не дальше чем на distance. Повторы не убираются */
+    void FindLootBucketsNear(const Position& from, const Position& to, double distance,
+                             std::vector<size_t>& buckets) const;
 
     void AddLootType(LootType loot_type);
 
+    /* Случайный тип потерянной вещи (индекс в GetLootTypes()) */
+    size_t GetRandomLootType() const;
+
+    /* Генератор случайных точек и типов вещей карты, Game выдаёт его из общего источника случайности */
+    void SetRandomEngine(RandomSource::Engine engine) noexcept {
+        random_engine_ = std::move(engine);
+    }
+    const RandomSource::Engine& GetRandomEngine() const noexcept {
+        return random_engine_;
+    }
+
     size_t GetLootTypesCount() const noexcept {
         return loot_types_.size();
     }
@@ -248,30 +357,48 @@ public:
 
 private:
     using OfficeIdToIndex = std::unordered_map<Office::Id, size_t, util::TaggedHasher<Office::Id>>;
-    std::vector<size_t> GetRoadByPosition(const Position& pos) const; // возвращает массив индексов дорог в массиве
+    void ThrowIfFrozen() const;
+    DogState ResolveMove(const DogState& state, const Position& pos_future, DogRoad& dog_road) const;
+    DogState ResolveMoveFixed(const DogState& state, double time, DogRoad& dog_road) const;
+    bool CanMove(const DogRoad& dog_road, const road_graph::Segment* segment,
+                 Point cell_now, Point cell_future, road_graph::Axis axis) const;
+    void StoreRoad(const Road& road);
+    const road_graph::Segment* FindDogSegment(const DogRoad& dog_road, Point cell, road_graph::Axis axis) const;
+    bool IsDogRoadAt(const DogRoad& dog_road, Point cell) const noexcept;
+    void UpdateDogRoad(DogRoad& dog_road, Point cell) const;
+    DogRoad FindDogRoadInCell(Point cell) const;
 
     Id id_;
     std::string name_;
     double speed_ = 1.;
-    size_t bag_capacity_ = 3;
+    size_t bag_capacity_ = DEFAULT_BAG_CAPACITY;
+    bool fixed_point_ = false;
+    bool frozen_ = false;
 
+    /* Дороги в том виде, в котором заданы в конфигурации (для JSON карты). Для перемещения нужны координаты
+     * дорог по возрастанию - они берутся из road_index_ или вычисляются из тех же дорог (detail::NormalRoad) */
     Roads roads_;
     Buildings buildings_;
 
-    OfficeIdToIndex warehouse_id_to_index_;
+    OfficeIdToIndex warehouse_id_to_index_; // только для проверки повторов при загрузке, Freeze() освобождает
     Offices offices_;
+    std::vector<Position> office_positions_;
+    std::vector<double> office_widths_;
     static constexpr double HALF_ROAD_WIDE = 0.4; // она есть также в detail (model.cpp)
-    Roads normal_roads_; /* массив дорог в котором координаты начала дороги всегда меньше координат конца */
-    /* все горизонтальные дороги ключ - y-координата, значение - индекс в normal_roads_ */
-    std::unordered_multimap<Coord, size_t> hor_roads_;
-    /* все вертикальные дороги ключ - x-координата, значение - индекс в normal_roads_ */
-    std::unordered_multimap<Coord, size_t> vert_roads_;
+    /* строки горизонтальных и столбцы вертикальных дорог, значения - индексы в roads_ */
+    road_index::RoadIndex road_index_;
+    mutable road_graph::RoadGraph road_graph_; // собирается из road_index_ в GetRoadGraph()
+    mutable bool road_graph_dirty_ = false;    // дороги добавлены после сборки графа
 
     std::vector<LootType> loot_types_; // типы потерянных вещей на карте
+
+    /* Генератор создаётся один раз на карту, а не на каждый вызов GetRandomPositionOnRoads() */
+    mutable RandomSource::Engine random_engine_{std::random_device{}()};
 };
 
 class Game {
 public:
+    /* Ограничение числа собак в сессии по умолчанию: без ограничения, у каждой карты одна сессия */
     static constexpr size_t MAX_DOGS_ON_MAP = std::numeric_limits<size_t>::max();
 
     using Maps = std::vector<Map>;
@@ -294,8 +421,39 @@ public:
         return nullptr;
     }
 
+    /* Сессия карты для нового игрока: наименее заполненная из сессий карты, в которых меньше
+     * GetMaxDogsPerSession() собак (при равенстве - с меньшим номером экземпляра).
+     * Спящая сессия пуста, поэтому просыпается раньше, чем открывается новая.
+     * Если все сессии карты заполнены, открывается новая со следующим номером экземпляра */
     std::shared_ptr<GameSession> PlacePlayerOnMap(const Map::Id& map_id);
 
+    size_t GetMaxDogsPerSession() const noexcept {
+        return max_dogs_per_session_;
+    }
+    void SetMaxDogsPerSession(size_t max_dogs) {
+        if (max_dogs == 0) {
+            throw std::invalid_argument("Max dogs per session must be positive");
+        }
+        max_dogs_per_session_ = max_dogs;
+    }
+
+    /* Горячая перезагрузка: карты maps, построенные заранее вне потока тика, заменяют текущие обменом массивов.
+     * Вызывается в api_strand между тиками, поэтому запросы и тик не видят карты во время замены.
+     * Сессии переходят на новые карты с теми же id (GameSession::SetMap) и режим фиксированной точки игры.
+     * Карта с прежним id продолжает последовательность генератора прежней версии, карта с новым id получает
+     * ещё не выданный поток источника, поэтому при --seed перезагрузка не повторяет уже выданные точки появления.
+     * Удалить карту, на которой есть игроки, нельзя: тогда выбрасывается std::invalid_argument и игра
+     * не меняется. Возвращает прежние карты, чтобы их освободили вне потока тика */
+    Maps ReplaceMaps(Maps maps);
+    /* Перезагрузка меняет только карты. Если настройки игры loaded (генератор предметов, время до ухода
+     * неактивной собаки, ограничение собак в сессии) отличаются от текущих, выбрасывается std::invalid_argument:
+     * такие изменения применяются только перезапуском сервера */
+    void CheckReloadSettings(const Game& loaded) const;
+    /* Забирает карты загруженной игры (для ReplaceMaps), игра остаётся без карт */
+    Maps ReleaseMaps() noexcept;
+
+    /* Настройки генератора предметов: каждая новая сессия получает свою копию (PlacePlayerOnMap),
+     * сам генератор игры не используется в тике */
     void SetLootGenerator(loot_gen::LootGenerator::TimeInterval base_interval, double probability) {
         loot_generator_ = loot_gen::LootGenerator(base_interval, probability);
     }
@@ -303,17 +461,30 @@ public:
     loot_gen::LootGenerator& GetLootGenerator() {
         return loot_generator_;
     }
+    const loot_gen::LootGenerator& GetLootGenerator() const {
+        return loot_generator_;
+    }
 
+    /* Восстановленные сессии без собак сразу засыпают */
     void RestoreSessions(std::vector<Sessions> sessions_vec) {
         for (Sessions& session : sessions_vec) {
             Map::Id map_id_ = session->GetMap()->GetId();
             if (map_id_to_index_.count(map_id_) == 0) {
                 throw std::domain_error("Restore Session failed, no such map_id");
             }
-            sessions_[map_id_to_index_.at(map_id_)] = session;
         }
+        for (Sessions& session : sessions_vec) {
+            if (session->IsHibernated()) {
+                session->ReleaseLostObjects();
+            }
+        }
+        sessions_ = std::move(sessions_vec);
     }
 
+    /* Число сессий, которые обрабатываются в тике, и спящих сессий без собак (GameSession::IsHibernated) */
+    size_t CountActiveSessions() const noexcept;
+    size_t CountHibernatedSessions() const noexcept;
+
     double GetDogRetirementTime() const noexcept {
         return dog_retirement_time_;
     }
@@ -322,6 +493,19 @@ public:
         dog_retirement_time_ = inactive_time;
     }
 
+    /* Все генераторы игры получаются из этого источника: каждая карта - свой поток по порядку добавления */
+    const RandomSource& GetRandomSource() const noexcept {
+        return random_source_;
+    }
+    /* Задаёт зерно источника и пересоздаёт генераторы уже добавленных карт */
+    void SetRandomSeed(RandomSource::Seed seed);
+
+    /* Режим фиксированной точки для всех карт игры (см. Map::SetFixedPoint) */
+    void SetFixedPoint(bool fixed_point) noexcept;
+    bool IsFixedPoint() const noexcept {
+        return fixed_point_;
+    }
+
 private:
     using MapIdHasher = util::TaggedHasher<Map::Id>;
     using MapIdToIndex = std::unordered_map<Map::Id, size_t, MapIdHasher>;
@@ -329,10 +513,15 @@ private:
     Maps maps_;
     MapIdToIndex map_id_to_index_;
 
-    std::vector<Sessions> sessions_; /* Индексы соответствуют индексам карт в maps_ */
+    std::vector<Sessions> sessions_; /* Сессии всех карт в порядке открытия, у карты может быть несколько сессий */
+    size_t max_dogs_per_session_ = MAX_DOGS_ON_MAP;
 
     loot_gen::LootGenerator loot_generator_{1s, 0.};
     double dog_retirement_time_ = 60.; // в секундах
+
+    RandomSource random_source_;
+    std::uint32_t next_map_stream_ = 0; // номер потока RandomSource::Stream::MAP для следующей новой карты
+    bool fixed_point_ = false;
 };
 
 }  // namespace model
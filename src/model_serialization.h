@@ -2,10 +2,14 @@
 #include <boost/serialization/list.hpp>
 #include <boost/serialization/unordered_map.hpp>
 #include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
 #include <algorithm>
 #include <list>
 #include <memory>
+#include <optional>
+#include <stdexcept>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "game_session.h"
@@ -129,16 +133,31 @@ public:
                 : id_(dog.GetDogId())
                 , name_(dog.GetDogName())
                 , state_(dog.GetDogState())
-                , scores_(dog.GetScores()) {
+                , scores_(dog.GetScores())
+                , inactive_time_(dog.GetInactiveTime())
+                , total_time_(dog.GetTotalTime()) {
         for (const auto&  obj : dog.GetPickedObjects()) {
             objects_repr_.emplace_back(PickedObjectRepr(obj));
         }
     }
 
+    /* Собака с индексом idx из массивов сессии */
+    DogRepr(const model::SessionDogs& dogs, size_t idx)
+                : id_(dogs.GetIds()[idx])
+                , name_(dogs.GetName(idx))
+                , state_(dogs.GetState(idx))
+                , scores_(dogs.GetScores(idx))
+                , inactive_time_(dogs.GetInactiveTime(idx))
+                , total_time_(dogs.GetTotalTime(idx)) {
+        for (const auto&  obj : dogs.GetBag(idx)) {
+            objects_repr_.emplace_back(PickedObjectRepr(obj));
+        }
+    }
+
     [[nodiscard]] model::Dog Restore() const {
-        std::vector<model::PickedObject> objects;
+        model::Bag objects;
         for (auto& obj_repr : objects_repr_) {
-            objects.emplace_back(obj_repr.Restore());
+            objects.PushBack(obj_repr.Restore());
         }
         model::Dog dog{id_,
                        std::move(name_),
@@ -150,6 +169,10 @@ public:
         return dog;
     }
 
+    size_t GetId() const noexcept {
+        return id_;
+    }
+
     template <typename Archive>
     void serialize(Archive& ar, [[maybe_unused]] const unsigned version) {
         ar& id_;
@@ -172,40 +195,67 @@ private:
 };
 
 /* В игроках сохранены:
- * - собака
- * - идентификатор карты сессии (одна сессия на одну карту) */
+ * - id собаки (сама собака сохраняется в своей сессии, GameSessionRepr)
+ * - идентификатор карты сессии и номер экземпляра сессии среди сессий карты
+ * В файлах версии 0 в игроке сохранялась сама собака, до версии 2 у карты была одна сессия (номер экземпляра 0) */
 class PlayerRepr {
 public:
     PlayerRepr() = default;
 
     explicit PlayerRepr(const players::Player& player)
-                : dog_repr_(DogRepr(*(player.GetDog())))
-                , map_id_string_(*(player.GetGameSession()->GetMap()->GetId())) {}
+                : dog_id_(player.GetId())
+                , map_id_string_(*(player.GetGameSession()->GetMap()->GetId()))
+                , instance_id_(player.GetGameSession()->GetInstanceId()) {}
 
     [[nodiscard]] players::Player Restore(const std::vector<model::Game::Sessions>& sessions) const {
         auto session_it = std::find_if(sessions.begin(), sessions.end(),
                             [this](const model::Game::Sessions& s) {
                                 if (s != nullptr) {
-                                    return (*(s->GetMap()->GetId()) == this->map_id_string_);
+                                    return (*(s->GetMap()->GetId()) == this->map_id_string_) &&
+                                           (s->GetInstanceId() == this->instance_id_);
                                 }
                                 return false;
                             });
         if (session_it == sessions.end()) {
             throw std::domain_error("Restore Player failed, no such session");
         }
-        players::Player player{dog_repr_.Restore(), *session_it};
-        return player;
+        const std::optional<model::GameSession::DogHandle> handle = (*session_it)->FindDog(dog_id_);
+        if (!handle) {
+            throw std::domain_error("Restore Player failed, no such dog in session");
+        }
+        return players::Player{dog_id_, *session_it, *handle};
+    }
+
+    /* Собака игрока из файла версии 0, её переносят в сессию (GameSessionRepr::RestoreLegacyDogs) */
+    std::optional<DogRepr> TakeLegacyDog() noexcept {
+        return std::exchange(legacy_dog_, std::nullopt);
     }
 
     template <typename Archive>
-    void serialize(Archive &ar, [[maybe_unused]] const unsigned version) {
-        ar& dog_repr_;
-        ar& map_id_string_;
+    void serialize(Archive &ar, const unsigned version) {
+        if (version == 0) {
+            DogRepr dog_repr;
+            ar& dog_repr;
+            ar& map_id_string_;
+            dog_id_ = dog_repr.GetId();
+            instance_id_ = 0;
+            legacy_dog_ = std::move(dog_repr);
+        } else {
+            ar& dog_id_;
+            ar& map_id_string_;
+            if (version >= 2) {
+                ar& instance_id_;
+            } else {
+                instance_id_ = 0;
+            }
+        }
     }
 
 private:
-    DogRepr dog_repr_;
+    size_t dog_id_;
     std::string map_id_string_;
+    size_t instance_id_;
+    std::optional<DogRepr> legacy_dog_;
 };
 
 class PlayersRepr {
@@ -227,6 +277,18 @@ public:
         return players::Players(std::move(game_players), next_dog_id_);
     }
 
+    /* Собаки игроков из файла версии 0 по id собаки */
+    std::unordered_map<size_t, DogRepr> TakeLegacyDogs() {
+        std::unordered_map<size_t, DogRepr> dogs;
+        for (PlayerRepr& player_repr : players_) {
+            if (std::optional<DogRepr> dog = player_repr.TakeLegacyDog()) {
+                const size_t dog_id = dog->GetId();
+                dogs.emplace(dog_id, std::move(*dog));
+            }
+        }
+        return dogs;
+    }
+
     template <typename Archive>
     void serialize(Archive &ar, [[maybe_unused]] const unsigned version) {
         ar& players_;
@@ -273,41 +335,83 @@ class GameSessionRepr {
 public:
     GameSessionRepr() = default;
 
+    /* Собаки сохраняются в порядке массивов сессии, поэтому восстановленная сессия перебирает их в том же порядке */
     explicit GameSessionRepr(const model::GameSession& session)
                 : map_id_str_(*(session.GetMap()->GetId()))
-                , last_object_id_(session.GetLastObjectId())
-                , dog_ids_(session.GetDogIds()) {
-        for (const auto& obj_ptr : session.GetLostObjects()) {
-            lost_objects_repr_.emplace_back(LostObjectRepr(*obj_ptr));
+                , instance_id_(session.GetInstanceId())
+                , last_object_id_(session.GetLastObjectId()) {
+        const model::SessionDogs& dogs = session.GetDogs();
+        dogs_repr_.reserve(dogs.Size());
+        for (size_t idx = 0; idx != dogs.Size(); ++idx) {
+            dogs_repr_.emplace_back(dogs, idx);
+        }
+        for (const model::LostObject& object : session.GetLostObjects()) {
+            lost_objects_repr_.emplace_back(LostObjectRepr(object));
         }
     }
 
     [[nodiscard]] model::GameSession Restore(const model::Game& game) const {
-        model::GameSession session(const_cast<model::Map*>(game.FindMap(model::Map::Id{map_id_str_})));
-        for (const size_t dog_id : dog_ids_) {
-            session.AddDog(dog_id);
+        const model::Map* map = game.FindMap(model::Map::Id{map_id_str_});
+        if (map == nullptr) {
+            throw std::domain_error("Restore Session failed, no such map_id");
         }
-        model::GameSession::LostObjects lost_objects;
+        model::GameSession session(const_cast<model::Map*>(map), instance_id_, game.GetLootGenerator());
+        /* Дорога собаки не сохраняется: она однозначно определяется позицией на карте (GameSession::AddDog) */
+        for (const DogRepr& dog_repr : dogs_repr_) {
+            session.AddDog(dog_repr.Restore());
+        }
+        std::vector<model::LostObject> lost_objects;
+        lost_objects.reserve(lost_objects_repr_.size());
         for (auto& obj_repr : lost_objects_repr_) {
-            lost_objects.emplace_back(std::make_shared<model::LostObject>(obj_repr.Restore()));
+            lost_objects.emplace_back(obj_repr.Restore());
         }
         session.RestoreLostObjects(std::move(lost_objects), last_object_id_);
         return session;
     }
 
+    /* В файле версии 0 сессия хранила только id своих собак, а сами собаки сохранялись в игроках:
+     * собаки забираются из dogs (PlayersRepr::TakeLegacyDogs) в порядке id сессии */
+    void RestoreLegacyDogs(std::unordered_map<size_t, DogRepr>& dogs) {
+        for (const size_t dog_id : legacy_dog_ids_) {
+            auto it = dogs.find(dog_id);
+            if (it == dogs.end()) {
+                throw std::domain_error("Restore Session failed, no player with such dog_id");
+            }
+            dogs_repr_.push_back(std::move(it->second));
+            dogs.erase(it);
+        }
+        legacy_dog_ids_.clear();
+    }
+
     template <typename Archive>
-    void serialize(Archive &ar, [[maybe_unused]] const unsigned version) {
+    void serialize(Archive &ar, const unsigned version) {
         ar& map_id_str_;
+        if (version >= 2) {
+            ar& instance_id_;
+        } else {
+            instance_id_ = 0;
+        }
         ar& last_object_id_;
-        ar& dog_ids_;
+        if (version == 0) {
+            ar& legacy_dog_ids_;
+        } else {
+            ar& dogs_repr_;
+        }
         ar& lost_objects_repr_;
     }
 
 private:
     std::string map_id_str_;
+    size_t instance_id_;
     size_t last_object_id_;
-    model::GameSession::DogIds dog_ids_;
+    std::vector<DogRepr> dogs_repr_;
     std::vector<LostObjectRepr> lost_objects_repr_;
+    std::list<size_t> legacy_dog_ids_;
 };
 
 } // namespace serialization
+
+/* Версия 1: собаки сохраняются в сессиях, игрок хранит id собаки.
+ * Версия 2: у карты может быть несколько сессий, сессия и игрок хранят номер экземпляра сессии */
+BOOST_CLASS_VERSION(::serialization::PlayerRepr, 2)
+BOOST_CLASS_VERSION(::serialization::GameSessionRepr, 2)
@@ -21,6 +21,46 @@ namespace detail {
 
 } // namespace detail
 
+namespace {
+    /* Подбор предметов собаками: собаки с полным рюкзаком не проверяются, заполнившая рюкзак собака
+     * перестаёт получать события. Собиратель с индексом idx - собака сессии с тем же индексом */
+    class PickUpHandler : public collision_detector::GatherEventHandler {
+    public:
+        PickUpHandler(const model::GameSession::LostObjects& objects,
+                      const std::vector<model::GameSession::LostObjectKey>& items,
+                      model::SessionDogs& dogs, size_t bag_capacity)
+            : objects_(objects)
+            , items_(items)
+            , dogs_(dogs)
+            , bag_capacity_(bag_capacity) {}
+
+        bool IsGathererActive(size_t gatherer_idx) const override {
+            return dogs_.GetBag(gatherer_idx).size() < bag_capacity_;
+        }
+        collision_detector::GatherDecision OnEvent(const collision_detector::GatheringEvent& event) override {
+            const model::LostObject& item = objects_[items_[event.item_id]];
+            const size_t dog_idx = event.gatherer_id;
+            if (!dogs_.AddPickedObject(dog_idx, model::PickedObject(item.GetId(), item.GetType()), bag_capacity_)) {
+                return collision_detector::GatherDecision::SKIP;
+            }
+            picked_.push_back(items_[event.item_id]);
+            return (dogs_.GetBag(dog_idx).size() < bag_capacity_) ? collision_detector::GatherDecision::TAKE
+                                                                  : collision_detector::GatherDecision::TAKE_AND_STOP;
+        }
+
+        const std::vector<model::GameSession::LostObjectKey>& GetPicked() const noexcept {
+            return picked_;
+        }
+
+    private:
+        const model::GameSession::LostObjects& objects_;
+        const std::vector<model::GameSession::LostObjectKey>& items_;
+        model::SessionDogs& dogs_;
+        size_t bag_capacity_;
+        std::vector<model::GameSession::LostObjectKey> picked_;
+    };
+} // namespace
+
     /* ----------------------------------- PlayerTokens ----------------------------------- */
 
     std::shared_ptr<Token> PlayerTokens::AddPlayer(std::shared_ptr<Player> player) {
@@ -59,13 +99,13 @@ namespace detail {
         : next_dog_id_(next_dog_id) {
         for (auto player : game_players) {
             auto it = players_.emplace(std::cend(players_), player);
-            map_id_to_it_.emplace((*it)->GetDog()->GetDogId(), it);
+            map_id_to_it_.emplace((*it)->GetId(), it);
         }
     }
 
     /* Создание и добавление пользователя:
-     * 1) создаём и добавляем игрока с собакой в перечень игроков
-     * 2) в выбранной игровой сессии добавляем собаку нового игрока */
+     * 1) создаём игрока, его собака добавляется в выбранную игровую сессию
+     * 2) добавляем игрока в перечень игроков */
     std::shared_ptr<Player> Players::Add(std::string player_name,
                                          std::shared_ptr<model::GameSession> game_session,
                                          bool randomize_spawn_point) {
@@ -79,8 +119,7 @@ namespace detail {
                                                                                             player_name,
                                                                                             position),
                                                                                 game_session));
-        game_session->AddDog((*it)->GetDog()->GetDogId());
-        map_id_to_it_.emplace((*it)->GetDog()->GetDogId(), it);
+        map_id_to_it_.emplace((*it)->GetId(), it);
         return *it;
     }
 
@@ -104,7 +143,7 @@ namespace detail {
 
     /* Добавляем нового пользователя в игру
      * 1) находим карту
-     * 2) получаем игровую сессию
+     * 2) получаем наименее заполненную игровую сессию карты (или новую)
      * 3) добавляем пользователя
      * 4) получаем токен пользователя */
     JoinGameResult Application::JoinPlayerToGame(model::Map::Id map_id, std::string_view player_name) {
@@ -119,7 +158,8 @@ namespace detail {
         }
 
         auto player = players_.Add(std::string(player_name), game_session, IsRandomSpawnPoint());
-        return JoinGameResult(player_tokens_.AddPlayer(player), player->GetDog()->GetDogId(), JoinGameErrorCode::NONE);
+        return JoinGameResult(player_tokens_.AddPlayer(player), player->GetId(), JoinGameErrorCode::NONE,
+                              game_session->GetInstanceId());
     }
 
     std::vector<std::shared_ptr<Player>> Application::GetPlayersInSession(const std::shared_ptr<Player> player) const {
@@ -137,41 +177,41 @@ namespace detail {
 
     void Application::SetDogAction(std::shared_ptr<Player> player, ActionMove action_move) {
         auto dog_speed = player->GetGameSession()->GetMap()->GetSpeed();
-        auto dog = player->GetDog();
+        model::DogRef dog = player->GetDog();
         switch (action_move) {
         case ActionMove::LEFT : {
-            dog->SetVelocity({-dog_speed, 0.});
-            dog->SetDirection(model::Direction::WEST);
+            dog.SetVelocity({-dog_speed, 0.});
+            dog.SetDirection(model::Direction::WEST);
             break;
         }
         case ActionMove::RIGHT : {
-            dog->SetVelocity({dog_speed, 0.});
-            dog->SetDirection(model::Direction::EAST);
+            dog.SetVelocity({dog_speed, 0.});
+            dog.SetDirection(model::Direction::EAST);
             break;
         }
         case ActionMove::UP : {
-            dog->SetVelocity({0., -dog_speed});
-            dog->SetDirection(model::Direction::NORTH);
+            dog.SetVelocity({0., -dog_speed});
+            dog.SetDirection(model::Direction::NORTH);
             break;
         }
         case ActionMove::DOWN : {
-            dog->SetVelocity({0., dog_speed});
-            dog->SetDirection(model::Direction::SOUTH);
+            dog.SetVelocity({0., dog_speed});
+            dog.SetDirection(model::Direction::SOUTH);
             break;
         }
         default: {
-            dog->SetVelocity({0., 0.});
+            dog.SetVelocity({0., 0.});
             break;
         }
         }
     }
 
-    /* Пересчёт событий на карте:
-     * 1) двигаем собак по картам
+    /* Пересчёт событий на карте (для каждой игровой сессии, спящие сессии без собак пропускаются):
+     * 1) двигаем всех собак сессии за один проход (Map::MoveDogs) прямо в массивах сессии
      * 1.1) учитываем общее время в игре
      * 1.2) учитываем время неактивности игрока
      * 1.3) помечаем игрока на удаление при неактивности
-     * 2) размещаем потерянные объекты в сессиях
+     * 2) размещаем потерянные объекты в сессии
      * 3) отдаём находки в офис
      * 4) подбираем предметы
      * 5) удаляем неактивных игроков */
@@ -180,116 +220,124 @@ namespace detail {
         loot_gen::LootGenerator::TimeInterval duration = std::chrono::duration_cast<std::chrono::milliseconds>(
                                                 std::chrono::duration<double, std::milli>{time_period * 1s});
 
-        std::unordered_map<size_t, collision_detector::Gatherer> all_gatherers;
         std::vector<std::shared_ptr<Player>> delete_this;
-        // перебор всех игроков
-        for (auto player : players_.GetPlayers()) {
-            model::DogState state = player->GetGameSession()->GetMap()->MoveDog(player->GetDog(), time_period);
-
-            all_gatherers[player->GetDog()->GetDogId()] = collision_detector::Gatherer{
-                                        player->GetDog()->GetDogState().position,
-                                        state.position,
-                                        model::LostObject::GATHERER_HALF_WIDTH};
-
-            player->GetDog()->IncTotalTime(time_period);
-            if (state == player->GetDog()->GetDogState()) {
-                player->GetDog()->IncInactiveTime(time_period);
-            } else {
-                player->GetDog()->ResetInactiveTime();
-            }
-            player->GetDog()->SetState(state);
-            if (player->GetDog()->GetInactiveTime() >= game_.GetDogRetirementTime()) {
-                delete_this.push_back(player);
-            }
-        }
         // перебор всех сессий
         for (auto& session : game_.GetSessions()) {
-            if(session != nullptr) {
-                // размещаем потерянные объекты в сессии
-                session->AddLostObjectsOnSession(game_.GetLootGenerator(), duration);
-
-                std::vector<collision_detector::Gatherer> gatherers;
-                std::unordered_map<size_t, std::shared_ptr<model::Dog>> idx_to_dog;
-                for (const auto& dog_id : session->GetDogIds()) {
-                    gatherers.emplace_back(all_gatherers.at(dog_id));
-                    idx_to_dog[gatherers.size() - 1] = GetDogById(dog_id);
+            if (session->IsHibernated()) {
+                continue;
+            }
+            model::SessionDogs& dogs = session->GetDogs();
+            const size_t count = dogs.Size();
+            std::vector<model::DogState> before;
+            before.reserve(count);
+            for (size_t idx = 0; idx != count; ++idx) {
+                before.push_back(dogs.GetState(idx));
+            }
+            session->GetMap()->MoveDogs(dogs.GetMovement(), time_period);
+
+            std::vector<collision_detector::Gatherer> gatherers;
+            gatherers.reserve(count);
+            for (size_t idx = 0; idx != count; ++idx) {
+                const model::DogState state = dogs.GetState(idx);
+                gatherers.emplace_back(collision_detector::Gatherer{before[idx].position,
+                                                                    state.position,
+                                                                    model::LostObject::GATHERER_HALF_WIDTH});
+                dogs.AddTime(idx, time_period, !(state == before[idx]));
+                if (dogs.GetInactiveTime(idx) >= game_.GetDogRetirementTime()) {
+                    delete_this.push_back(players_.FindPlayerByDogId(dogs.GetIds()[idx]));
                 }
-                BringItemsToOffices(session, gatherers, idx_to_dog);
-                PickUpItems(session, gatherers, idx_to_dog);
             }
+            // размещаем потерянные объекты в сессии
+            session->AddLostObjectsOnSession(duration);
+
+            BringItemsToOffices(session, gatherers);
+            PickUpItems(session, gatherers);
         }
         // Удаляем неактивных игроков
         for (auto& player : delete_this) {
+            const model::DogRef dog = player->GetDog();
             Champion player_result{player->GetName(),
-                                   player->GetDog()->GetScores(),
-                                   player->GetDog()->GetTotalTime()};
+                                   dog.GetScores(),
+                                   dog.GetTotalTime()};
             app_repo_.Save(player_result);
             DeletePlayer(player);
         }
     }
 
+    model::Game::Maps Application::ReloadMaps(model::Game::Maps maps) {
+        model::Game::Maps old_maps = game_.ReplaceMaps(std::move(maps));
+        for (const auto& session : game_.GetSessions()) {
+            const model::Map* map = session->GetMap();
+            model::SessionDogs& dogs = session->GetDogs();
+            for (size_t idx = 0; idx != dogs.Size(); ++idx) {
+                model::DogState state = dogs.GetState(idx);
+                if (map->GetRoadByPosition(state.position).empty()) {
+                    state.position = IsRandomSpawnPoint() ? map->GetRandomPositionOnRoads()
+                                                          : map->GetTestPositionOnRoads();
+                    state.velocity = {0., 0.};
+                    dogs.SetState(idx, state);
+                }
+                dogs.SetRoad(idx, map->FindDogRoad(state.position));
+                dogs.RemoveUnknownObjects(idx, map->GetLootTypesCount());
+            }
+        }
+        return old_maps;
+    }
+
     /* подбираем предметы:
-     * 1) формируем вектор items (gatherers сформирован выше) и передаём их провайдеру
-     * 2) получаем вектор событий подбора вещей собаками
-     * 3) для каждого события:
-     *      - подбираем собаками ещё не подобранные вещи, не забывая пометить подобранные вещи
-     * 4) удаляем подобранные вещи из списка потерянных */
+     * 1) формируем массивы позиций и радиусов предметов рядом с перемещениями собак (gatherers сформирован выше)
+     * 2) получаем события подбора вещей собаками в хронологическом порядке (ProcessGatherEvents):
+     *      - подбираем собаками ещё не подобранные вещи, события собак с полным рюкзаком не формируются
+     * 3) удаляем подобранные вещи из списка потерянных */
     void Application::PickUpItems(std::shared_ptr<model::GameSession> session,
-                                  const std::vector<collision_detector::Gatherer>& gatherers,
-                                  const std::unordered_map<size_t, std::shared_ptr<model::Dog>>& idx_to_dog) {
-        std::vector<std::shared_ptr<model::LostObject>> items(session->GetLostObjects().begin(),
-                                                              session->GetLostObjects().end());
-        ItemGatherer ig(items.size(), items, gatherers.size(), gatherers);
-        std::vector<bool> item_picked(session->CountLostObjects(), false);
-
-        for (const auto &event : collision_detector::FindGatherEvents(ig)) {
-            if (!item_picked[event.item_id]) {
-                item_picked[event.item_id] = idx_to_dog.at(event.gatherer_id)->AddPickedObject(
-                                                        model::PickedObject(items[event.item_id]->GetId(),
-                                                                            items[event.item_id]->GetType()),
-                                                        session->GetMap()->GetBagCapacity());
-            }
+                                  const std::vector<collision_detector::Gatherer>& gatherers) {
+        const std::vector<model::GameSession::LostObjectKey> nearby = session->FindLostObjectsNear(gatherers);
+        std::vector<model::Position> positions;
+        std::vector<double> widths;
+        positions.reserve(nearby.size());
+        widths.reserve(nearby.size());
+        const model::GameSession::LostObjects& objects = session->GetLostObjects();
+        for (const auto& key : nearby) {
+            positions.push_back(objects[key].GetPosition());
+            widths.push_back(objects[key].GetWidth());
         }
-        session->RemoveObjectsFromLost(item_picked); // удаляем только подобранные вещи
+        PickUpHandler handler(objects, nearby, session->GetDogs(), session->GetMap()->GetBagCapacity());
+        collision_detector::ProcessGatherEvents(positions, widths, gatherers, handler, session->GetMap()->IsFixedPoint());
+        // удаляем только подобранные вещи
+        session->RemoveLostObjects(handler.GetPicked());
     }
 
     /* отдаём находки в офис
-     * 1) формируем вектор offices (gatherers сформирован выше) и передаём их провайдеру
+     * 1) берём массивы позиций и радиусов офисов карты (gatherers сформирован выше)
      * 2) получаем вектор событий посещения собаками офисов
      * 3) для каждого события:
      *      - сбрасываем все подобранные вещи */
     void Application::BringItemsToOffices(std::shared_ptr<model::GameSession> session,
-                         const std::vector<collision_detector::Gatherer>& gatherers,
-                         const std::unordered_map<size_t, std::shared_ptr<model::Dog>>& idx_to_dog) {
-        std::vector<std::shared_ptr<model::LostObject>> offices;
-        for (const auto& office : session->GetMap()->GetOffices()) {
-            offices.emplace_back(std::make_shared<model::LostObject>(model::LostObject(0,
-                                                        {static_cast<double>(office.GetPosition().x),
-                                                        static_cast<double>(office.GetPosition().y)},
-                                                   offices.size(),
-                                                   model::LostObject::OFFICE_HALF_WIDTH)));
-        }
-        ItemGatherer og(offices.size(), offices, gatherers.size(), gatherers);
-        for (const auto& event : collision_detector::FindGatherEvents(og)) {
-            auto dog = idx_to_dog.at(event.gatherer_id);
-            if (dog->IsBagEmpty()) {
+                         const std::vector<collision_detector::Gatherer>& gatherers) {
+        const model::Map* map = session->GetMap();
+        model::SessionDogs& dogs = session->GetDogs();
+        for (const auto& event : collision_detector::FindGatherEvents(map->GetOfficePositions(), map->GetOfficeWidths(),
+                                                                      gatherers, map->IsFixedPoint())) {
+            const size_t dog_idx = event.gatherer_id;
+            if (dogs.GetBag(dog_idx).empty()) {
                 continue;
             }
-            for(const auto& obj : dog->FlushPickedObjects()) {
-                dog->AddScores(session->GetMap()->GetLootByIndex(obj.GetType()).GetScores());
+            for(const auto& obj : dogs.GetBag(dog_idx)) {
+                dogs.AddScores(dog_idx, map->GetLootByIndex(obj.GetType()).GetScores());
             }
+            dogs.ClearBag(dog_idx);
         }
     }
 
     /* Удаляем игрока:
      * 1) Удаляем из Players
      * 2) Удаляем из PlayerTokens
-     * 3) Удаляем из GameSessions
-     * 4) Удаляем пользователя (собака и подобранные объекты удалятся сами) */
+     * 3) Удаляем собаку с подобранными объектами из массивов сессии
+     * 4) Удаляем пользователя */
     void Application::DeletePlayer(std::shared_ptr<Player> player) {
         players_.Delete(player);
         player_tokens_.Delete(player);
-        player->GetGameSession()->DeleteDog(player->GetDog()->GetDogId());
+        player->GetGameSession()->DeleteDog(player->GetId());
         //player.reset();
     }
 
@@ -304,9 +352,7 @@ std::stringstream SerializeState(const Application& app) {
 
     std::vector<serialization::GameSessionRepr> session_repr_vec;
     for (const auto &session_ptr : app.game_.GetSessions()) {
-        if (session_ptr != nullptr) {
-            session_repr_vec.emplace_back(*session_ptr);
-        }
+        session_repr_vec.emplace_back(*session_ptr);
     }
     output_archive << session_repr_vec;
     output_archive << serialization::PlayersRepr(app.players_);
@@ -320,14 +366,18 @@ void DeserializeState(std::stringstream& strm, Application& app) {
 
     std::vector<serialization::GameSessionRepr> sessions_repr_vec;
     input_archive >> sessions_repr_vec;
+    serialization::PlayersRepr players_repr;
+    input_archive >> players_repr;
+
+    // в файлах версии 0 собаки сохранены в игроках, до восстановления сессий они переносятся в сессии
+    std::unordered_map<size_t, serialization::DogRepr> legacy_dogs = players_repr.TakeLegacyDogs();
     std::vector<model::Game::Sessions> sessions;
     for (auto& session_repr : sessions_repr_vec) {
+        session_repr.RestoreLegacyDogs(legacy_dogs);
         sessions.emplace_back(std::make_shared<model::GameSession>(session_repr.Restore(app.game_)));
     }
     app.game_.RestoreSessions(std::move(sessions));
 
-    serialization::PlayersRepr players_repr;
-    input_archive >> players_repr;
     app.players_ = std::move(players_repr.Restore(app.game_.GetSessions()));
 
     serialization::PlayerTokensRepr tokens_repr;
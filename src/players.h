@@ -45,17 +45,23 @@ namespace players {
         using TokenHasher = util::TaggedHasher<Token>;
         using TokenToPlayer = std::unordered_map<Token, std::shared_ptr<Player>, TokenHasher>;
 
+        /* Токены - данные для авторизации, поэтому их генераторы всегда получают зерно из std::random_device
+         * и не зависят от зерна игры (--seed) */
         PlayerTokens() = default;
 
         PlayerTokens(const PlayerTokens&) = delete;
-        PlayerTokens(PlayerTokens&& other) noexcept {
-            token_to_player_ = std::move(other.token_to_player_);
+        PlayerTokens(PlayerTokens&& other) noexcept
+            : generator1_(std::move(other.generator1_))
+            , generator2_(std::move(other.generator2_))
+            , token_to_player_(std::move(other.token_to_player_)) {
             other.token_to_player_ = {};
         }
 
         PlayerTokens& operator=(const PlayerTokens&) = delete;
         PlayerTokens& operator=(PlayerTokens&& other) noexcept {
             if (this != &other) {
+                generator1_ = std::move(other.generator1_);
+                generator2_ = std::move(other.generator2_);
                 token_to_player_ = std::move(other.token_to_player_);
                 other.token_to_player_ = {};
             }
@@ -79,15 +85,14 @@ namespace players {
         void Delete(std::shared_ptr<Player> player);
 
     private:
-        std::random_device random_device_;
-        std::mt19937_64 generator1_{[this] {
-            std::uniform_int_distribution<std::mt19937_64::result_type> dist;
-            return dist(random_device_);
-        }()};
-        std::mt19937_64 generator2_{[this] {
-            std::uniform_int_distribution<std::mt19937_64::result_type> dist;
-            return dist(random_device_);
-        }()};
+        static std::mt19937_64 MakeGenerator() {
+            std::random_device random_device;
+            std::seed_seq seq{random_device(), random_device(), random_device(), random_device()};
+            return std::mt19937_64(seq);
+        }
+
+        std::mt19937_64 generator1_ = MakeGenerator();
+        std::mt19937_64 generator2_ = MakeGenerator();
 
         TokenToPlayer token_to_player_;
     };
@@ -97,23 +102,30 @@ namespace players {
     public:
         /*
          * Создание пользователя:
-         * 1) создаём собаку для пользователя
-         * 2) сохраняем игровую сессию пользователя
+         * 1) добавляем собаку пользователя в игровую сессию
+         * 2) сохраняем игровую сессию пользователя и Handle собаки в ней
          */
         explicit Player(model::Dog dog, std::shared_ptr<model::GameSession> game_session)
-                        : dog_(std::make_shared<model::Dog>(dog))
-                        , session_(std::move(game_session)) {}
-
-        std::shared_ptr<model::Dog> GetDog() const noexcept {
-            return dog_;
+                        : id_(dog.GetDogId())
+                        , session_(std::move(game_session))
+                        , dog_handle_(session_->AddDog(std::move(dog))) {}
+
+        /* Игрок собаки, уже добавленной в сессию (восстановление состояния) */
+        Player(size_t dog_id, std::shared_ptr<model::GameSession> game_session, model::GameSession::DogHandle dog_handle)
+                        : id_(dog_id)
+                        , session_(std::move(game_session))
+                        , dog_handle_(dog_handle) {}
+
+        model::DogRef GetDog() const noexcept {
+            return session_->GetDog(dog_handle_);
         }
 
         size_t GetId() const noexcept {
-            return dog_->GetDogId();
+            return id_;
         }
 
         const std::string& GetName() const noexcept {
-            return dog_->GetDogName();
+            return GetDog().GetDogName();
         }
 
         std::shared_ptr<model::GameSession> GetGameSession() const noexcept {
@@ -121,8 +133,9 @@ namespace players {
         }
 
     private:
-        std::shared_ptr<model::Dog> dog_;
+        size_t id_; // id собаки
         std::shared_ptr<model::GameSession> session_;
+        model::GameSession::DogHandle dog_handle_;
     };
 
     /* --------------------------------------- Перечень всех игроков --------------------------------------- */
@@ -163,36 +176,6 @@ namespace players {
         std::unordered_map<size_t, PlayerIt> map_id_to_it_; // dog_id, iterator_to_player_in_PlayersAll
     };
 
-    /* -------------------- Класс для передачи данных в функцию поиска коллизий -------------------- */
-    class ItemGatherer : public collision_detector::ItemGathererProvider {
-    public:
-        explicit ItemGatherer(size_t ic, const std::vector<std::shared_ptr<model::LostObject>>& items,
-                              size_t gc, const std::vector<collision_detector::Gatherer>& ga)
-                                : items_count_(ic)
-                                , items_(items)
-                                , gatherers_count_(gc)
-                                , gatherer_(ga) {}
-
-        size_t ItemsCount() const override {
-            return items_count_;
-        }
-        collision_detector::Item GetItem(size_t idx) const override {
-            return *(items_[idx]);
-        }
-        size_t GatherersCount() const override {
-            return gatherers_count_;
-        }
-        collision_detector::Gatherer GetGatherer(size_t idx) const override {
-            return gatherer_[idx];
-        }
-
-    private:
-        size_t items_count_;
-        const std::vector<std::shared_ptr<model::LostObject>>& items_;
-        size_t gatherers_count_;
-        const std::vector<collision_detector::Gatherer>& gatherer_;
-    };
-
     enum class JoinGameErrorCode {
         NONE,
         MAP_NOT_FOUND,
@@ -204,12 +187,13 @@ namespace players {
         std::shared_ptr<Token> player_token;
         size_t dog_id = 0;
         JoinGameErrorCode error = JoinGameErrorCode::NONE;
+        size_t instance_id = 0; // номер экземпляра сессии карты, в которую попал игрок
     };
 
     struct GameState {
         size_t dog_id;
         model::DogState state;
-        const std::vector<model::PickedObject>& picked_objects;
+        const model::Bag& picked_objects;
         size_t scores;
     };
 
@@ -247,8 +231,6 @@ namespace players {
         friend std::stringstream SerializeState(const Application &app);
         friend void DeserializeState(std::stringstream& strm, Application& app);
 
-        using Dogs = std::vector<std::shared_ptr<model::Dog>>;
-
         Application(model::Game &game,
                     bool randomize_spawn_point,
                     bool game_tick_disable,
@@ -274,26 +256,29 @@ namespace players {
             return player_tokens_.FindPlayerByToken(token);
         }
         const GameState GetPlayerGameState(const std::shared_ptr<players::Player> player) const {
-            return {player->GetDog()->GetDogId(),
-                    player->GetDog()->GetDogState(),
-                    player->GetDog()->GetPickedObjects(),
-                    player->GetDog()->GetScores()};
+            const model::DogRef dog = player->GetDog();
+            return {dog.GetDogId(),
+                    dog.GetDogState(),
+                    dog.GetPickedObjects(),
+                    dog.GetScores()};
         }
-        std::shared_ptr<model::Dog> GetDogById(size_t id) const noexcept {
+        model::DogRef GetDogById(size_t id) const noexcept {
             return players_.FindPlayerByDogId(id)->GetDog();
         }
-        Dogs GetDogsInSession(const std::shared_ptr<Player> player) const noexcept {
-            Dogs dogs;
-            for (const size_t dog_id : player->GetGameSession()->GetDogIds()) {
-                dogs.push_back(GetDogById(dog_id));
-            }
-            return dogs;
+        const model::SessionDogs& GetDogsInSession(const std::shared_ptr<Player> player) const noexcept {
+            return player->GetGameSession()->GetDogs();
         }
 
         void SetDogAction(std::shared_ptr<Player> player, ActionMove action_move);
         std::vector<std::shared_ptr<Player>> GetPlayersInSession(const std::shared_ptr<Player> player) const;
         void MoveDogs(double time_period);
 
+        /* Горячая перезагрузка карт (Game::ReplaceMaps), вызывается в api_strand между тиками.
+         * Подсказки дорог собак строятся заново по новым картам, собаки вне дорог новой карты
+         * переносятся на дорогу и останавливаются, из сумок удаляются предметы пропавших типов.
+         * Возвращает прежние карты, чтобы их освободили вне api_strand */
+        model::Game::Maps ReloadMaps(model::Game::Maps maps);
+
         double GetTickPeriod() const noexcept {
             return tick_period_;
         }
@@ -312,12 +297,11 @@ namespace players {
         std::vector<Champion> GetChampions(size_t start, size_t max_items) const;
 
     private:
+        /* Собиратель gatherers[idx] - собака сессии с индексом idx */
         void PickUpItems(std::shared_ptr<model::GameSession> session,
-                         const std::vector<collision_detector::Gatherer>& gatherers,
-                         const std::unordered_map<size_t, std::shared_ptr<model::Dog>>& idx_to_dog);
+                         const std::vector<collision_detector::Gatherer>& gatherers);
         void BringItemsToOffices(std::shared_ptr<model::GameSession> session,
-                         const std::vector<collision_detector::Gatherer>& gatherers,
-                         const std::unordered_map<size_t, std::shared_ptr<model::Dog>> &idx_to_dog);
+                         const std::vector<collision_detector::Gatherer>& gatherers);
         void DeletePlayer(std::shared_ptr<Player> player);
 
         model::Game& game_;
@@ -0,0 +1,51 @@
+/*
+ * Общий источник случайности игры.
+ * Все генераторы игрового мира (точки появления и типы вещей на картах) получаются из одного зерна:
+ * при одинаковом зерне (опция --seed) сервер воспроизводит один и тот же игровой мир.
+ * Токены игроков отсюда не берутся: они должны быть непредсказуемы (players::PlayerTokens).
+ * Без зерна оно один раз берётся из std::random_device.
+ */
+#pragma once
+#include <cstdint>
+#include <random>
+
+namespace model {
+
+class RandomSource {
+public:
+    using Engine = std::mt19937_64;
+    using Seed = std::uint64_t;
+
+    /* Независимые потоки случайных чисел для разных частей игры */
+    enum class Stream : std::uint32_t {
+        MAP
+    };
+
+    RandomSource()
+        : seed_(MakeRandomSeed()) {}
+
+    explicit RandomSource(Seed seed) noexcept
+        : seed_(seed) {}
+
+    Seed GetSeed() const noexcept {
+        return seed_;
+    }
+
+    /* Генератор потока stream с номером index (например, индексом карты в игре):
+     * одинаковые зерно, поток и номер всегда дают одну и ту же последовательность */
+    Engine MakeEngine(Stream stream, std::uint32_t index = 0) const {
+        std::seed_seq seq{static_cast<std::uint32_t>(seed_), static_cast<std::uint32_t>(seed_ >> 32),
+                          static_cast<std::uint32_t>(stream), index};
+        return Engine(seq);
+    }
+
+private:
+    static Seed MakeRandomSeed() {
+        std::random_device random_device;
+        return (static_cast<Seed>(random_device()) << 32) | random_device();
+    }
+
+    Seed seed_;
+};
+
+} // namespace model
@@ -0,0 +1,187 @@
+#include "road_graph.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace road_graph {
+
+void RoadGraph::Build(const road_index::RoadIndex& roads) {
+    segments_.clear();
+    rows_.clear();
+    columns_.clear();
+    junctions_.clear();
+    segment_junctions_.clear();
+
+    AddSegments(Axis::HORIZONTAL, roads.GetRows(), rows_);
+    AddSegments(Axis::VERTICAL, roads.GetColumns(), columns_);
+    AddJunctions();
+    AddSegmentJunctions();
+    LinkNeighbours();
+    BuildSampler();
+
+    segments_.shrink_to_fit();
+    rows_.shrink_to_fit();
+    columns_.shrink_to_fit();
+    junctions_.shrink_to_fit();
+}
+
+/* Отрезки линии отсортированы по началу, поэтому сливаются за один проход:
+ * следующий отрезок продолжает участок, если начинается не дальше его конца */
+void RoadGraph::AddSegments(Axis axis, const road_index::LineIndex& index, Lines& lines) {
+    for (const road_index::Line& line : index.GetLines()) {
+        const size_t first = segments_.size();
+        for (const road_index::Interval& interval : line.intervals) {
+            if ((segments_.size() > first) && (interval.start <= segments_.back().end)) {
+                segments_.back().end = std::max(segments_.back().end, interval.end);
+            } else {
+                segments_.push_back(Segment{axis, line.key, interval.start, interval.end});
+            }
+        }
+        lines.push_back(LineRange{line.key, first, segments_.size()});
+    }
+}
+
+/* Горизонтальные участки перебираются по возрастанию y, столбцы - по возрастанию x:
+ * перекрёстки получаются упорядочены по (y, x) */
+void RoadGraph::AddJunctions() {
+    for (const LineRange& row : rows_) {
+        for (size_t h = row.first; h < row.last; ++h) {
+            auto column_it = std::lower_bound(columns_.begin(), columns_.end(), segments_[h].start,
+                                              [](const LineRange& line, Coord value) {
+                                                  return line.key < value;
+                                              });
+            for (; (column_it != columns_.end()) && (column_it->key <= segments_[h].end); ++column_it) {
+                const size_t v = FindInLines(columns_, column_it->key, row.key);
+                if (v == NO_SEGMENT) {
+                    continue;
+                }
+                junctions_.push_back(Junction{column_it->key, row.key, h, v,
+                                              {NO_JUNCTION, NO_JUNCTION, NO_JUNCTION, NO_JUNCTION}});
+            }
+        }
+    }
+}
+
+/* Сортировка подсчётом: сначала диапазоны участков по числу их перекрёстков, затем заполнение
+ * в порядке (y, x) - внутри каждого участка перекрёстки получаются отсортированы вдоль него */
+void RoadGraph::AddSegmentJunctions() {
+    for (const Junction& junction : junctions_) {
+        ++segments_[junction.horizontal].junctions_end;
+        ++segments_[junction.vertical].junctions_end;
+    }
+    size_t offset = 0;
+    for (Segment& segment : segments_) {
+        segment.junctions_begin = offset;
+        offset += segment.junctions_end;
+        segment.junctions_end = segment.junctions_begin;
+    }
+    segment_junctions_.resize(offset);
+    for (size_t i = 0; i != junctions_.size(); ++i) {
+        segment_junctions_[segments_[junctions_[i].horizontal].junctions_end++] = i;
+        segment_junctions_[segments_[junctions_[i].vertical].junctions_end++] = i;
+    }
+}
+
+void RoadGraph::LinkNeighbours() {
+    for (size_t segment_idx = 0; segment_idx != segments_.size(); ++segment_idx) {
+        const Side before = (segments_[segment_idx].axis == Axis::HORIZONTAL) ? WEST : NORTH;
+        const Side after = (segments_[segment_idx].axis == Axis::HORIZONTAL) ? EAST : SOUTH;
+        const std::span<const size_t> segment_junctions = GetSegmentJunctions(segment_idx);
+        for (size_t i = 1; i < segment_junctions.size(); ++i) {
+            junctions_[segment_junctions[i - 1]].neighbours[after] = segment_junctions[i];
+            junctions_[segment_junctions[i]].neighbours[before] = segment_junctions[i - 1];
+        }
+    }
+}
+
+/* Метод Воуза: вес каждого участка нормируется так, чтобы средний был равен 1,
+ * затем недостающая до 1 доля "лёгкого" столбца заполняется избытком "тяжёлого" участка */
+void RoadGraph::BuildSampler() {
+    const size_t count = segments_.size();
+    sample_probability_.assign(count, 1.);
+    sample_alias_.resize(count);
+    if (count == 0) {
+        return;
+    }
+
+    double total_weight = 0.;
+    for (const Segment& segment : segments_) {
+        total_weight += static_cast<double>(segment.Length()) + 1.;
+    }
+    std::vector<double> scaled(count);
+    std::vector<size_t> light;
+    std::vector<size_t> heavy;
+    for (size_t i = 0; i != count; ++i) {
+        sample_alias_[i] = i;
+        scaled[i] = (static_cast<double>(segments_[i].Length()) + 1.) * static_cast<double>(count) / total_weight;
+        (scaled[i] < 1. ? light : heavy).push_back(i);
+    }
+    while (!light.empty() && !heavy.empty()) {
+        const size_t l = light.back();
+        light.pop_back();
+        const size_t h = heavy.back();
+        sample_probability_[l] = scaled[l];
+        sample_alias_[l] = h;
+        scaled[h] -= (1. - scaled[l]);
+        if (scaled[h] < 1.) {
+            heavy.pop_back();
+            light.push_back(h);
+        }
+    }
+    // оставшиеся столбцы из-за погрешности округления заполнены почти полностью - считаем их полными
+}
+
+size_t RoadGraph::FindInLines(const Lines& lines, Coord key, Coord along) const noexcept {
+    auto line_it = std::lower_bound(lines.begin(), lines.end(), key,
+                                    [](const LineRange& line, Coord value) {
+                                        return line.key < value;
+                                    });
+    if ((line_it == lines.end()) || (line_it->key != key)) {
+        return NO_SEGMENT;
+    }
+    // участки линии не перекрываются: нужный - последний, начинающийся не правее along
+    auto first = segments_.begin() + line_it->first;
+    auto last = segments_.begin() + line_it->last;
+    auto segment_it = std::upper_bound(first, last, along,
+                                       [](Coord value, const Segment& segment) {
+                                           return value < segment.start;
+                                       });
+    if (segment_it == first) {
+        return NO_SEGMENT;
+    }
+    --segment_it;
+    if (segment_it->end < along) {
+        return NO_SEGMENT;
+    }
+    return static_cast<size_t>(std::distance(segments_.begin(), segment_it));
+}
+
+size_t RoadGraph::FindSegment(Axis axis, Coord x, Coord y) const noexcept {
+    if (axis == Axis::HORIZONTAL) {
+        return FindInLines(rows_, y, x);
+    }
+    return FindInLines(columns_, x, y);
+}
+
+size_t RoadGraph::FindJunction(size_t segment, Coord along) const noexcept {
+    const Segment& s = segments_[segment];
+    const std::span<const size_t> segment_junctions = GetSegmentJunctions(segment);
+    auto it = std::lower_bound(segment_junctions.begin(), segment_junctions.end(), along,
+                               [this, &s](size_t junction_idx, Coord value) {
+                                   const Junction& junction = junctions_[junction_idx];
+                                   return ((s.axis == Axis::HORIZONTAL) ? junction.x : junction.y) < value;
+                               });
+    if (it == segment_junctions.end()) {
+        return NO_JUNCTION;
+    }
+    const Junction& junction = junctions_[*it];
+    return (((s.axis == Axis::HORIZONTAL) ? junction.x : junction.y) == along) ? *it : NO_JUNCTION;
+}
+
+size_t RoadGraph::GetMemoryUsage() const noexcept {
+    return segments_.capacity() * sizeof(Segment) + (rows_.capacity() + columns_.capacity()) * sizeof(LineRange) +
+           junctions_.capacity() * sizeof(Junction) + segment_junctions_.capacity() * sizeof(size_t) +
+           sample_probability_.capacity() * sizeof(double) + sample_alias_.capacity() * sizeof(size_t);
+}
+
+} // namespace road_graph
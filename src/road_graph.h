@@ -0,0 +1,208 @@
+/*
+ * Граф дорог карты, собирается из индекса дорог после их загрузки.
+ * Участок (Segment) - непрерывный отрезок линии, составленный из дорог, которые перекрываются
+ * или касаются концами: по нему можно пройти от start до end, не сходя с дорог.
+ * Перекрёсток (Junction) - точка, в которой горизонтальный участок пересекает вертикальный или касается его.
+ * Каждая точка карты лежит не больше чем на одном горизонтальном и одном вертикальном участке,
+ * поэтому граница, до которой собака может дойти по прямой, известна сразу - это конец участка.
+ */
+#pragma once
+#include "road_index.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace road_graph {
+
+using Coord = road_index::Coord;
+
+enum class Axis {
+    HORIZONTAL,
+    VERTICAL
+};
+
+/* key - строка (y) горизонтального или столбец (x) вертикального участка,
+ * [start, end] - координаты вдоль линии, [junctions_begin, junctions_end) - перекрёстки участка
+ * в общем массиве перекрёстков участков графа (RoadGraph::GetSegmentJunctions), отсортированы вдоль участка */
+struct Segment {
+    Axis axis;
+    Coord key;
+    Coord start;
+    Coord end;
+    size_t junctions_begin = 0;
+    size_t junctions_end = 0;
+
+    bool Contains(Coord x, Coord y) const noexcept {
+        const Coord line = (axis == Axis::HORIZONTAL) ? y : x;
+        const Coord along = (axis == Axis::HORIZONTAL) ? x : y;
+        return (line == key) && (along >= start) && (along <= end);
+    }
+    Coord Length() const noexcept {
+        return end - start;
+    }
+};
+
+/* Стороны света для соседей перекрёстка, север - в сторону уменьшения y */
+enum Side {
+    WEST,
+    EAST,
+    NORTH,
+    SOUTH
+};
+
+/* horizontal, vertical - индексы пересекающихся участков,
+ * neighbours - ближайшие перекрёстки по сторонам света (NO_JUNCTION - соседа нет) */
+struct Junction {
+    Coord x;
+    Coord y;
+    size_t horizontal;
+    size_t vertical;
+    std::array<size_t, 4> neighbours;
+};
+
+class RoadGraph {
+public:
+    static constexpr size_t NO_SEGMENT = std::numeric_limits<size_t>::max();
+    static constexpr size_t NO_JUNCTION = std::numeric_limits<size_t>::max();
+
+    /* Пересобирает граф по индексу дорог: участки получаются слиянием отрезков каждой линии,
+     * перекрёстки - поиском вертикальных участков в пределах каждого горизонтального,
+     * таблица выбора участков - по их длинам */
+    void Build(const road_index::RoadIndex& roads);
+
+    /* Участок направления axis, проходящий через точку (x, y), или NO_SEGMENT */
+    size_t FindSegment(Axis axis, Coord x, Coord y) const noexcept;
+
+    /* Вызывает fn(segment_idx) для каждого участка, проходящего через точку прямоугольника [x0, x1] x [y0, y1] */
+    template <typename Fn>
+    void ForEachSegmentIn(Coord x0, Coord y0, Coord x1, Coord y1, Fn&& fn) const {
+        ForEachSegmentInLines(rows_, y0, y1, x0, x1, fn);
+        ForEachSegmentInLines(columns_, x0, x1, y0, y1, fn);
+    }
+
+    /* Перекрёсток участка segment в точке along (координата вдоль участка), или NO_JUNCTION */
+    size_t FindJunction(size_t segment, Coord along) const noexcept;
+
+    /* Случайный участок с вероятностью, пропорциональной числу его точек (length + 1).
+     * Выбор по таблице псевдонимов (alias method): одно случайное число для столбца и одно для выбора
+     * между участком столбца и его псевдонимом, без выделения памяти. Граф не должен быть пустым */
+    template <typename Generator>
+    size_t SampleSegment(Generator& generator) const {
+        std::uniform_int_distribution<size_t> column_gen(0, segments_.size() - 1);
+        std::uniform_real_distribution<double> coin_gen(0., 1.);
+        const size_t column = column_gen(generator);
+        return (coin_gen(generator) < sample_probability_[column]) ? column : sample_alias_[column];
+    }
+
+    const Segment& GetSegment(size_t idx) const noexcept {
+        return segments_[idx];
+    }
+    const std::vector<Segment>& GetSegments() const noexcept {
+        return segments_;
+    }
+    /* Индексы перекрёстков участка segment, отсортированы вдоль участка */
+    std::span<const size_t> GetSegmentJunctions(size_t segment) const noexcept {
+        const Segment& s = segments_[segment];
+        return {segment_junctions_.data() + s.junctions_begin, s.junctions_end - s.junctions_begin};
+    }
+    const std::vector<Junction>& GetJunctions() const noexcept {
+        return junctions_;
+    }
+
+    /* Память массивов графа в куче, в байтах */
+    size_t GetMemoryUsage() const noexcept;
+
+    /* Запись и чтение построенного графа в двоичном наборе карт (map_bundle.h): массивы участков,
+     * перекрёстков и таблицы выбора копируются целиком, у линий поля пишутся по одному -
+     * в LineRange есть байты выравнивания */
+    template <typename Archive>
+        requires(!Archive::IS_LOADING)
+    void SerializeBundle(Archive& ar) const {
+        ar.Array(segments_);
+        for (const Lines* lines : {&rows_, &columns_}) {
+            ar.Size(lines->size());
+            for (const LineRange& line : *lines) {
+                ar.Value(line.key);
+                ar.Value(line.first);
+                ar.Value(line.last);
+            }
+        }
+        ar.Array(junctions_);
+        ar.Array(segment_junctions_);
+        ar.Array(sample_probability_);
+        ar.Array(sample_alias_);
+    }
+    template <typename Archive>
+        requires Archive::IS_LOADING
+    void SerializeBundle(Archive& ar) {
+        ar.Array(segments_);
+        for (Lines* lines : {&rows_, &columns_}) {
+            size_t count = 0;
+            ar.Size(count);
+            lines->resize(count);
+            for (LineRange& line : *lines) {
+                ar.Value(line.key);
+                ar.Value(line.first);
+                ar.Value(line.last);
+            }
+        }
+        ar.Array(junctions_);
+        ar.Array(segment_junctions_);
+        ar.Array(sample_probability_);
+        ar.Array(sample_alias_);
+    }
+
+private:
+    /* Участки одной линии лежат подряд: segments_[first, last) */
+    struct LineRange {
+        Coord key;
+        size_t first;
+        size_t last;
+    };
+    using Lines = std::vector<LineRange>;
+
+    void AddSegments(Axis axis, const road_index::LineIndex& index, Lines& lines);
+    void AddJunctions();
+    void AddSegmentJunctions();
+    void LinkNeighbours();
+    void BuildSampler();
+    size_t FindInLines(const Lines& lines, Coord key, Coord along) const noexcept;
+
+    /* Участки линий с key в [key0, key1], задевающие координаты [along0, along1] вдоль линии.
+     * Участки линии не пересекаются и отсортированы по start, значит, и по end */
+    template <typename Fn>
+    void ForEachSegmentInLines(const Lines& lines, Coord key0, Coord key1, Coord along0, Coord along1, Fn& fn) const {
+        auto line = std::lower_bound(lines.begin(), lines.end(), key0, [](const LineRange& range, Coord key) {
+            return range.key < key;
+        });
+        for (; (line != lines.end()) && (line->key <= key1); ++line) {
+            const auto first = segments_.begin() + static_cast<std::ptrdiff_t>(line->first);
+            const auto last = segments_.begin() + static_cast<std::ptrdiff_t>(line->last);
+            auto it = std::lower_bound(first, last, along0, [](const Segment& segment, Coord along) {
+                return segment.end < along;
+            });
+            for (; (it != last) && (it->start <= along1); ++it) {
+                fn(static_cast<size_t>(it - segments_.begin()));
+            }
+        }
+    }
+
+    std::vector<Segment> segments_; // сначала горизонтальные, затем вертикальные; внутри линии - по start
+    Lines rows_;
+    Lines columns_;
+    std::vector<Junction> junctions_;
+    /* Перекрёстки всех участков подряд, участок хранит свой диапазон: один массив вместо массива на участок */
+    std::vector<size_t> segment_junctions_;
+
+    /* Таблица псевдонимов: столбец i выбирает участок i с вероятностью sample_probability_[i],
+     * иначе - участок sample_alias_[i] */
+    std::vector<double> sample_probability_;
+    std::vector<size_t> sample_alias_;
+};
+
+} // namespace road_graph
@@ -0,0 +1,116 @@
+#include "road_index.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace road_index {
+
+/* Новая линия вставляется на своё место по key, отрезок - на своё место по start.
+ * Линии короткие, поэтому вставка в середину массива дешёвая */
+void LineIndex::Add(Coord key, Coord start, Coord end, size_t road_idx) {
+    auto line_it = std::lower_bound(lines_.begin(), lines_.end(), key,
+                                    [](const Line& line, Coord value) {
+                                        return line.key < value;
+                                    });
+    if ((line_it == lines_.end()) || (line_it->key != key)) {
+        line_it = lines_.insert(line_it, Line{key, 0, {}});
+    }
+    auto interval_it = std::upper_bound(line_it->intervals.begin(), line_it->intervals.end(), start,
+                                        [](Coord value, const Interval& interval) {
+                                            return value < interval.start;
+                                        });
+    line_it->intervals.insert(interval_it, Interval{start, end, road_idx});
+    line_it->max_length = std::max(line_it->max_length, end - start);
+}
+
+const Line* LineIndex::FindLine(Coord key) const noexcept {
+    auto line_it = std::lower_bound(lines_.begin(), lines_.end(), key,
+                                    [](const Line& line, Coord value) {
+                                        return line.key < value;
+                                    });
+    if ((line_it == lines_.end()) || (line_it->key != key)) {
+        return nullptr;
+    }
+    return &(*line_it);
+}
+
+void LineIndex::ShrinkToFit() {
+    lines_.shrink_to_fit();
+    for (Line& line : lines_) {
+        line.intervals.shrink_to_fit();
+    }
+}
+
+size_t LineIndex::GetMemoryUsage() const noexcept {
+    size_t memory = lines_.capacity() * sizeof(Line);
+    for (const Line& line : lines_) {
+        memory += line.intervals.capacity() * sizeof(Interval);
+    }
+    return memory;
+}
+
+RoadIndex::Roads RoadIndex::FindRoads(Coord x, Coord y) const {
+    Roads found_roads;
+    rows_.ForEachAt(y, x, [&found_roads](const Interval& interval) {
+        found_roads.push_back(interval.road_idx);
+    });
+    columns_.ForEachAt(x, y, [&found_roads](const Interval& interval) {
+        found_roads.push_back(interval.road_idx);
+    });
+    return found_roads;
+}
+
+/*
+ * Ищем ближайшие к pos точки дороги, где её касаются другие дороги:
+ * 1) дороги той же линии, перекрывающие отрезок road
+ * 2) дороги перпендикулярного направления, пересекающие линию key в пределах road
+ */
+Span RoadIndex::FindFreeSpan(const LineIndex& own, const LineIndex& cross,
+                             Coord key, const Interval& road, Coord pos) {
+    const Span empty{pos + 1, pos};
+    Span span{road.start, road.end};
+
+    if (const Line* line = own.FindLine(key)) {
+        auto it = std::lower_bound(line->intervals.begin(), line->intervals.end(), road.start - line->max_length,
+                                   [](const Interval& interval, Coord value) {
+                                       return interval.start < value;
+                                   });
+        for (; (it != line->intervals.end()) && (it->start <= road.end); ++it) {
+            if ((it->road_idx == road.road_idx) || (it->end < road.start)) {
+                continue;
+            }
+            if ((it->start <= pos) && (pos <= it->end)) {
+                return empty;
+            }
+            if (it->end < pos) {
+                span.from = std::max(span.from, it->end + 1);
+            } else {
+                span.to = std::min(span.to, it->start - 1);
+            }
+        }
+    }
+
+    const auto& lines = cross.GetLines();
+    auto right = std::lower_bound(lines.begin(), lines.end(), pos,
+                                  [](const Line& line, Coord value) {
+                                      return line.key < value;
+                                  });
+    for (auto it = right; (it != lines.end()) && (it->key <= span.to); ++it) {
+        if (cross.Contains(it->key, key)) {
+            if (it->key == pos) {
+                return empty;
+            }
+            span.to = it->key - 1;
+            break;
+        }
+    }
+    for (auto it = right; (it != lines.begin()) && (std::prev(it)->key >= span.from); --it) {
+        if (cross.Contains(std::prev(it)->key, key)) {
+            span.from = std::prev(it)->key + 1;
+            break;
+        }
+    }
+    return span;
+}
+
+} // namespace road_index
@@ -0,0 +1,179 @@
+/*
+ * Индекс дорог карты для поиска дорог по координатам точки.
+ * Для каждой строки (y) хранится отсортированный по началу массив отрезков горизонтальных дорог,
+ * для каждого столбца (x) - такой же массив отрезков вертикальных дорог.
+ * Индекс заполняется при добавлении дорог на карту (Map::AddRoad, Map::AddRoads),
+ * поиск дорог по точке не выделяет память в куче.
+ */
+#pragma once
+#include <boost/container/small_vector.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace road_index {
+
+using Coord = int;
+
+/* Отрезок дороги вдоль линии: start <= end, road_idx - индекс дороги в массиве дорог карты */
+struct Interval {
+    Coord start;
+    Coord end;
+    size_t road_idx;
+};
+
+/* Линия - строка (для горизонтальных дорог) или столбец (для вертикальных дорог) карты.
+ * max_length - длина самого длинного отрезка линии, ограничивает перебор при поиске */
+struct Line {
+    Coord key;
+    Coord max_length = 0;
+    std::vector<Interval> intervals; // отсортированы по start
+};
+
+/* Участок линии [from, to] */
+struct Span {
+    Coord from;
+    Coord to;
+};
+
+/* Линии одного направления, отсортированы по key */
+class LineIndex {
+public:
+    void Add(Coord key, Coord start, Coord end, size_t road_idx);
+
+    const Line* FindLine(Coord key) const noexcept;
+
+    /* Есть ли на линии key отрезок, содержащий pos */
+    bool Contains(Coord key, Coord pos) const {
+        bool found = false;
+        ForEachAt(key, pos, [&found](const Interval&) {
+            found = true;
+        });
+        return found;
+    }
+
+    const std::vector<Line>& GetLines() const noexcept {
+        return lines_;
+    }
+
+    void ShrinkToFit();
+    size_t GetMemoryUsage() const noexcept;
+
+    /* Запись и чтение линий в двоичном наборе карт (map_bundle.h) */
+    template <typename Archive>
+        requires(!Archive::IS_LOADING)
+    void SerializeBundle(Archive& ar) const {
+        ar.Size(lines_.size());
+        for (const Line& line : lines_) {
+            ar.Value(line.key);
+            ar.Value(line.max_length);
+            ar.Array(line.intervals);
+        }
+    }
+    template <typename Archive>
+        requires Archive::IS_LOADING
+    void SerializeBundle(Archive& ar) {
+        size_t count = 0;
+        ar.Size(count);
+        lines_.resize(count);
+        for (Line& line : lines_) {
+            ar.Value(line.key);
+            ar.Value(line.max_length);
+            ar.Array(line.intervals);
+        }
+    }
+
+    /* Вызывает fn(const Interval&) для каждого отрезка линии key, содержащего координату pos */
+    template <typename Fn>
+    void ForEachAt(Coord key, Coord pos, Fn&& fn) const {
+        const Line* line = FindLine(key);
+        if (line == nullptr) {
+            return;
+        }
+        // первый отрезок, начинающийся правее pos; перебираем влево, пока отрезки могут дотянуться до pos
+        auto it = std::upper_bound(line->intervals.begin(), line->intervals.end(), pos,
+                                   [](Coord value, const Interval& interval) {
+                                       return value < interval.start;
+                                   });
+        while (it != line->intervals.begin()) {
+            --it;
+            if (pos - it->start > line->max_length) {
+                break;
+            }
+            if (pos <= it->end) {
+                fn(*it);
+            }
+        }
+    }
+
+private:
+    std::vector<Line> lines_;
+};
+
+class RoadIndex {
+public:
+    /* В точке обычно сходится не больше двух горизонтальных и двух вертикальных дорог,
+     * результат поиска хранится внутри объекта и не требует выделения памяти */
+    static constexpr size_t INLINE_ROADS = 4;
+    using Roads = boost::container::small_vector<size_t, INLINE_ROADS>;
+
+    void AddHorizontal(Coord y, Coord x0, Coord x1, size_t road_idx) {
+        rows_.Add(y, x0, x1, road_idx);
+    }
+    void AddVertical(Coord x, Coord y0, Coord y1, size_t road_idx) {
+        columns_.Add(x, y0, y1, road_idx);
+    }
+
+    /* Индексы всех дорог, проходящих через точку (x, y): сначала горизонтальные, затем вертикальные */
+    Roads FindRoads(Coord x, Coord y) const;
+
+    /* Участок дороги road (лежит на строке y), содержащий x, на котором дорогу не пересекают
+     * и не перекрывают другие дороги. Если в точке x есть другие дороги, возвращается пустой участок */
+    Span FindFreeSpanOnRow(Coord y, const Interval& road, Coord x) const {
+        return FindFreeSpan(rows_, columns_, y, road, x);
+    }
+    /* То же для дороги road, лежащей на столбце x */
+    Span FindFreeSpanOnColumn(Coord x, const Interval& road, Coord y) const {
+        return FindFreeSpan(columns_, rows_, x, road, y);
+    }
+
+    const LineIndex& GetRows() const noexcept {
+        return rows_;
+    }
+    const LineIndex& GetColumns() const noexcept {
+        return columns_;
+    }
+
+    /* Освобождает запас памяти массивов после добавления всех дорог */
+    void ShrinkToFit() {
+        rows_.ShrinkToFit();
+        columns_.ShrinkToFit();
+    }
+    /* Память массивов индекса в куче, в байтах */
+    size_t GetMemoryUsage() const noexcept {
+        return rows_.GetMemoryUsage() + columns_.GetMemoryUsage();
+    }
+
+    template <typename Archive>
+        requires(!Archive::IS_LOADING)
+    void SerializeBundle(Archive& ar) const {
+        rows_.SerializeBundle(ar);
+        columns_.SerializeBundle(ar);
+    }
+    template <typename Archive>
+        requires Archive::IS_LOADING
+    void SerializeBundle(Archive& ar) {
+        rows_.SerializeBundle(ar);
+        columns_.SerializeBundle(ar);
+    }
+
+private:
+    static Span FindFreeSpan(const LineIndex& own, const LineIndex& cross,
+                             Coord key, const Interval& road, Coord pos);
+
+    LineIndex rows_;
+    LineIndex columns_;
+};
+
+} // namespace road_index
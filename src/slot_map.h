@@ -0,0 +1,160 @@
+/*
+ * Slot map - плотный массив значений с устойчивыми ключами.
+ * Значения лежат подряд (перебор без переходов по указателям), удаление переносит последнее значение
+ * на место удалённого. Ключ (номер ячейки и поколение) остаётся действительным, пока значение не удалено;
+ * ключ удалённого значения не совпадает с ключами новых значений в той же ячейке.
+ */
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+template <typename T>
+class SlotMap {
+public:
+    struct Key {
+        std::uint32_t slot = 0;
+        std::uint32_t generation = 0;
+
+        friend bool operator==(const Key&, const Key&) = default;
+    };
+
+    using Values = std::vector<T>;
+    using const_iterator = typename Values::const_iterator;
+
+    template <typename... Args>
+    Key Emplace(Args&&... args) {
+        values_.emplace_back(std::forward<Args>(args)...);
+        return BindSlot(values_.size() - 1);
+    }
+
+    /* Добавление пачкой: значения дописываются в конец одним переносом,
+     * ключ нового значения - GetKey(i) для i от прежнего size() */
+    void Append(Values values) {
+        values_.insert(values_.end(), std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+        value_slots_.reserve(values_.size());
+        for (size_t dense_idx = values_.size() - values.size(); dense_idx != values_.size(); ++dense_idx) {
+            BindSlot(dense_idx);
+        }
+    }
+
+    bool Contains(Key key) const noexcept {
+        return (key.slot < slots_.size()) && (slots_[key.slot].generation == key.generation) &&
+               (slots_[key.slot].dense_idx != NO_VALUE);
+    }
+
+    const T& operator[](Key key) const noexcept {
+        assert(Contains(key));
+        return values_[slots_[key.slot].dense_idx];
+    }
+
+    /* Индекс значения в плотном массиве, меняется при удалении других значений */
+    size_t GetIndex(Key key) const noexcept {
+        assert(Contains(key));
+        return slots_[key.slot].dense_idx;
+    }
+
+    /* Ключ значения с индексом dense_idx в плотном массиве */
+    Key GetKey(size_t dense_idx) const noexcept {
+        const std::uint32_t slot_idx = value_slots_[dense_idx];
+        return {slot_idx, slots_[slot_idx].generation};
+    }
+
+    /* Последнее значение переносится на место удалённого */
+    void Erase(Key key) noexcept {
+        assert(Contains(key));
+        Slot& slot = slots_[key.slot];
+        const size_t dense_idx = slot.dense_idx;
+        if (dense_idx + 1 != values_.size()) {
+            values_[dense_idx] = std::move(values_.back());
+            value_slots_[dense_idx] = value_slots_.back();
+            slots_[value_slots_[dense_idx]].dense_idx = dense_idx;
+        }
+        values_.pop_back();
+        value_slots_.pop_back();
+        slot.dense_idx = NO_VALUE;
+        ++slot.generation;
+        free_slots_.push_back(key.slot);
+    }
+
+    /* Ячейки сохраняются и становятся свободными, поэтому ключи удалённых значений
+     * не совпадают с ключами значений, добавленных после очистки */
+    void Clear() noexcept {
+        for (const std::uint32_t slot_idx : value_slots_) {
+            Slot& slot = slots_[slot_idx];
+            slot.dense_idx = NO_VALUE;
+            ++slot.generation;
+            free_slots_.push_back(slot_idx);
+        }
+        values_.clear();
+        value_slots_.clear();
+    }
+
+    /* Освобождает память значений. Ячейки с поколениями и список свободных ячеек остаются,
+     * чтобы ключи удалённых значений не совпали с ключами новых */
+    void ShrinkToFit() {
+        values_.shrink_to_fit();
+        value_slots_.shrink_to_fit();
+    }
+
+    void Reserve(size_t count) {
+        values_.reserve(count);
+        value_slots_.reserve(count);
+        slots_.reserve(count);
+        free_slots_.reserve(count);
+    }
+
+    size_t size() const noexcept {
+        return values_.size();
+    }
+    bool empty() const noexcept {
+        return values_.empty();
+    }
+    const_iterator begin() const noexcept {
+        return values_.begin();
+    }
+    const_iterator end() const noexcept {
+        return values_.end();
+    }
+    /* Значения подряд, в порядке добавления с учётом переносов при удалении */
+    const Values& GetValues() const noexcept {
+        return values_;
+    }
+
+private:
+    static constexpr size_t NO_VALUE = static_cast<size_t>(-1);
+
+    struct Slot {
+        size_t dense_idx = NO_VALUE;
+        std::uint32_t generation = 0;
+    };
+
+    /* Свободная ячейка (или новая) для значения, дописанного в конец values_ */
+    Key BindSlot(size_t dense_idx) {
+        std::uint32_t slot_idx = 0;
+        if (free_slots_.empty()) {
+            slot_idx = static_cast<std::uint32_t>(slots_.size());
+            slots_.push_back({});
+            /* Свободных ячеек не больше, чем всех, поэтому Erase() и Clear() не выделяют память */
+            free_slots_.reserve(slots_.capacity());
+        } else {
+            slot_idx = free_slots_.back();
+            free_slots_.pop_back();
+        }
+        Slot& slot = slots_[slot_idx];
+        slot.dense_idx = dense_idx;
+        value_slots_.push_back(slot_idx);
+        return {slot_idx, slot.generation};
+    }
+
+    Values values_;
+    std::vector<std::uint32_t> value_slots_; // ячейка каждого значения values_
+    std::vector<Slot> slots_;
+    std::vector<std::uint32_t> free_slots_;
+};
+
+} // namespace util
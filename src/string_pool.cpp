@@ -0,0 +1,58 @@
+#include "string_pool.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+namespace util {
+
+namespace {
+
+/* Поиск в пуле по std::string_view без создания временной std::string */
+struct StringHasher {
+    using is_transparent = void;
+    size_t operator()(std::string_view str) const noexcept {
+        return std::hash<std::string_view>{}(str);
+    }
+};
+
+/* Узлы unordered_set не перемещаются при росте таблицы, поэтому string_view на строки пула остаются верными */
+class StringPool {
+public:
+    std::string_view Intern(std::string_view str) {
+        std::lock_guard lock(mutex_);
+        auto it = strings_.find(str);
+        if (it == strings_.end()) {
+            it = strings_.emplace(str).first;
+            memory_ += sizeof(std::string) + it->capacity() + 1;
+        }
+        return *it;
+    }
+
+    size_t GetMemory() const {
+        std::lock_guard lock(mutex_);
+        return memory_;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_set<std::string, StringHasher, std::equal_to<>> strings_;
+    size_t memory_ = 0;
+};
+
+StringPool& GetPool() {
+    static StringPool pool;
+    return pool;
+}
+
+} // namespace
+
+std::string_view InternString(std::string_view str) {
+    return GetPool().Intern(str);
+}
+
+size_t GetInternedStringsMemory() {
+    return GetPool().GetMemory();
+}
+
+} // namespace util
@@ -0,0 +1,18 @@
+/*
+ * Общий пул неизменяемых строк процесса.
+ * Одинаковые строки всех карт (имена, файлы и цвета типов вещей) хранятся в пуле один раз,
+ * объекты модели держат на них std::string_view. Строки пула не удаляются до завершения процесса.
+ */
+#pragma once
+#include <cstddef>
+#include <string_view>
+
+namespace util {
+
+/* Строка пула, равная str (добавляется в пул при первом обращении). Потокобезопасна */
+std::string_view InternString(std::string_view str);
+
+/* Память, занятая строками пула, в байтах */
+size_t GetInternedStringsMemory();
+
+} // namespace util
@@ -4,9 +4,13 @@
 
 #include "../src/collision_detector.h"
 
+#include <algorithm>
 #include <cmath>
+#include <random>
+#include <span>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 using namespace collision_detector;
@@ -269,4 +273,231 @@ SCENARIO("Check FindGatheringEvents() function") {
             }
         }
     }
-}
\ No newline at end of file
+}
+SCENARIO("Fixed-point TryCollectPoint") {
+    using Catch::Matchers::WithinAbs;
+    using Catch::Matchers::WithinRel;
+
+    GIVEN("points on the 1/1024 grid") {
+        auto to_fixed = [](model::Position pos) {
+            return fixed_point::Point{fixed_point::FromDouble(pos.x), fixed_point::FromDouble(pos.y)};
+        };
+        const std::vector<model::Position> points = {{0., 0.}, {5.125, 0.}, {0., 6.25}, {10., 10.},
+                                                     {-0.3994140625, -0.4}, {12.9, -0.4}, {3., 3.0009765625}};
+
+        THEN("the integer kernel gives the same results as the double one") {
+            for (const model::Position& a : points) {
+                for (const model::Position& b : points) {
+                    if ((a.x == b.x) && (a.y == b.y)) {
+                        continue;
+                    }
+                    for (const model::Position& c : points) {
+                        const model::Position fa{fixed_point::ToDouble(to_fixed(a).x), fixed_point::ToDouble(to_fixed(a).y)};
+                        const model::Position fb{fixed_point::ToDouble(to_fixed(b).x), fixed_point::ToDouble(to_fixed(b).y)};
+                        const model::Position fc{fixed_point::ToDouble(to_fixed(c).x), fixed_point::ToDouble(to_fixed(c).y)};
+                        const CollectionResult expected = TryCollectPoint(fa, fb, fc);
+                        const CollectionResult result = TryCollectPoint(to_fixed(a), to_fixed(b), to_fixed(c));
+                        CHECK_THAT(result.proj_ratio, WithinAbs(expected.proj_ratio, 1e-9));
+                        CHECK_THAT(result.sq_distance, WithinAbs(expected.sq_distance, 1e-6));
+                        CHECK(result.sq_distance >= 0.);
+                    }
+                }
+            }
+        }
+        THEN("gathering events are found in fixed-point mode") {
+            const std::vector<Gatherer> gas = {
+                Gatherer({10.0, 3.9}, {10.2, 3.9}, 0.5),
+                Gatherer({12.0, 3.9}, {10.0, 3.9}, 0.5),
+                Gatherer({10.0, 13.9}, {10.0, 3.9}, 0.5),
+                Gatherer({10.0, 3.9}, {10.0001, 3.9}, 0.5)}; // перемещение меньше 1/1024
+            const std::vector<Item> items = {Item(0, {10.0, 3.9}, 0), Item(1, {11.0, 4.2}, 1)};
+            TestFindGatherEvents tfge(items.size(), items, gas.size(), gas);
+            const auto result = FindGatherEvents(tfge, true);
+            const auto expected = FindGatherEvents(tfge);
+            REQUIRE(result.size() == expected.size() - 1);
+            CHECK(std::none_of(result.begin(), result.end(), [](const GatheringEvent& event) {
+                return event.gatherer_id == 3;
+            }));
+        }
+    }
+}
+SCENARIO("Grid broad phase") {
+    GIVEN("many items and gatherers with short, long and diagonal moves") {
+        std::mt19937 gen(20241013);
+        std::uniform_real_distribution<double> coord(-20., 20.);
+        std::uniform_real_distribution<double> step(-1.5, 1.5);
+        std::uniform_int_distribution<int> kind(0, 9);
+        std::vector<Item> items;
+        for (size_t i = 0; i != 500; ++i) {
+            // часть предметов - на целых координатах дорог и с радиусом, как у офисов
+            if (kind(gen) < 5) {
+                items.emplace_back(i, model::Position{std::round(coord(gen)), std::round(coord(gen))}, i,
+                                   kind(gen) < 3 ? model::LostObject::OFFICE_HALF_WIDTH : 0.);
+            } else {
+                items.emplace_back(i, model::Position{coord(gen), coord(gen)}, i);
+            }
+        }
+        std::vector<Gatherer> gatherers;
+        for (size_t i = 0; i != 300; ++i) {
+            const model::Position start{coord(gen), coord(gen)};
+            model::Position end = start;
+            switch (kind(gen)) {
+            case 0:
+                break; // стоит на месте
+            case 1:
+                end = {coord(gen), coord(gen)}; // через всю карту
+                break;
+            case 2:
+            case 3:
+                end.x += step(gen);
+                end.y += step(gen);
+                break;
+            default:
+                (kind(gen) < 5 ? end.x : end.y) += step(gen);
+            }
+            gatherers.push_back({start, end, model::LostObject::GATHERER_HALF_WIDTH});
+        }
+        TestFindGatherEvents provider(items.size(), items, gatherers.size(), gatherers);
+
+        THEN("the grid finds the same events in the same order as the brute force") {
+            for (const bool fixed_point : {false, true}) {
+                const auto expected = FindGatherEvents(provider, fixed_point, BroadPhase::NONE);
+                const auto result = FindGatherEvents(provider, fixed_point, BroadPhase::GRID);
+                REQUIRE(!expected.empty());
+                REQUIRE(result.size() == expected.size());
+                for (size_t i = 0; i != result.size(); ++i) {
+                    CHECK(result[i].item_id == expected[i].item_id);
+                    CHECK(result[i].gatherer_id == expected[i].gatherer_id);
+                    CHECK(result[i].sq_distance == expected[i].sq_distance);
+                    CHECK(result[i].time == expected[i].time);
+                }
+            }
+        }
+        THEN("streaming processing takes the same items as processing the sorted events") {
+            std::vector<model::Position> positions;
+            std::vector<double> widths;
+            for (const Item& item : items) {
+                positions.push_back(item.GetPosition());
+                widths.push_back(item.GetWidth());
+            }
+            // рюкзак на 2 предмета, каждый пятый собиратель уже с полным рюкзаком
+            class Handler : public GatherEventHandler {
+            public:
+                explicit Handler(size_t gatherers_count)
+                    : bags_(gatherers_count) {
+                    for (size_t g_idx = 0; g_idx < gatherers_count; g_idx += 5) {
+                        bags_[g_idx] = 2;
+                    }
+                }
+                bool IsGathererActive(size_t gatherer_idx) const override {
+                    return bags_[gatherer_idx] < 2;
+                }
+                GatherDecision OnEvent(const GatheringEvent& event) override {
+                    REQUIRE(IsGathererActive(event.gatherer_id));
+                    taken.push_back(event);
+                    return (++bags_[event.gatherer_id] < 2) ? GatherDecision::TAKE : GatherDecision::TAKE_AND_STOP;
+                }
+
+                std::vector<GatheringEvent> taken;
+
+            private:
+                std::vector<size_t> bags_;
+            };
+
+            for (const bool fixed_point : {false, true}) {
+                Handler expected(gatherers.size());
+                std::vector<bool> item_taken(items.size(), false);
+                for (const GatheringEvent& event : FindGatherEvents(positions, widths, gatherers, fixed_point)) {
+                    if (!item_taken[event.item_id] && expected.IsGathererActive(event.gatherer_id)) {
+                        item_taken[event.item_id] = true;
+                        expected.OnEvent(event);
+                    }
+                }
+                Handler handler(gatherers.size());
+                ProcessGatherEvents(positions, widths, gatherers, handler, fixed_point);
+                REQUIRE(!expected.taken.empty());
+                REQUIRE(handler.taken.size() == expected.taken.size());
+                for (size_t i = 0; i != handler.taken.size(); ++i) {
+                    CHECK(handler.taken[i].item_id == expected.taken[i].item_id);
+                    CHECK(handler.taken[i].gatherer_id == expected.taken[i].gatherer_id);
+                    CHECK(handler.taken[i].time == expected.taken[i].time);
+                }
+            }
+        }
+        THEN("the array overload finds the same events as the provider") {
+            std::vector<model::Position> positions;
+            std::vector<double> widths;
+            for (const Item& item : items) {
+                positions.push_back(item.GetPosition());
+                widths.push_back(item.GetWidth());
+            }
+            for (const bool fixed_point : {false, true}) {
+                for (const BroadPhase broad_phase : {BroadPhase::NONE, BroadPhase::GRID}) {
+                    const auto expected = FindGatherEvents(provider, fixed_point, broad_phase);
+                    const auto result = FindGatherEvents(positions, widths, gatherers, fixed_point, broad_phase);
+                    REQUIRE(result.size() == expected.size());
+                    for (size_t i = 0; i != result.size(); ++i) {
+                        CHECK(result[i].item_id == expected[i].item_id);
+                        CHECK(result[i].gatherer_id == expected[i].gatherer_id);
+                        CHECK(result[i].time == expected[i].time);
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Batch TryCollectPoints") {
+    GIVEN("moves and arrays of points, some of them on the border of the collect area") {
+        std::mt19937 gen(20241016);
+        std::uniform_real_distribution<double> coord(-5., 5.);
+        std::uniform_int_distribution<int> kind(0, 3);
+        std::vector<model::Position> points;
+        std::vector<double> widths;
+        for (size_t i = 0; i != 1003; ++i) {
+            switch (kind(gen)) {
+            case 0: // на целых координатах: концы перемещения и граница радиуса
+                points.push_back({std::round(coord(gen)), std::round(coord(gen) / 5.)});
+                break;
+            default:
+                points.push_back({coord(gen), coord(gen) / 5.});
+            }
+            widths.push_back(kind(gen) == 0 ? 0. : model::LostObject::ITEM_HALF_WIDTH);
+        }
+        const std::vector<std::pair<model::Position, model::Position>> moves = {
+            {{-3., 0.}, {3., 0.}}, {{2., 0.}, {-2., 0.}}, {{0., -4.}, {0., 4.}}, {{-4., -1.}, {3.5, 0.7}},
+            {{1., 0.}, {1.0009765625, 0.}}};
+
+        THEN("every supported kernel finds the same points with bit-identical results") {
+            for (const BatchKernel kernel : {BatchKernel::SCALAR, BatchKernel::SSE2, BatchKernel::AVX2, BatchKernel::AUTO}) {
+                if (!IsBatchKernelSupported(kernel)) {
+                    continue;
+                }
+                for (const auto& [a, b] : moves) {
+                    for (const size_t count : {size_t{0}, size_t{1}, size_t{3}, size_t{5}, size_t{7}, points.size()}) {
+                        const std::span<const model::Position> part(points.data(), count);
+                        const std::span<const double> part_widths(widths.data(), count);
+                        CollectionHits expected;
+                        for (size_t idx = 0; idx != count; ++idx) {
+                            const CollectionResult result = TryCollectPoint(a, b, points[idx]);
+                            if (result.IsCollected(model::LostObject::GATHERER_HALF_WIDTH + widths[idx])) {
+                                expected.indices.push_back(idx);
+                                expected.results.push_back(result);
+                            }
+                        }
+                        CollectionHits hits;
+                        TryCollectPoints(a, b, part, part_widths, model::LostObject::GATHERER_HALF_WIDTH, hits, kernel);
+                        REQUIRE(hits.indices == expected.indices);
+                        for (size_t hit = 0; hit != hits.results.size(); ++hit) {
+                            CHECK(hits.results[hit].sq_distance == expected.results[hit].sq_distance);
+                            CHECK(hits.results[hit].proj_ratio == expected.results[hit].proj_ratio);
+                        }
+                        if (count == points.size()) {
+                            CHECK(!hits.indices.empty());
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,30 @@
+/*
+ * Карта-сетка для тестов и замеров: size горизонтальных и size вертикальных дорог с шагом step,
+ * от (0, 0) до ((size - 1) * step, (size - 1) * step), дороги пересекаются в size x size перекрёстках.
+ */
+#pragma once
+#include "../src/model.h"
+
+#include <string>
+
+namespace grid_map {
+
+inline model::Map::Roads MakeGridRoads(int size, int step) {
+    const int length = (size - 1) * step;
+    model::Map::Roads roads;
+    roads.reserve(2 * static_cast<size_t>(size));
+    for (int i = 0; i != size; ++i) {
+        roads.emplace_back(model::Road::HORIZONTAL, model::Point{0, i * step}, length);
+        roads.emplace_back(model::Road::VERTICAL, model::Point{i * step, 0}, length);
+    }
+    return roads;
+}
+
+/* Карта "grid" без предметов и офисов, дороги добавлены одним AddRoads() */
+inline model::Map MakeGridMap(int size, int step, double speed = 3.) {
+    model::Map map(model::Map::Id{std::string{"grid"}}, std::string{"Grid"}, speed);
+    map.AddRoads(MakeGridRoads(size, step));
+    return map;
+}
+
+} // namespace grid_map
@@ -0,0 +1,74 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/inline_vector.h"
+
+#include <utility>
+#include <vector>
+
+SCENARIO("Inline vector") {
+    using Values = util::InlineVector<int, 3>;
+
+    GIVEN("a vector with values that fit inline") {
+        Values values;
+        values.PushBack(1);
+        values.PushBack(2);
+        values.PushBack(3);
+
+        THEN("the values are stored inside the object") {
+            CHECK(values.IsInline());
+            CHECK(values.size() == 3);
+            CHECK(std::vector<int>(values.begin(), values.end()) == std::vector{1, 2, 3});
+        }
+        WHEN("some values are erased") {
+            values.EraseIf([](int value) {
+                return value % 2 == 1;
+            });
+
+            THEN("the rest keep their order") {
+                CHECK(values.size() == 1);
+                CHECK(values[0] == 2);
+            }
+        }
+        WHEN("the vector is cleared") {
+            values.Clear();
+
+            THEN("it is empty and still inline") {
+                CHECK(values.empty());
+                CHECK(values.IsInline());
+            }
+        }
+        WHEN("one more value is added") {
+            values.PushBack(4);
+
+            THEN("the values move to the heap in the same order") {
+                CHECK(!values.IsInline());
+                CHECK(std::vector<int>(values.begin(), values.end()) == std::vector{1, 2, 3, 4});
+            }
+            AND_WHEN("the vector is cleared and filled again") {
+                const int* data = values.data();
+                values.Clear();
+                for (int value = 0; value != 4; ++value) {
+                    values.PushBack(value);
+                }
+
+                THEN("the heap memory is reused") {
+                    CHECK(values.data() == data);
+                    CHECK(values.size() == 4);
+                }
+            }
+            THEN("a move takes the heap memory and leaves an empty inline vector") {
+                const int* data = values.data();
+                Values moved = std::move(values);
+                CHECK(moved.data() == data);
+                CHECK(moved.size() == 4);
+                CHECK(values.empty());
+                CHECK(values.IsInline());
+            }
+            THEN("copies compare equal") {
+                const Values copy = values;
+                CHECK(copy == values);
+                CHECK(!(copy == Values(values.begin(), values.begin() + 3)));
+            }
+        }
+    }
+}
@@ -0,0 +1,173 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/json_loader.h"
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+boost::json::object PrepareMapJson(const std::string& id) {
+    boost::json::object map;
+    map["id"] = id;
+    map["name"] = "Map " + id;
+    map["lootTypes"] = boost::json::array{
+        boost::json::object{{"name", "key"}, {"file", "assets/key.obj"}, {"type", "obj"},
+                            {"rotation", 90}, {"color", "#338844"}, {"scale", 0.03}, {"value", 10}}};
+    map["roads"] = boost::json::array{
+        boost::json::object{{"x0", 0}, {"y0", 0}, {"x1", 40}},
+        boost::json::object{{"x0", 40}, {"y0", 0}, {"y1", 30}}};
+    map["buildings"] = boost::json::array{
+        boost::json::object{{"x", 5}, {"y", 5}, {"w", 30}, {"h", 20}}};
+    map["offices"] = boost::json::array{
+        boost::json::object{{"id", "o0"}, {"x", 40}, {"y", 30}, {"offsetX", 5}, {"offsetY", 0}}};
+    return map;
+}
+
+boost::json::object PrepareConfigJson(const boost::json::array& maps) {
+    boost::json::object config;
+    config["defaultDogSpeed"] = 3.0;
+    config["lootGeneratorConfig"] = boost::json::object{{"period", 5.0}, {"probability", 0.5}};
+    config["maps"] = maps;
+    return config;
+}
+
+/* Конфигурация во временном файле, удаляется вместе с объектом */
+class TempConfig {
+public:
+    explicit TempConfig(const boost::json::object& config)
+        : path_(std::filesystem::temp_directory_path() / "json_loader_test.json") {
+        std::ofstream file(path_, std::ios::out | std::ios::trunc);
+        file << boost::json::serialize(config);
+    }
+    ~TempConfig() {
+        std::filesystem::remove(path_);
+    }
+    const std::filesystem::path& GetPath() const noexcept {
+        return path_;
+    }
+
+private:
+    std::filesystem::path path_;
+};
+
+std::string LoadGameError(const std::filesystem::path& path) {
+    try {
+        json_loader::LoadGame(path);
+    } catch (const std::exception& ex) {
+        return ex.what();
+    }
+    return {};
+}
+
+std::string LoadMapError(const boost::json::value& map_value) {
+    try {
+        json_loader::LoadMap(map_value, 1., model::DEFAULT_BAG_CAPACITY);
+    } catch (const std::exception& ex) {
+        return ex.what();
+    }
+    return {};
+}
+
+} // namespace
+
+SCENARIO("Game config loading") {
+    GIVEN("a config with many valid maps") {
+        const size_t maps_count = 16;
+        boost::json::array maps;
+        for (size_t i = 0; i != maps_count; ++i) {
+            maps.emplace_back(PrepareMapJson("map"s + std::to_string(i)));
+        }
+        const TempConfig config(PrepareConfigJson(maps));
+
+        WHEN("the game is loaded") {
+            json_loader::LoadTimes times;
+            const model::Game game = json_loader::LoadGame(config.GetPath(), &times);
+
+            THEN("the maps are added in config order") {
+                REQUIRE(game.GetMaps().size() == maps_count);
+                for (size_t i = 0; i != maps_count; ++i) {
+                    CHECK(*game.GetMaps()[i].GetId() == "map"s + std::to_string(i));
+                }
+            }
+            THEN("the build time is reported for each map") {
+                CHECK(times.maps.size() == maps_count);
+            }
+        }
+    }
+
+    GIVEN("a road without x1") {
+        boost::json::object map = PrepareMapJson("map0"s);
+        map["roads"] = boost::json::array{boost::json::object{{"x0", 10}, {"y0", 0}, {"y1", 20}}};
+        const TempConfig config(PrepareConfigJson(boost::json::array{map}));
+
+        WHEN("the game is loaded") {
+            const model::Game game = json_loader::LoadGame(config.GetPath());
+
+            THEN("the road is vertical") {
+                REQUIRE(game.GetMaps().size() == 1);
+                REQUIRE(game.GetMaps()[0].GetRoads().size() == 1);
+                const model::Road& road = game.GetMaps()[0].GetRoads()[0];
+                CHECK(road.IsVertical());
+                CHECK(road.GetStart().x == 10);
+                CHECK(road.GetStart().y == 0);
+                CHECK(road.GetEnd().x == 10);
+                CHECK(road.GetEnd().y == 20);
+            }
+        }
+    }
+
+    GIVEN("a config where maps 2 and 3 are malformed") {
+        boost::json::array maps;
+        for (size_t i = 0; i != 6; ++i) {
+            maps.emplace_back(PrepareMapJson("map"s + std::to_string(i)));
+        }
+        // ошибки разного вида, чтобы различать, какая из них выброшена
+        maps[1].as_object()["name"] = 42;
+        maps[2].as_object().erase("offices");
+        const TempConfig config(PrepareConfigJson(maps));
+
+        const std::string map2_error = LoadMapError(maps[1]);
+        const std::string map3_error = LoadMapError(maps[2]);
+        REQUIRE(!map2_error.empty());
+        REQUIRE(!map3_error.empty());
+        REQUIRE(map2_error != map3_error);
+
+        WHEN("the game is loaded repeatedly") {
+            THEN("the error of map 2 is thrown every time") {
+                for (int i = 0; i != 20; ++i) {
+                    CHECK(LoadGameError(config.GetPath()) == map2_error);
+                }
+            }
+        }
+    }
+
+    GIVEN("a config with an empty maps array") {
+        const TempConfig config(PrepareConfigJson(boost::json::array{}));
+
+        WHEN("the game is loaded") {
+            json_loader::LoadTimes times;
+            const model::Game game = json_loader::LoadGame(config.GetPath(), &times);
+
+            THEN("the game has no maps") {
+                CHECK(game.GetMaps().empty());
+                CHECK(times.maps.empty());
+            }
+        }
+    }
+
+    GIVEN("a config without maps") {
+        boost::json::object config_json = PrepareConfigJson(boost::json::array{});
+        config_json.erase("maps");
+        const TempConfig config(config_json);
+
+        THEN("loading throws") {
+            CHECK_THROWS(json_loader::LoadGame(config.GetPath()));
+        }
+    }
+}
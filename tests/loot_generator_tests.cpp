@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 #include <catch2/catch_test_macros.hpp>
 
@@ -72,3 +73,90 @@ SCENARIO("Loot generation") {
         }
     }
 }
+
+SCENARIO("Loot spawn deadline") {
+    using loot_gen::LootGenerator;
+    using TimeInterval = LootGenerator::TimeInterval;
+
+    GIVEN("a loot generator which counts random draws") {
+        size_t draws = 0;
+        LootGenerator gen{1s, 0.5, [&draws] {
+                              ++draws;
+                              return 1.;
+                          }};
+
+        THEN("loot never appears without shortage or probability") {
+            CHECK(gen.GetSpawnDeadline(0) == TimeInterval::max());
+            LootGenerator never{1s, 0.};
+            CHECK(never.GetSpawnDeadline(5) == TimeInterval::max());
+        }
+        WHEN("time without loot is before the deadline") {
+            CHECK(gen.GetSpawnDeadline(1) < 1s);
+            CHECK(gen.GetSpawnDeadline(1) > 990ms);
+            const unsigned generated = gen.Generate(500ms, 0, 1);
+
+            THEN("nothing is generated and no random value is drawn") {
+                CHECK(generated == 0);
+                CHECK(draws == 0);
+                CHECK(gen.GetTimeWithoutLoot() == 500ms);
+            }
+            AND_WHEN("the deadline is reached") {
+                const unsigned next = gen.Generate(500ms, 0, 1);
+
+                THEN("loot is generated as before") {
+                    CHECK(next == 1);
+                    CHECK(draws == 1);
+                    CHECK(gen.GetTimeWithoutLoot() == 0ms);
+                }
+            }
+        }
+        WHEN("settings change") {
+            const TimeInterval deadline = gen.GetSpawnDeadline(1);
+            gen.SetLootPeriod(2s);
+
+            THEN("the deadline is recomputed") {
+                CHECK(gen.GetSpawnDeadline(1) > deadline);
+                gen.SetLootProbability(1.);
+                CHECK(gen.GetSpawnDeadline(1) == 0ms);
+            }
+        }
+    }
+
+    GIVEN("generators with different settings") {
+        /* Generate() без срока, как до его появления */
+        const auto reference = [](TimeInterval base_interval, double probability, double random,
+                                  TimeInterval time_without_loot, unsigned loot_shortage) {
+            const double ratio = std::chrono::duration<double>{time_without_loot} / base_interval;
+            const double spawn_probability
+                = std::clamp((1.0 - std::pow(1.0 - probability, ratio)) * random, 0.0, 1.0);
+            return static_cast<unsigned>(std::round(loot_shortage * spawn_probability));
+        };
+
+        THEN("the deadline never changes the number of generated loot") {
+            for (const TimeInterval base_interval : {TimeInterval{100}, TimeInterval{1000}, TimeInterval{5000}}) {
+                for (const double probability : {0.01, 0.25, 0.5, 0.9, 0.999}) {
+                    for (const double random : {0.3, 1.}) {
+                        for (unsigned looters = 1; looters != 8; ++looters) {
+                            LootGenerator gen{base_interval, probability, [random] {
+                                                  return random;
+                                              }};
+                            TimeInterval time_without_loot{};
+                            for (int tick = 0; tick != 200; ++tick) {
+                                const TimeInterval tick_time{7 + tick % 13};
+                                time_without_loot += tick_time;
+                                const unsigned expected = reference(base_interval, probability, random,
+                                                                    time_without_loot, looters);
+                                INFO("base: " << base_interval.count() << ", probability: " << probability
+                                     << ", random: " << random << ", looters: " << looters << ", tick: " << tick);
+                                REQUIRE(gen.Generate(tick_time, 0, looters) == expected);
+                                if (expected > 0) {
+                                    time_without_loot = {};
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,174 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/map_bundle.h"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+model::Map PrepareRandomMap(std::mt19937& gen, const std::string& id, size_t roads_count) {
+    model::Map::Roads roads;
+    std::uniform_int_distribution<int> coord(0, 40);
+    std::uniform_int_distribution<int> length(-10, 10);
+    std::uniform_int_distribution<int> direction(0, 1);
+    for (size_t i = 0; i != roads_count; ++i) {
+        const model::Point start{coord(gen), coord(gen)};
+        if (direction(gen) == 0) {
+            roads.emplace_back(model::Road::HORIZONTAL, start, start.x + length(gen));
+        } else {
+            roads.emplace_back(model::Road::VERTICAL, start, start.y + length(gen));
+        }
+    }
+    model::Map map(model::Map::Id{id}, "Map "s + id, 2.5, 4);
+    map.AddRoads(roads);
+    map.AddBuilding(model::Building{model::Rectangle{{5, 5}, {30, 20}}});
+    map.AddOffice({model::Office::Id{"o0"s}, roads.front().GetStart(), {5, 0}});
+    map.AddLootType(model::LootType{"key"sv, "assets/key.obj"sv, "obj"sv, 90, "#338844"sv, 0.03, 10});
+    map.AddLootType(model::LootType{"wallet"sv, "assets/wallet.obj"sv, "obj"sv, std::nullopt, std::nullopt, 0.01, 30});
+    map.Freeze();
+    return map;
+}
+
+/* Набор в выровненном буфере, как в отображённом файле */
+std::vector<std::uint64_t> MakeBundle(const model::Game& game, size_t& size) {
+    std::stringstream stream;
+    map_bundle::WriteBundle(stream, game);
+    const std::string bytes = stream.str();
+    size = bytes.size();
+    std::vector<std::uint64_t> buffer((bytes.size() + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+    std::memcpy(buffer.data(), bytes.data(), bytes.size());
+    return buffer;
+}
+
+const char* Data(const std::vector<std::uint64_t>& buffer) {
+    return reinterpret_cast<const char*>(buffer.data());
+}
+
+} // namespace
+
+SCENARIO("Map bundle") {
+    GIVEN("a game with two maps") {
+        std::mt19937 gen(20241010);
+        model::Game game;
+        game.GetLootGenerator().SetLootPeriod(2500ms);
+        game.GetLootGenerator().SetLootProbability(0.25);
+        game.SetDogRetirementTime(42.);
+        game.SetMaxDogsPerSession(50);
+        game.AddMap(PrepareRandomMap(gen, "first"s, 60));
+        game.AddMap(PrepareRandomMap(gen, "second"s, 30));
+
+        size_t size = 0;
+        const std::vector<std::uint64_t> bundle = MakeBundle(game, size);
+
+        WHEN("the game is loaded from the bundle") {
+            const model::Game loaded = map_bundle::LoadBundle(Data(bundle), size);
+
+            THEN("the settings and the map objects are the same") {
+                CHECK(loaded.GetLootGenerator().GetLootPeriod() == 2500ms);
+                CHECK(loaded.GetLootGenerator().GetLootProbability() == 0.25);
+                CHECK(loaded.GetDogRetirementTime() == 42.);
+                CHECK(loaded.GetMaxDogsPerSession() == 50);
+                REQUIRE(loaded.GetMaps().size() == 2);
+                for (size_t i = 0; i != 2; ++i) {
+                    const model::Map& expected = game.GetMaps()[i];
+                    const model::Map& map = loaded.GetMaps()[i];
+                    CHECK(map.IsFrozen());
+                    CHECK(map.GetId() == expected.GetId());
+                    CHECK(map.GetName() == expected.GetName());
+                    CHECK(map.GetSpeed() == expected.GetSpeed());
+                    CHECK(map.GetBagCapacity() == expected.GetBagCapacity());
+                    REQUIRE(map.GetRoads().size() == expected.GetRoads().size());
+                    for (size_t r = 0; r != map.GetRoads().size(); ++r) {
+                        CHECK(map.GetRoads()[r].GetStart().x == expected.GetRoads()[r].GetStart().x);
+                        CHECK(map.GetRoads()[r].GetStart().y == expected.GetRoads()[r].GetStart().y);
+                        CHECK(map.GetRoads()[r].GetEnd().x == expected.GetRoads()[r].GetEnd().x);
+                        CHECK(map.GetRoads()[r].GetEnd().y == expected.GetRoads()[r].GetEnd().y);
+                    }
+                    REQUIRE(map.GetBuildings().size() == 1);
+                    CHECK(map.GetBuildings()[0].GetBounds().size.width == 30);
+                    REQUIRE(map.GetOffices().size() == 1);
+                    CHECK(*map.GetOffices()[0].GetId() == "o0"s);
+                    CHECK(map.GetOffices()[0].GetOffset().dx == 5);
+                    REQUIRE(map.GetOfficePositions().size() == 1);
+                    CHECK(map.GetOfficePositions()[0] == expected.GetOfficePositions()[0]);
+                    REQUIRE(map.GetLootTypesCount() == 2);
+                    CHECK(map.GetLootByIndex(0).GetFile() == "assets/key.obj"sv);
+                    CHECK(map.GetLootByIndex(0).GetRotation() == 90);
+                    CHECK(map.GetLootByIndex(0).GetColor() == "#338844"sv);
+                    CHECK(!map.GetLootByIndex(1).GetRotation().has_value());
+                    CHECK(!map.GetLootByIndex(1).GetColor().has_value());
+                    CHECK(map.GetLootByIndex(1).GetScores() == 30);
+                }
+            }
+            THEN("road lookups and dog moves on the loaded maps are the same") {
+                for (size_t i = 0; i != 2; ++i) {
+                    const model::Map& expected = game.GetMaps()[i];
+                    const model::Map& map = loaded.GetMaps()[i];
+                    CHECK(map.GetRoadGraph().GetSegments().size() == expected.GetRoadGraph().GetSegments().size());
+                    CHECK(map.GetRoadGraph().GetJunctions().size() == expected.GetRoadGraph().GetJunctions().size());
+                    for (int x = -12; x <= 52; ++x) {
+                        for (int y = -12; y <= 52; ++y) {
+                            const model::Position pos{static_cast<double>(x), static_cast<double>(y)};
+                            REQUIRE(map.GetRoadByPosition(pos) == expected.GetRoadByPosition(pos));
+                        }
+                    }
+                    const model::Velocity speeds[] = {{0., -2.5}, {0., 2.5}, {-2.5, 0.}, {2.5, 0.}};
+                    const model::Direction directions[] = {model::Direction::NORTH, model::Direction::SOUTH,
+                                                           model::Direction::WEST, model::Direction::EAST};
+                    for (const model::Road& road : expected.GetRoads()) {
+                        for (size_t d = 0; d != 4; ++d) {
+                            const model::Position start{static_cast<double>(road.GetStart().x),
+                                                        static_cast<double>(road.GetStart().y)};
+                            auto dog = std::make_shared<model::Dog>(0, "Rex"s, start);
+                            dog->SetState({start, speeds[d], directions[d]});
+                            REQUIRE(map.MoveDog(dog, 7.) == expected.MoveDog(dog, 7.));
+                        }
+                    }
+                }
+            }
+        }
+        WHEN("the loaded game is written again") {
+            const model::Game loaded = map_bundle::LoadBundle(Data(bundle), size);
+            size_t rewritten_size = 0;
+            const std::vector<std::uint64_t> rewritten = MakeBundle(loaded, rewritten_size);
+
+            THEN("the bundle is the same byte for byte") {
+                REQUIRE(rewritten_size == size);
+                CHECK(std::memcmp(Data(rewritten), Data(bundle), size) == 0);
+            }
+        }
+        WHEN("the bundle is written to a file and mapped") {
+            const std::filesystem::path path = std::filesystem::temp_directory_path() / "map_bundle_test.bundle";
+            map_bundle::WriteBundle(path, game);
+            const model::Game loaded = map_bundle::LoadBundle(path);
+            std::filesystem::remove(path);
+
+            THEN("the maps are loaded") {
+                REQUIRE(loaded.GetMaps().size() == 2);
+                CHECK(loaded.FindMap(model::Map::Id{"second"s}) != nullptr);
+                CHECK(loaded.GetMaps()[1].GetRoads().size() == 30);
+            }
+        }
+        WHEN("the bundle is truncated or built by another version") {
+            std::vector<std::uint64_t> other_version = bundle;
+            std::uint32_t version = map_bundle::VERSION + 1;
+            std::memcpy(reinterpret_cast<char*>(other_version.data()) + 8, &version, sizeof(version));
+
+            THEN("it is not loaded") {
+                CHECK_THROWS_AS(map_bundle::LoadBundle(Data(bundle), size - 8), std::runtime_error);
+                CHECK_THROWS_AS(map_bundle::LoadBundle(Data(bundle), size / 2), std::runtime_error);
+                CHECK_THROWS_AS(map_bundle::LoadBundle(Data(other_version), size), std::runtime_error);
+                CHECK_THROWS_AS(map_bundle::LoadBundle(Data(bundle), 0), std::runtime_error);
+            }
+        }
+    }
+}
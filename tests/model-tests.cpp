@@ -1,9 +1,15 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include "../src/model.h"
+#include "../src/collision_detector.h"
 #include "../src/game_session.h"
+#include "../src/players.h"
+#include "grid_map.h"
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
+#include <random>
 #include <string>
 #include <utility>
 #include <vector>
@@ -57,27 +63,744 @@ SCENARIO("Lost object generation") {
 
         WHEN("add lost object on game session") {
             model::Map map = PrepareMap(1);
-            model::GameSession game_session{&map};
+            model::GameSession game_session{&map, 0, gen};
             THEN("check add lost object") {
-                REQUIRE_NOTHROW(game_session.AddLostObjectsOnSession(gen, 10s));
+                REQUIRE_NOTHROW(game_session.AddLostObjectsOnSession(10s));
             }
         }
 
         WHEN("added lost object") {
             model::Map map = PrepareMap(10);
-            model::GameSession game_session{&map};
+            model::GameSession game_session{&map, 0, gen};
 	    model::Dog dog{1, "user 1"s, {0., 0.}};
-            auto dog_ptr = std::make_shared<model::Dog>(dog);
-            game_session.AddDog(dog_ptr->GetDogId());
+            game_session.AddDog(dog);
 
             THEN("check added lost object") {
-                game_session.AddLostObjectsOnSession(gen, 10s);
+                game_session.AddLostObjectsOnSession(10s);
                 const model::GameSession::LostObjects &lost_objects = game_session.GetLostObjects();
                 REQUIRE(lost_objects.size() >= 1);
-                CHECK((((lost_objects.back()->GetPosition().x - 0.) > 10e-6) ||
-                        ((lost_objects.back()->GetPosition().y - 0.) > 10e-6 )));
+                CHECK((((lost_objects.GetValues().back().GetPosition().x - 0.) > 10e-6) ||
+                        ((lost_objects.GetValues().back().GetPosition().y - 0.) > 10e-6 )));
             }
         }
     }
 
 }
+
+
+SCENARIO("Batch dog movement") {
+    GIVEN("a grid map and dogs moving in all directions") {
+        model::Map map = grid_map::MakeGridMap(6, 10);
+        const std::vector<std::pair<model::Direction, model::Velocity>> moves = {
+            {model::Direction::NORTH, {0., -3.}}, {model::Direction::SOUTH, {0., 3.}},
+            {model::Direction::WEST, {-3., 0.}}, {model::Direction::EAST, {3., 0.}},
+            {model::Direction::NORTH, {0., 0.}}};
+        std::vector<std::shared_ptr<model::Dog>> dogs;
+        model::DogsMovement movement;
+        for (size_t i = 0; i != 500; ++i) {
+            auto dog = std::make_shared<model::Dog>(i, "dog"s, map.GetRandomPositionOnRoads());
+            dog->SetVelocity(moves[i % moves.size()].second);
+            dog->SetDirection(moves[i % moves.size()].first);
+            dogs.push_back(dog);
+            movement.Add(dog->GetDogState());
+        }
+
+        WHEN("dogs are moved by ticks of different length") {
+            THEN("batch movement gives exactly the same states as MoveDog") {
+                for (double time : {0.05, 0.5, 2., 30.}) {
+                    model::DogsMovement batch = movement;
+                    map.MoveDogs(batch, time);
+                    REQUIRE(batch.Size() == dogs.size());
+                    for (size_t i = 0; i != dogs.size(); ++i) {
+                        INFO("dog " << i << ", time " << time);
+                        CHECK(batch.GetState(i) == map.MoveDog(dogs[i], time));
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Dog road cache") {
+    GIVEN("a grid map with a dead end and dogs changing directions") {
+        model::Map map = grid_map::MakeGridMap(5, 10);
+        map.AddRoad(model::Road{model::Road::HORIZONTAL, {20, 5}, 27});
+        const std::vector<std::pair<model::Direction, model::Velocity>> moves = {
+            {model::Direction::NORTH, {0., -3.}}, {model::Direction::SOUTH, {0., 3.}},
+            {model::Direction::WEST, {-3., 0.}}, {model::Direction::EAST, {3., 0.}},
+            {model::Direction::EAST, {0., 0.}}};
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<size_t> move_gen(0, moves.size() - 1);
+        std::uniform_real_distribution<double> time_gen(0.01, 2.);
+
+        auto cached = std::make_shared<model::Dog>(1, "cached"s, model::Position{20., 0.});
+        auto uncached = std::make_shared<model::Dog>(2, "uncached"s, model::Position{20., 0.});
+
+        WHEN("dogs are moved many ticks") {
+            THEN("the dog with cached road moves exactly as the dog which searches roads every tick") {
+                for (size_t tick = 0; tick != 5000; ++tick) {
+                    if (tick % 7 == 0) {
+                        const auto& [direction, velocity] = moves[move_gen(gen)];
+                        for (auto& dog : {cached, uncached}) {
+                            dog->SetDirection(direction);
+                            dog->SetVelocity(velocity);
+                        }
+                    }
+                    const double time = time_gen(gen);
+                    uncached->SetRoad({});
+                    cached->SetState(map.MoveDog(cached, time));
+                    uncached->SetState(map.MoveDog(uncached, time));
+                    INFO("tick " << tick);
+                    REQUIRE(cached->GetDogState() == uncached->GetDogState());
+                    const model::DogRoad& road = cached->GetRoad();
+                    CHECK(road.road == map.FindDogRoad(cached->GetDogState().position).road);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Seeded randomness") {
+    GIVEN("two games loaded with the same maps") {
+        model::Game game1;
+        model::Game game2;
+        for (model::Game* game : {&game1, &game2}) {
+            game->AddMap(PrepareMap(5));
+            game->AddMap(grid_map::MakeGridMap(10, 10));
+        }
+        auto sample = [](const model::Game& game) {
+            std::vector<std::pair<model::Position, size_t>> result;
+            for (const model::Map& map : game.GetMaps()) {
+                for (int i = 0; i != 100; ++i) {
+                    result.emplace_back(map.GetRandomPositionOnRoads(), map.GetRandomLootType());
+                }
+            }
+            return result;
+        };
+        auto tokens = []() {
+            players::PlayerTokens player_tokens;
+            std::vector<std::string> result;
+            for (int i = 0; i != 10; ++i) {
+                result.push_back(**player_tokens.AddPlayer(nullptr));
+            }
+            return result;
+        };
+        auto same = [](const auto& left, const auto& right) {
+            return std::equal(left.begin(), left.end(), right.begin(), right.end(),
+                              [](const auto& l, const auto& r) {
+                                  return (l.first == r.first) && (l.second == r.second);
+                              });
+        };
+
+        WHEN("both games get the same seed") {
+            game1.SetRandomSeed(2024);
+            game2.SetRandomSeed(2024);
+
+            THEN("spawn points and loot types repeat exactly") {
+                CHECK(same(sample(game1), sample(game2)));
+            }
+            THEN("player tokens don't depend on the seed") {
+                CHECK(tokens() != tokens());
+            }
+            THEN("moved token generators keep their random state") {
+                players::PlayerTokens first;
+                players::PlayerTokens second;
+                players::PlayerTokens moved_first(std::move(first));
+                players::PlayerTokens moved_second;
+                moved_second = std::move(second);
+                CHECK(**moved_first.AddPlayer(nullptr) != **moved_second.AddPlayer(nullptr));
+            }
+        }
+        WHEN("one of the seeded games reloads its maps") {
+            game1.SetRandomSeed(2024);
+            game2.SetRandomSeed(2024);
+            const auto before_reload = sample(game1);
+            model::Game::Maps maps;
+            maps.push_back(PrepareMap(5));
+            maps.push_back(grid_map::MakeGridMap(10, 10));
+            game1.ReplaceMaps(std::move(maps));
+            const auto after_reload = sample(game1);
+
+            THEN("the maps continue their sequences instead of restarting them") {
+                CHECK(same(before_reload, sample(game2)));
+                CHECK(same(after_reload, sample(game2)));
+                CHECK_FALSE(same(before_reload, after_reload));
+            }
+        }
+        WHEN("the games get different seeds") {
+            game1.SetRandomSeed(2024);
+            game2.SetRandomSeed(2025);
+
+            THEN("they generate different worlds") {
+                CHECK_FALSE(same(sample(game1), sample(game2)));
+            }
+        }
+    }
+}
+
+SCENARIO("Fixed-point movement") {
+    GIVEN("a grid map with a dead end in fixed-point mode") {
+        model::Map map = grid_map::MakeGridMap(5, 10);
+        map.AddRoad(model::Road{model::Road::HORIZONTAL, {20, 5}, 27});
+        model::Map double_map = map;
+        map.SetFixedPoint(true);
+
+        const std::vector<std::pair<model::Direction, model::Velocity>> moves = {
+            {model::Direction::NORTH, {0., -3.}}, {model::Direction::SOUTH, {0., 3.}},
+            {model::Direction::WEST, {-3., 0.}}, {model::Direction::EAST, {3., 0.}},
+            {model::Direction::EAST, {0., 0.}}};
+        std::mt19937 gen(7);
+        std::uniform_int_distribution<size_t> move_gen(0, moves.size() - 1);
+        std::uniform_real_distribution<double> time_gen(0.01, 2.);
+
+        WHEN("dogs are moved many ticks") {
+            auto dog = std::make_shared<model::Dog>(1, "fixed"s, model::Position{20., 0.});
+            model::DogsMovement batch;
+            batch.Add(dog->GetDogState());
+
+            THEN("positions stay on the 1/1024 grid, batch movement matches MoveDog "
+                 "and every step is within the fixed-point precision of the double mode") {
+                for (size_t tick = 0; tick != 3000; ++tick) {
+                    if (tick % 7 == 0) {
+                        const auto& [direction, velocity] = moves[move_gen(gen)];
+                        dog->SetDirection(direction);
+                        dog->SetVelocity(velocity);
+                        batch.SetState(0, dog->GetDogState());
+                    }
+                    const double time = time_gen(gen);
+                    auto reference = std::make_shared<model::Dog>(2, "double"s, dog->GetDogState().position);
+                    reference->SetState(dog->GetDogState());
+                    const model::DogState expected = double_map.MoveDog(reference, time);
+
+                    dog->SetState(map.MoveDog(dog, time));
+                    map.MoveDogs(batch, time);
+                    const model::DogState& state = dog->GetDogState();
+                    INFO("tick " << tick);
+                    REQUIRE(batch.GetState(0) == state);
+                    CHECK(state.position.x * 1024. == std::round(state.position.x * 1024.));
+                    CHECK(state.position.y * 1024. == std::round(state.position.y * 1024.));
+                    CHECK(std::abs(state.position.x - expected.position.x) < 2. / 1024.);
+                    CHECK(std::abs(state.position.y - expected.position.y) < 2. / 1024.);
+                    CHECK(state.velocity == expected.velocity);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Fixed-point road cells") {
+    GIVEN("positions at the road edges and just inside them") {
+        const std::vector<double> offsets = {-0.4, -0.39995, -0.3999, 0., 0.3999, 0.39995, 0.4};
+
+        WHEN("they are converted to fixed point") {
+            THEN("they stay in the road cell of the double mode within the fixed-point precision") {
+                for (const int k : {-7, -1, 0, 1, 7}) {
+                    for (const double offset : offsets) {
+                        const double pos = k + offset;
+                        const model::Coord cell = model::detail::RoundPosition(pos);
+                        const fixed_point::Fixed value = fixed_point::FromPosition(pos, cell);
+                        INFO("position " << pos);
+                        CHECK(cell == k);
+                        CHECK(fixed_point::ToCell(value) == cell);
+                        CHECK(std::abs(fixed_point::ToDouble(value) - pos) < 1. / 1024.);
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Frozen map") {
+    GIVEN("two maps with the same loot types, one of them frozen") {
+        model::Map map = PrepareMap(2);
+        model::Map other = PrepareMap(2);
+        auto dog = std::make_shared<model::Dog>(0, "Rex"s, model::Position{20., 0.});
+        dog->SetState({{20., 0.}, {4.5, 0.}, model::Direction::EAST});
+        const model::DogState before_freeze = map.MoveDog(dog, 3.);
+        const size_t memory_before_freeze = map.GetMemoryUsage();
+
+        map.Freeze();
+
+        THEN("the frozen map can't be changed") {
+            CHECK(map.IsFrozen());
+            CHECK_THROWS_AS(map.AddRoad(model::Road{model::Road::HORIZONTAL, {0, 50}, 10}), std::logic_error);
+            CHECK_THROWS_AS(map.AddBuilding(model::Building{model::Rectangle{{1, 1}, {2, 2}}}), std::logic_error);
+            CHECK_THROWS_AS(map.AddOffice({model::Office::Id{"o1"s}, {0, 0}, {1, 1}}), std::logic_error);
+            CHECK(map.GetRoads().size() == 4);
+        }
+        THEN("dogs move on it as before and it takes no more memory") {
+            CHECK(map.MoveDog(dog, 3.) == before_freeze);
+            CHECK(map.GetMemoryUsage() <= memory_before_freeze);
+        }
+        THEN("equal loot type strings of different maps are stored once") {
+            CHECK(map.GetLootByIndex(1).GetFile().data() == other.GetLootByIndex(1).GetFile().data());
+            CHECK(map.GetLootByIndex(1).GetColor()->data() == other.GetLootByIndex(1).GetColor()->data());
+            CHECK(map.GetLootByIndex(1).GetFile() == "11"sv);
+        }
+    }
+}
+
+namespace {
+
+class NullRepository : public players::ApplicationRepository {
+public:
+    void Save([[maybe_unused]] const players::Champion& result) override {}
+    std::vector<players::Champion> GetChampions([[maybe_unused]] size_t start,
+                                                [[maybe_unused]] size_t max_items) override {
+        return {};
+    }
+};
+
+} // namespace
+
+SCENARIO("Hot reload of maps") {
+    GIVEN("a game with a player on a map") {
+        model::Game game;
+        game.AddMap(PrepareMap(3));
+        NullRepository repository;
+        players::Application app(game, false, true, 0, std::nullopt, repository);
+        const players::JoinGameResult joined = app.JoinPlayerToGame(model::Map::Id{"map1"s}, "Rex"sv);
+        REQUIRE(joined.error == players::JoinGameErrorCode::NONE);
+        auto dog = app.GetDogById(joined.dog_id);
+        dog.SetState({{40., 10.}, {0., 4.5}, model::Direction::SOUTH});
+        dog.SetRoad(game.GetMaps()[0].FindDogRoad({40., 10.}));
+        dog.AddPickedObject(model::PickedObject{0, 2}, 3);
+        dog.AddPickedObject(model::PickedObject{1, 0}, 3);
+        auto session = game.GetSessions()[0];
+        std::vector<model::LostObject> lost_objects;
+        lost_objects.emplace_back(0, model::Position{10., 0.}, 2);
+        lost_objects.emplace_back(2, model::Position{20., 0.}, 3);
+        lost_objects.emplace_back(0, model::Position{40., 20.}, 4);
+        session->RestoreLostObjects(std::move(lost_objects), 5);
+
+        WHEN("the map is replaced by a smaller version and a new map is added") {
+            model::Map changed(model::Map::Id{"map1"s}, "Map 1"s, 3.);
+            changed.AddRoad(model::Road{model::Road::HORIZONTAL, {0, 0}, 40});
+            changed.AddLootType(model::LootType{"key"sv, "key.obj"sv, "obj"sv, std::nullopt, std::nullopt, 0.1, 5});
+            model::Map added(model::Map::Id{"map2"s}, "Map 2"s);
+            added.AddRoad(model::Road{model::Road::VERTICAL, {0, 0}, 10});
+            model::Game::Maps maps;
+            maps.push_back(std::move(added));
+            maps.push_back(std::move(changed));
+
+            const model::Game::Maps old_maps = app.ReloadMaps(std::move(maps));
+
+            THEN("the previous maps are returned and the session moves to the new version") {
+                REQUIRE(old_maps.size() == 1);
+                CHECK(old_maps[0].GetRoads().size() == 4);
+                REQUIRE(game.GetMaps().size() == 2);
+                const model::Map* map = game.FindMap(model::Map::Id{"map1"s});
+                REQUIRE(map != nullptr);
+                CHECK(map->GetRoads().size() == 1);
+                CHECK(session->GetMap() == map);
+                REQUIRE(game.GetSessions().size() == 1);
+                CHECK(game.GetSessions()[0] == session);
+                CHECK(game.PlacePlayerOnMap(model::Map::Id{"map1"s}) == session);
+            }
+            THEN("objects that don't fit the new map are removed") {
+                REQUIRE(session->GetLostObjects().size() == 1);
+                CHECK(session->GetLostObjects().begin()->GetId() == 2);
+                REQUIRE(dog.GetPickedObjects().size() == 1);
+                CHECK(dog.GetPickedObjects().front().GetId() == 1);
+            }
+            THEN("the dog left off the roads is moved onto a road and its road hint is rebuilt") {
+                CHECK(dog.GetDogState().position == model::Position{0., 0.});
+                CHECK(dog.GetDogState().velocity.IsZero());
+                const model::Map* map = session->GetMap();
+                CHECK(dog.GetRoad().road == map->FindDogRoad(dog.GetDogState().position).road);
+                app.SetDogAction(app.FindPlayerByToken(*joined.player_token), players::ActionMove::RIGHT);
+                app.MoveDogs(100.);
+                CHECK(dog.GetDogState().position.x == 40.4);
+            }
+        }
+        WHEN("the new maps don't contain the map with the player") {
+            model::Game::Maps maps;
+            maps.emplace_back(model::Map::Id{"map2"s}, "Map 2"s);
+
+            THEN("the maps are not replaced") {
+                CHECK_THROWS_AS(app.ReloadMaps(std::move(maps)), std::invalid_argument);
+                REQUIRE(game.GetMaps().size() == 1);
+                CHECK(session->GetMap() == &game.GetMaps()[0]);
+                CHECK(session->GetLostObjects().size() == 3);
+            }
+        }
+        WHEN("the reloaded config changes game settings") {
+            model::Game loaded;
+            loaded.GetLootGenerator() = game.GetLootGenerator();
+            loaded.SetDogRetirementTime(game.GetDogRetirementTime());
+
+            THEN("only the same settings are accepted") {
+                CHECK_NOTHROW(game.CheckReloadSettings(loaded));
+                loaded.SetMaxDogsPerSession(10);
+                CHECK_THROWS_AS(game.CheckReloadSettings(loaded), std::invalid_argument);
+                loaded.SetMaxDogsPerSession(game.GetMaxDogsPerSession());
+                loaded.SetDogRetirementTime(game.GetDogRetirementTime() + 1.);
+                CHECK_THROWS_AS(game.CheckReloadSettings(loaded), std::invalid_argument);
+                loaded.SetDogRetirementTime(game.GetDogRetirementTime());
+                loaded.GetLootGenerator().SetLootProbability(0.5);
+                CHECK_THROWS_AS(game.CheckReloadSettings(loaded), std::invalid_argument);
+            }
+        }
+    }
+}
+
+SCENARIO("Session instances") {
+    GIVEN("a game with a limit of two dogs per session") {
+        model::Game game;
+        game.AddMap(PrepareMap(2));
+        game.SetMaxDogsPerSession(2);
+        NullRepository repository;
+        players::Application app(game, false, true, 0, std::nullopt, repository);
+        std::vector<players::JoinGameResult> joined;
+        for (size_t i = 0; i != 5; ++i) {
+            joined.push_back(app.JoinPlayerToGame(model::Map::Id{"map1"s}, "dog"s + std::to_string(i)));
+            REQUIRE(joined.back().error == players::JoinGameErrorCode::NONE);
+        }
+
+        THEN("new instances open when the previous ones are full") {
+            REQUIRE(game.GetSessions().size() == 3);
+            for (size_t i = 0; i != 3; ++i) {
+                CHECK(game.GetSessions()[i]->GetInstanceId() == i);
+                CHECK(game.GetSessions()[i]->GetMap() == &game.GetMaps()[0]);
+            }
+            CHECK(game.GetSessions()[0]->CountDogsInSession() == 2);
+            CHECK(game.GetSessions()[1]->CountDogsInSession() == 2);
+            CHECK(game.GetSessions()[2]->CountDogsInSession() == 1);
+            const size_t expected_instances[] = {0, 0, 1, 1, 2};
+            for (size_t i = 0; i != joined.size(); ++i) {
+                CHECK(joined[i].instance_id == expected_instances[i]);
+            }
+        }
+        THEN("the players of an instance see only its dogs") {
+            const auto player = app.FindPlayerByToken(*joined[2].player_token);
+            const auto session_players = app.GetPlayersInSession(player);
+            REQUIRE(session_players.size() == 2);
+            CHECK(session_players[0]->GetId() == joined[2].dog_id);
+            CHECK(session_players[1]->GetId() == joined[3].dog_id);
+        }
+        WHEN("a dog leaves a full instance") {
+            game.GetSessions()[1]->DeleteDog(joined[3].dog_id);
+            const players::JoinGameResult next = app.JoinPlayerToGame(model::Map::Id{"map1"s}, "next"sv);
+            const players::JoinGameResult last = app.JoinPlayerToGame(model::Map::Id{"map1"s}, "last"sv);
+
+            THEN("joins go to the least loaded instance before a new one opens") {
+                CHECK(next.instance_id == 1);
+                CHECK(last.instance_id == 2);
+                CHECK(game.GetSessions().size() == 3);
+                CHECK(app.JoinPlayerToGame(model::Map::Id{"map1"s}, "new"sv).instance_id == 3);
+            }
+        }
+    }
+}
+
+SCENARIO("Session hibernation") {
+    GIVEN("a game where each tick drops loot for every dog") {
+        model::Game game;
+        game.AddMap(PrepareMap(2));
+        game.SetLootGenerator(1s, 1.);
+        game.SetDogRetirementTime(2.);
+        NullRepository repository;
+        players::Application app(game, false, true, 0, std::nullopt, repository);
+        REQUIRE(app.JoinPlayerToGame(model::Map::Id{"map1"s}, "Rex"sv).error == players::JoinGameErrorCode::NONE);
+        const auto session = game.GetSessions()[0];
+        app.MoveDogs(1.);
+        REQUIRE(session->CountLostObjects() == 1);
+        const model::GameSession::LostObjectKey first_object = session->GetLostObjects().GetKey(0);
+
+        THEN("the session with a dog is active") {
+            CHECK(!session->IsHibernated());
+            CHECK(session->CountLostObjects() == 1);
+            CHECK(game.CountActiveSessions() == 1);
+            CHECK(game.CountHibernatedSessions() == 0);
+        }
+        WHEN("the last dog retires") {
+            app.MoveDogs(1.5);
+
+            THEN("the session hibernates and releases its loot") {
+                CHECK(session->IsHibernated());
+                CHECK(session->CountLostObjects() == 0);
+                CHECK(session->GetLostObjects().GetValues().capacity() == 0);
+                CHECK(session->GetLastObjectId() == 1);
+                CHECK(game.CountActiveSessions() == 0);
+                CHECK(game.CountHibernatedSessions() == 1);
+            }
+            AND_WHEN("the game keeps ticking") {
+                app.MoveDogs(10.);
+
+                THEN("the hibernated session gets no loot") {
+                    CHECK(session->CountLostObjects() == 0);
+                    CHECK(session->GetLastObjectId() == 1);
+                }
+            }
+            AND_WHEN("a new player joins the map") {
+                const players::JoinGameResult joined = app.JoinPlayerToGame(model::Map::Id{"map1"s}, "Max"sv);
+                app.MoveDogs(1.);
+
+                THEN("the hibernated session wakes up instead of a new one") {
+                    CHECK(joined.instance_id == 0);
+                    REQUIRE(game.GetSessions().size() == 1);
+                    CHECK(!session->IsHibernated());
+                    CHECK(game.CountActiveSessions() == 1);
+                    REQUIRE(session->CountLostObjects() == 1);
+                    CHECK(session->GetLostObjects().GetValues()[0].GetId() == 1);
+                    CHECK(!session->GetLostObjects().Contains(first_object));
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Per-session loot generators") {
+    GIVEN("two instances of a map with one dog each") {
+        model::Game game;
+        game.AddMap(PrepareMap(2));
+        game.SetMaxDogsPerSession(1);
+        game.SetLootGenerator(1s, 0.5);
+        NullRepository repository;
+        players::Application app(game, false, true, 0, std::nullopt, repository);
+        for (const auto name : {"Rex"sv, "Max"sv}) {
+            REQUIRE(app.JoinPlayerToGame(model::Map::Id{"map1"s}, name).error == players::JoinGameErrorCode::NONE);
+        }
+        REQUIRE(game.GetSessions().size() == 2);
+
+        WHEN("the game ticks before the spawn deadline") {
+            app.MoveDogs(0.5);
+
+            THEN("each session counts its own time without loot") {
+                for (const auto& session : game.GetSessions()) {
+                    CHECK(session->GetLootGenerator().GetTimeWithoutLoot() == 500ms);
+                    CHECK(session->CountLostObjects() == 0);
+                }
+            }
+            AND_WHEN("the deadline is reached") {
+                app.MoveDogs(0.5);
+
+                THEN("every session spawns its loot") {
+                    for (const auto& session : game.GetSessions()) {
+                        CHECK(session->GetLootGenerator().GetTimeWithoutLoot() == 0ms);
+                        CHECK(session->CountLostObjects() == 1);
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Delivery to offices") {
+    GIVEN("a map with an office and a dog carrying loot") {
+        model::Game game;
+        model::Map map = PrepareMap(2);
+        map.AddOffice({model::Office::Id{"o0"s}, {20, 0}, {5, 0}});
+        map.AddOffice({model::Office::Id{"o1"s}, {40, 30}, {5, 0}});
+        game.AddMap(std::move(map));
+        NullRepository repository;
+        players::Application app(game, false, true, 0, std::nullopt, repository);
+        const players::JoinGameResult joined = app.JoinPlayerToGame(model::Map::Id{"map1"s}, "Rex"sv);
+        REQUIRE(joined.error == players::JoinGameErrorCode::NONE);
+        auto dog = app.GetDogById(joined.dog_id);
+        dog.SetState({{10., 0.}, {4.5, 0.}, model::Direction::EAST});
+        dog.SetRoad(game.GetMaps()[0].FindDogRoad({10., 0.}));
+        dog.AddPickedObject(model::PickedObject{0, 1}, 3);
+        dog.AddPickedObject(model::PickedObject{1, 0}, 3);
+
+        THEN("the office collision set is built once with the map") {
+            const model::Map& loaded = game.GetMaps()[0];
+            REQUIRE(loaded.GetOfficePositions().size() == 2);
+            CHECK(loaded.GetOfficePositions()[1] == model::Position{40., 30.});
+            CHECK(loaded.GetOfficeWidths()[0] == model::LostObject::OFFICE_HALF_WIDTH);
+        }
+        WHEN("the dog passes the office") {
+            app.MoveDogs(3.);
+
+            THEN("the loot is handed over and scored") {
+                CHECK(dog.IsBagEmpty());
+                CHECK(dog.GetScores() == 40);
+            }
+        }
+    }
+}
+
+SCENARIO("Session dogs in parallel arrays") {
+    GIVEN("a session with several dogs") {
+        model::Map map = PrepareMap(2);
+        model::GameSession session(&map);
+        std::vector<model::GameSession::DogHandle> handles;
+        for (size_t id = 0; id != 5; ++id) {
+            model::Dog dog(id, "dog"s + std::to_string(id), {10. * id, 0.});
+            dog.AddScores(id);
+            dog.AddPickedObject(model::PickedObject{id, 0}, 3);
+            handles.push_back(session.AddDog(std::move(dog)));
+        }
+
+        THEN("the dogs are stored in the order of addition with their road hints") {
+            CHECK(session.GetDogIds() == std::vector<size_t>{0, 1, 2, 3, 4});
+            CHECK(session.GetDog(handles[2]).GetRoad().road == map.FindDogRoad({20., 0.}).road);
+        }
+        WHEN("a dog in the middle is deleted") {
+            session.DeleteDog(1);
+            const model::SessionDogs& dogs = session.GetDogs();
+
+            THEN("the last dog takes its place and the other handles stay valid") {
+                CHECK(session.GetDogIds() == std::vector<size_t>{0, 4, 2, 3});
+                CHECK(!dogs.Contains(handles[1]));
+                CHECK(!session.FindDog(1));
+                for (const size_t id : {0, 2, 3, 4}) {
+                    const model::DogRef dog = session.GetDog(handles[id]);
+                    CHECK(dog.GetDogId() == id);
+                    CHECK(dog.GetDogName() == "dog"s + std::to_string(id));
+                    CHECK(dog.GetDogState().position == model::Position{10. * id, 0.});
+                    CHECK(dog.GetScores() == id);
+                    REQUIRE(dog.GetPickedObjects().size() == 1);
+                    CHECK(dog.GetPickedObjects()[0].GetId() == id);
+                    CHECK(session.FindDog(id) == handles[id]);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Dog bags") {
+    GIVEN("a session dog") {
+        model::Map map = PrepareMap(2);
+        model::GameSession session(&map);
+        session.AddDog(model::Dog(0, "Rex"s, {0., 0.}));
+        model::SessionDogs& dogs = session.GetDogs();
+
+        WHEN("the bag is filled up to the default capacity") {
+            for (size_t id = 0; id != model::DEFAULT_BAG_CAPACITY + 1; ++id) {
+                dogs.AddPickedObject(0, model::PickedObject{id, 1}, model::DEFAULT_BAG_CAPACITY);
+            }
+
+            THEN("the objects stay inside the bag") {
+                CHECK(dogs.GetBag(0).size() == model::DEFAULT_BAG_CAPACITY);
+                CHECK(dogs.GetBag(0).IsInline());
+            }
+            AND_WHEN("the bag is delivered") {
+                dogs.ClearBag(0);
+
+                THEN("it is empty") {
+                    CHECK(dogs.GetBag(0).empty());
+                }
+            }
+        }
+        WHEN("the map allows a larger bag") {
+            const size_t capacity = model::DEFAULT_BAG_CAPACITY * 2;
+            for (size_t id = 0; id != capacity + 1; ++id) {
+                CHECK(dogs.AddPickedObject(0, model::PickedObject{id, 1}, capacity) == (id < capacity));
+            }
+
+            THEN("the objects move to the heap in pickup order") {
+                REQUIRE(dogs.GetBag(0).size() == capacity);
+                CHECK(!dogs.GetBag(0).IsInline());
+                for (size_t id = 0; id != capacity; ++id) {
+                    CHECK(dogs.GetBag(0)[id].GetId() == id);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Road-indexed lost objects") {
+    GIVEN("a session on a map with a grid of roads and many lost objects") {
+        model::Map map = grid_map::MakeGridMap(11, 10, 1.);
+        map.AddLootType(model::LootType{"key"sv, "key.obj"sv, "obj"sv, std::nullopt, std::nullopt, 0.1, 5});
+
+        std::mt19937 gen(20241014);
+        std::uniform_int_distribution<int> line(0, 10);
+        std::uniform_real_distribution<double> along(0., 100.);
+        std::uniform_real_distribution<double> across(-0.4, 0.4);
+        auto random_road_position = [&]() {
+            const double line_pos = line(gen) * 10. + across(gen);
+            return (line(gen) % 2 == 0) ? model::Position{along(gen), line_pos} : model::Position{line_pos, along(gen)};
+        };
+
+        model::GameSession session(&map);
+        std::vector<model::LostObject> lost_objects;
+        size_t id = 0;
+        for (; id != 2000; ++id) {
+            lost_objects.emplace_back(0, random_road_position(), id, (id % 3 == 0) ? 0.3 : 0.);
+        }
+        // предметы вне дорог (например, восстановленные из сохранения для другой версии карты)
+        lost_objects.emplace_back(0, model::Position{5., 5.}, id++);
+        lost_objects.emplace_back(0, model::Position{-3., 50.}, id++);
+        session.RestoreLostObjects(std::move(lost_objects), id);
+
+        std::vector<collision_detector::Gatherer> gatherers;
+        for (size_t i = 0; i != 10; ++i) {
+            const model::Position start = random_road_position();
+            model::Position end = start;
+            (line(gen) % 2 == 0 ? end.x : end.y) += along(gen) / 4. - 12.5;
+            gatherers.push_back({start, end, 0.6});
+        }
+        gatherers.push_back({{5., 0.}, {5., 10.}, 0.6});
+        gatherers.push_back({{20., 20.}, {20., 20.}, 0.6});
+
+        WHEN("pickups are found among the nearby objects only") {
+            const std::vector<model::LostObject> all_items(session.GetLostObjects().begin(),
+                                                           session.GetLostObjects().end());
+            const std::vector<model::GameSession::LostObjectKey> nearby = session.FindLostObjectsNear(gatherers);
+            std::vector<model::LostObject> nearby_items;
+            for (const auto& key : nearby) {
+                nearby_items.push_back(session.GetLostObjects()[key]);
+            }
+
+            THEN("the objects are a subset of the session's objects in the same order") {
+                CHECK(nearby_items.size() < all_items.size() / 2);
+                CHECK(std::is_sorted(nearby_items.begin(), nearby_items.end(), [](const auto& left, const auto& right) {
+                    return left.GetId() < right.GetId();
+                }));
+            }
+            THEN("the gathering events are the same as with all the objects") {
+                auto to_arrays = [](const std::vector<model::LostObject>& items) {
+                    std::pair<std::vector<model::Position>, std::vector<double>> result;
+                    for (const auto& item : items) {
+                        result.first.push_back(item.GetPosition());
+                        result.second.push_back(item.GetWidth());
+                    }
+                    return result;
+                };
+                const auto [all_positions, all_widths] = to_arrays(all_items);
+                const auto [nearby_positions, nearby_widths] = to_arrays(nearby_items);
+                for (const bool fixed_point : {false, true}) {
+                    const auto expected = collision_detector::FindGatherEvents(all_positions, all_widths,
+                                                                               gatherers, fixed_point);
+                    const auto events = collision_detector::FindGatherEvents(nearby_positions, nearby_widths,
+                                                                             gatherers, fixed_point);
+                    REQUIRE(!expected.empty());
+                    REQUIRE(events.size() == expected.size());
+                    for (size_t i = 0; i != events.size(); ++i) {
+                        CHECK(nearby_items[events[i].item_id].GetId() == all_items[expected[i].item_id].GetId());
+                        CHECK(events[i].gatherer_id == expected[i].gatherer_id);
+                        CHECK(events[i].time == expected[i].time);
+                    }
+                }
+            }
+        }
+        WHEN("the nearby objects are removed") {
+            std::vector<model::GameSession::LostObjectKey> nearby = session.FindLostObjectsNear(gatherers);
+            const size_t count = session.CountLostObjects();
+            nearby.resize(nearby.size() / 2);
+            std::vector<size_t> removed_ids;
+            for (const auto& key : nearby) {
+                removed_ids.push_back(session.GetLostObjects()[key].GetId());
+            }
+            session.RemoveLostObjects(nearby);
+            const std::vector<model::GameSession::LostObjectKey> rest = session.FindLostObjectsNear(gatherers);
+
+            THEN("they are removed from the session and from the road buckets") {
+                CHECK(session.CountLostObjects() == count - removed_ids.size());
+                for (const auto& key : nearby) {
+                    CHECK(!session.GetLostObjects().Contains(key));
+                }
+                for (const auto& key : rest) {
+                    CHECK(std::find(removed_ids.begin(), removed_ids.end(),
+                                    session.GetLostObjects()[key].GetId()) == removed_ids.end());
+                }
+                std::vector<bool> remove_all(session.CountLostObjects(), true);
+                session.RemoveObjectsFromLost(remove_all);
+                CHECK(session.CountLostObjects() == 0);
+                CHECK(session.FindLostObjectsNear(gatherers).empty());
+            }
+        }
+    }
+}
@@ -0,0 +1,266 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include "../src/model.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <random>
+
+using namespace std::literals;
+
+namespace {
+
+/* Лежит ли точка на дороге заданного направления (перебор всех дорог карты) */
+bool OnRoadBruteForce(const model::Map& map, road_graph::Axis axis, int x, int y) {
+    return std::any_of(map.GetRoads().begin(), map.GetRoads().end(), [axis, x, y](const model::Road& road) {
+        if (road.IsHorizontal() != (axis == road_graph::Axis::HORIZONTAL)) {
+            return false;
+        }
+        return (x >= std::min(road.GetStart().x, road.GetEnd().x)) && (x <= std::max(road.GetStart().x, road.GetEnd().x)) &&
+               (y >= std::min(road.GetStart().y, road.GetEnd().y)) && (y <= std::max(road.GetStart().y, road.GetEnd().y));
+    });
+}
+
+/* Соединены ли соседние точки линии одной дорогой */
+bool LinkedBruteForce(const model::Map& map, road_graph::Axis axis, int x, int y) {
+    const int next_x = (axis == road_graph::Axis::HORIZONTAL) ? x + 1 : x;
+    const int next_y = (axis == road_graph::Axis::HORIZONTAL) ? y : y + 1;
+    return std::any_of(map.GetRoads().begin(), map.GetRoads().end(), [=](const model::Road& road) {
+        if (road.IsHorizontal() != (axis == road_graph::Axis::HORIZONTAL)) {
+            return false;
+        }
+        const int min_x = std::min(road.GetStart().x, road.GetEnd().x);
+        const int max_x = std::max(road.GetStart().x, road.GetEnd().x);
+        const int min_y = std::min(road.GetStart().y, road.GetEnd().y);
+        const int max_y = std::max(road.GetStart().y, road.GetEnd().y);
+        return (x >= min_x) && (next_x <= max_x) && (y >= min_y) && (next_y <= max_y);
+    });
+}
+
+model::Map PrepareRandomMap(std::mt19937& gen, size_t roads_count) {
+    model::Map::Roads roads;
+    std::uniform_int_distribution<int> coord(0, 30);
+    std::uniform_int_distribution<int> length(0, 8);
+    std::uniform_int_distribution<int> direction(0, 1);
+    for (size_t i = 0; i != roads_count; ++i) {
+        const model::Point start{coord(gen), coord(gen)};
+        if (direction(gen) == 0) {
+            roads.emplace_back(model::Road::HORIZONTAL, start, start.x + length(gen));
+        } else {
+            roads.emplace_back(model::Road::VERTICAL, start, start.y - length(gen));
+        }
+    }
+    model::Map map(model::Map::Id{"random"}, "Random map"s);
+    map.AddRoads(roads);
+    return map;
+}
+
+} // namespace
+
+SCENARIO("Road graph") {
+    GIVEN("a map with random touching and overlapping roads") {
+        std::mt19937 gen(20241003);
+        const model::Map map = PrepareRandomMap(gen, 80);
+        const road_graph::RoadGraph& graph = map.GetRoadGraph();
+
+        THEN("every road point lies on exactly one segment of its direction, extending as far as the roads do") {
+            for (const road_graph::Axis axis : {road_graph::Axis::HORIZONTAL, road_graph::Axis::VERTICAL}) {
+                for (int x = -1; x <= 40; ++x) {
+                    for (int y = -10; y <= 32; ++y) {
+                        const size_t segment_idx = graph.FindSegment(axis, x, y);
+                        REQUIRE((segment_idx != road_graph::RoadGraph::NO_SEGMENT) == OnRoadBruteForce(map, axis, x, y));
+                        if (segment_idx == road_graph::RoadGraph::NO_SEGMENT) {
+                            continue;
+                        }
+                        const road_graph::Segment& segment = graph.GetSegment(segment_idx);
+                        CHECK(segment.Contains(x, y));
+                        const bool horizontal = (axis == road_graph::Axis::HORIZONTAL);
+                        const int along = horizontal ? x : y;
+                        int end = along;
+                        while (LinkedBruteForce(map, axis, horizontal ? end : x, horizontal ? y : end)) {
+                            ++end;
+                        }
+                        int start = along;
+                        while (LinkedBruteForce(map, axis, horizontal ? start - 1 : x, horizontal ? y : start - 1)) {
+                            --start;
+                        }
+                        CHECK(segment.start == start);
+                        CHECK(segment.end == end);
+                    }
+                }
+            }
+        }
+        THEN("junctions are the points shared by a horizontal and a vertical segment") {
+            size_t junctions_count = 0;
+            for (int x = -1; x <= 40; ++x) {
+                for (int y = -10; y <= 32; ++y) {
+                    const size_t h = graph.FindSegment(road_graph::Axis::HORIZONTAL, x, y);
+                    const size_t v = graph.FindSegment(road_graph::Axis::VERTICAL, x, y);
+                    if ((h == road_graph::RoadGraph::NO_SEGMENT) || (v == road_graph::RoadGraph::NO_SEGMENT)) {
+                        CHECK(((h == road_graph::RoadGraph::NO_SEGMENT) ||
+                               (graph.FindJunction(h, x) == road_graph::RoadGraph::NO_JUNCTION)));
+                        continue;
+                    }
+                    ++junctions_count;
+                    const size_t junction_idx = graph.FindJunction(h, x);
+                    REQUIRE(junction_idx != road_graph::RoadGraph::NO_JUNCTION);
+                    CHECK(graph.FindJunction(v, y) == junction_idx);
+                    const road_graph::Junction& junction = graph.GetJunctions()[junction_idx];
+                    CHECK(junction.x == x);
+                    CHECK(junction.y == y);
+                    CHECK(junction.horizontal == h);
+                    CHECK(junction.vertical == v);
+                }
+            }
+            CHECK(junctions_count == graph.GetJunctions().size());
+        }
+        THEN("neighbours of a junction are the nearest junctions along its segments") {
+            const auto& junctions = graph.GetJunctions();
+            for (size_t i = 0; i != junctions.size(); ++i) {
+                const road_graph::Junction& junction = junctions[i];
+                const size_t east = junction.neighbours[road_graph::EAST];
+                if (east != road_graph::RoadGraph::NO_JUNCTION) {
+                    CHECK(junctions[east].horizontal == junction.horizontal);
+                    CHECK(junctions[east].x > junction.x);
+                    CHECK(junctions[east].neighbours[road_graph::WEST] == i);
+                    for (int x = junction.x + 1; x < junctions[east].x; ++x) {
+                        CHECK(graph.FindJunction(junction.horizontal, x) == road_graph::RoadGraph::NO_JUNCTION);
+                    }
+                } else {
+                    CHECK(graph.GetSegmentJunctions(junction.horizontal).back() == i);
+                }
+                const size_t south = junction.neighbours[road_graph::SOUTH];
+                if (south != road_graph::RoadGraph::NO_JUNCTION) {
+                    CHECK(junctions[south].vertical == junction.vertical);
+                    CHECK(junctions[south].y > junction.y);
+                    CHECK(junctions[south].neighbours[road_graph::NORTH] == i);
+                } else {
+                    CHECK(graph.GetSegmentJunctions(junction.vertical).back() == i);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Long dog moves") {
+    using Catch::Matchers::WithinAbs;
+
+    GIVEN("a street made of touching and overlapping roads and a crossing road") {
+        model::Map map(model::Map::Id{"street"}, "Street"s);
+        map.AddRoads({{model::Road::HORIZONTAL, {0, 0}, 10},
+                      {model::Road::HORIZONTAL, {20, 0}, 10},
+                      {model::Road::HORIZONTAL, {15, 0}, 30},
+                      {model::Road::VERTICAL, {30, 0}, 40}});
+
+        WHEN("a dog runs east with a huge time delta") {
+            auto dog = std::make_shared<model::Dog>(0, "Rex"s, model::Position{1., 0.});
+            dog->SetState({{1., 0.}, {3., 0.}, model::Direction::EAST});
+            const model::DogState state = map.MoveDog(dog, 1000.);
+
+            THEN("it stops at the far end of the street") {
+                CHECK_THAT(state.position.x, WithinAbs(30.4, 1e-9));
+                CHECK(state.position.y == 0.);
+                CHECK(state.velocity.IsZero());
+            }
+            THEN("it stops at the same place as a dog moving in small ticks") {
+                auto stepped = std::make_shared<model::Dog>(1, "Bim"s, model::Position{1., 0.});
+                stepped->SetState({{1., 0.}, {3., 0.}, model::Direction::EAST});
+                for (int tick = 0; tick != 1000; ++tick) {
+                    stepped->SetState(map.MoveDog(stepped, 0.05));
+                }
+                CHECK_THAT(stepped->GetDogState().position.x, WithinAbs(state.position.x, 1e-9));
+            }
+        }
+        WHEN("a dog turns at the junction and runs south with a huge time delta") {
+            auto dog = std::make_shared<model::Dog>(0, "Rex"s, model::Position{30., 0.2});
+            dog->SetState({{30., 0.2}, {0., 5.}, model::Direction::SOUTH});
+            const model::DogState state = map.MoveDog(dog, 1e6);
+
+            THEN("it stops at the end of the crossing road") {
+                CHECK(state.position.x == 30.);
+                CHECK_THAT(state.position.y, WithinAbs(40.4, 1e-9));
+            }
+        }
+        WHEN("a dog tries to leave the street across it") {
+            auto dog = std::make_shared<model::Dog>(0, "Rex"s, model::Position{5., 0.});
+            dog->SetState({{5., 0.}, {0., -1.}, model::Direction::NORTH});
+            const model::DogState state = map.MoveDog(dog, 1000.);
+
+            THEN("it stops at the edge of the road") {
+                CHECK(state.position.x == 5.);
+                CHECK_THAT(state.position.y, WithinAbs(-0.4, 1e-9));
+            }
+        }
+    }
+}
+
+SCENARIO("Random positions on roads") {
+    GIVEN("a map with a long road, a short road and a single-point road") {
+        model::Map map(model::Map::Id{"sampling"}, "Sampling"s);
+        map.AddRoads({{model::Road::HORIZONTAL, {0, 0}, 299},
+                      {model::Road::VERTICAL, {500, 10}, 108},
+                      {model::Road::HORIZONTAL, {700, 700}, 700}});
+
+        WHEN("many random positions are taken") {
+            constexpr int SAMPLES = 40000;
+            int on_long = 0;
+            int on_short = 0;
+            int on_point = 0;
+            bool all_on_roads = true;
+            for (int i = 0; i != SAMPLES; ++i) {
+                const model::Position pos = map.GetRandomPositionOnRoads();
+                if ((pos.y == 0.) && (pos.x >= 0.) && (pos.x <= 299.)) {
+                    ++on_long;
+                } else if ((pos.x == 500.) && (pos.y >= 10.) && (pos.y <= 108.)) {
+                    ++on_short;
+                } else if ((pos.x == 700.) && (pos.y == 700.)) {
+                    ++on_point;
+                } else {
+                    all_on_roads = false;
+                }
+            }
+
+            THEN("every position lies on a road and roads are chosen proportionally to their length") {
+                CHECK(all_on_roads);
+                // 300, 99 и 1 точка из 400
+                CHECK(std::abs(on_long - SAMPLES * 300 / 400) < SAMPLES / 50);
+                CHECK(std::abs(on_short - SAMPLES * 99 / 400) < SAMPLES / 50);
+                CHECK(on_point > 0);
+                CHECK(on_point < SAMPLES / 100);
+            }
+        }
+    }
+}
+
+SCENARIO("Road graph of a map being filled") {
+    GIVEN("the same roads added one by one and in a batch") {
+        model::Map::Roads roads;
+        for (int i = 0; i != 5; ++i) {
+            roads.emplace_back(model::Road::HORIZONTAL, model::Point{0, i * 10}, 40);
+            roads.emplace_back(model::Road::VERTICAL, model::Point{i * 10, 0}, 40);
+        }
+        model::Map one_by_one(model::Map::Id{"one"}, "One by one"s);
+        for (const model::Road& road : roads) {
+            one_by_one.AddRoad(road);
+        }
+        model::Map batch(model::Map::Id{"batch"}, "Batch"s);
+        batch.AddRoads(roads);
+
+        THEN("the graphs are the same") {
+            CHECK(one_by_one.GetRoadGraph().GetSegments().size() == batch.GetRoadGraph().GetSegments().size());
+            CHECK(one_by_one.GetRoadGraph().GetJunctions().size() == batch.GetRoadGraph().GetJunctions().size());
+        }
+        WHEN("a road is added after the graph was used") {
+            const size_t segments = batch.GetRoadGraph().GetSegments().size();
+            batch.AddRoad(model::Road{model::Road::HORIZONTAL, {0, 100}, 40});
+
+            THEN("the graph includes it") {
+                CHECK(batch.GetRoadGraph().GetSegments().size() == segments + 1);
+                CHECK(batch.GetRoadGraph().FindSegment(road_graph::Axis::HORIZONTAL, 20, 100) !=
+                      road_graph::RoadGraph::NO_SEGMENT);
+            }
+        }
+    }
+}
@@ -0,0 +1,134 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/model.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+/* Эталонный поиск дорог перебором всех дорог карты */
+std::vector<size_t> FindRoadsBruteForce(const model::Map& map, model::Point point) {
+    std::vector<size_t> result;
+    for (size_t i = 0; i != map.GetRoads().size(); ++i) {
+        const model::Road& road = map.GetRoads()[i];
+        const int min_x = std::min(road.GetStart().x, road.GetEnd().x);
+        const int max_x = std::max(road.GetStart().x, road.GetEnd().x);
+        const int min_y = std::min(road.GetStart().y, road.GetEnd().y);
+        const int max_y = std::max(road.GetStart().y, road.GetEnd().y);
+        if ((point.x >= min_x) && (point.x <= max_x) && (point.y >= min_y) && (point.y <= max_y)) {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+/* Карта-сетка со случайными дорогами, в том числе перекрывающимися и заданными "задом наперёд" */
+model::Map PrepareRandomMap(std::mt19937& gen, size_t roads_count) {
+    model::Map map(model::Map::Id{"random"}, "Random map"s);
+    std::uniform_int_distribution<int> coord(0, 40);
+    std::uniform_int_distribution<int> direction(0, 1);
+    for (size_t i = 0; i != roads_count; ++i) {
+        const model::Point start{coord(gen), coord(gen)};
+        if (direction(gen) == 0) {
+            map.AddRoad({model::Road::HORIZONTAL, start, coord(gen)});
+        } else {
+            map.AddRoad({model::Road::VERTICAL, start, coord(gen)});
+        }
+    }
+    return map;
+}
+
+} // namespace
+
+SCENARIO("Road index lookup") {
+    GIVEN("a map with random roads") {
+        std::mt19937 gen(20240917);
+        model::Map map = PrepareRandomMap(gen, 60);
+
+        WHEN("roads are searched at random positions") {
+            THEN("the index finds the same roads as the brute force search") {
+                std::uniform_int_distribution<int> cell_gen(-2, 42);
+                std::uniform_real_distribution<double> offset_gen(-0.4, 0.4);
+                for (size_t i = 0; i != 5000; ++i) {
+                    const model::Point cell{cell_gen(gen), cell_gen(gen)};
+                    const model::Position pos{cell.x + offset_gen(gen), cell.y + offset_gen(gen)};
+                    auto found = map.GetRoadByPosition(pos);
+                    std::vector<size_t> indexed(found.begin(), found.end());
+                    std::sort(indexed.begin(), indexed.end());
+
+                    INFO("position: " << pos.x << ", " << pos.y);
+                    CHECK(indexed == FindRoadsBruteForce(map, cell));
+                }
+            }
+        }
+    }
+
+    GIVEN("a map with crossroads") {
+        model::Map map(model::Map::Id{"cross"}, "Crossroads"s);
+        map.AddRoad({model::Road::HORIZONTAL, {0, 10}, 20});
+        map.AddRoad({model::Road::HORIZONTAL, {20, 10}, 40});
+        map.AddRoad({model::Road::VERTICAL, {20, 0}, 10});
+        map.AddRoad({model::Road::VERTICAL, {20, 20}, 10});
+
+        WHEN("roads are searched at the junction of four roads") {
+            auto found = map.GetRoadByPosition({20.3, 9.8});
+            THEN("all roads are found without leaving inline storage") {
+                CHECK(found.size() == 4);
+                CHECK(found.size() <= road_index::RoadIndex::INLINE_ROADS);
+            }
+        }
+        WHEN("roads are searched outside of roads") {
+            THEN("nothing is found") {
+                CHECK(map.GetRoadByPosition({5., 5.}).empty());
+                CHECK(map.GetRoadByPosition({41., 10.}).empty());
+            }
+        }
+    }
+}
+
+SCENARIO("Dog road free span") {
+    GIVEN("a map with random roads") {
+        std::mt19937 gen(7);
+        model::Map map = PrepareRandomMap(gen, 60);
+
+        WHEN("dog road is found for random cells") {
+            THEN("the road is the only road on the whole free span and the span cannot be extended") {
+                std::uniform_int_distribution<int> cell_gen(0, 40);
+                for (size_t i = 0; i != 3000; ++i) {
+                    const model::Point cell{cell_gen(gen), cell_gen(gen)};
+                    const std::vector<size_t> roads = FindRoadsBruteForce(map, cell);
+                    const model::DogRoad dog_road = map.FindDogRoad({static_cast<double>(cell.x),
+                                                                     static_cast<double>(cell.y)});
+                    INFO("cell: " << cell.x << ", " << cell.y);
+                    if (roads.empty()) {
+                        CHECK(dog_road.road == model::DogRoad::NO_ROAD);
+                        continue;
+                    }
+                    REQUIRE(dog_road.road != model::DogRoad::NO_ROAD);
+                    CHECK(std::find(roads.begin(), roads.end(), dog_road.road) != roads.end());
+                    if (roads.size() > 1) {
+                        CHECK(dog_road.junction);
+                        continue;
+                    }
+                    CHECK_FALSE(dog_road.junction);
+                    const model::Road& road = map.GetRoads()[dog_road.road];
+                    const auto cell_at = [&road, &cell](int along) {
+                        return road.IsHorizontal() ? model::Point{along, cell.y} : model::Point{cell.x, along};
+                    };
+                    for (int along = dog_road.free_from; along <= dog_road.free_to; ++along) {
+                        CHECK(FindRoadsBruteForce(map, cell_at(along)) == std::vector<size_t>{dog_road.road});
+                    }
+                    for (int along : {dog_road.free_from - 1, dog_road.free_to + 1}) {
+                        const std::vector<size_t> border = FindRoadsBruteForce(map, cell_at(along));
+                        const bool on_road = std::find(border.begin(), border.end(), dog_road.road) != border.end();
+                        CHECK(((!on_road) || (border.size() > 1)));
+                    }
+                }
+            }
+        }
+    }
+}
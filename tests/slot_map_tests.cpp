@@ -0,0 +1,106 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/slot_map.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+SCENARIO("Slot map") {
+    GIVEN("a slot map with several values") {
+        util::SlotMap<std::string> slot_map;
+        const auto a = slot_map.Emplace("a"s);
+        const auto b = slot_map.Emplace("b"s);
+        const auto c = slot_map.Emplace("c"s);
+
+        THEN("values are stored contiguously in insertion order") {
+            CHECK(slot_map.size() == 3);
+            CHECK(slot_map.GetValues() == std::vector{"a"s, "b"s, "c"s});
+            CHECK(slot_map[b] == "b"s);
+            CHECK(slot_map.GetKey(2) == c);
+        }
+        WHEN("a value in the middle is erased") {
+            slot_map.Erase(a);
+
+            THEN("the last value takes its place and the other keys stay valid") {
+                CHECK(slot_map.GetValues() == std::vector{"c"s, "b"s});
+                CHECK(!slot_map.Contains(a));
+                CHECK(slot_map[b] == "b"s);
+                CHECK(slot_map[c] == "c"s);
+                CHECK(slot_map.GetKey(0) == c);
+            }
+            THEN("the key of the erased value doesn't match a new value in the same slot") {
+                const auto d = slot_map.Emplace("d"s);
+                CHECK(d.slot == a.slot);
+                CHECK(!slot_map.Contains(a));
+                CHECK(slot_map[d] == "d"s);
+            }
+        }
+        WHEN("values are appended in a batch after an erasure") {
+            slot_map.Erase(b);
+            slot_map.Append({"d"s, "e"s});
+
+            THEN("they follow the old values and reuse free slots first") {
+                CHECK(slot_map.GetValues() == std::vector{"a"s, "c"s, "d"s, "e"s});
+                const auto d = slot_map.GetKey(2);
+                const auto e = slot_map.GetKey(3);
+                CHECK(d.slot == b.slot);
+                CHECK(!slot_map.Contains(b));
+                CHECK(slot_map[d] == "d"s);
+                CHECK(slot_map[e] == "e"s);
+                CHECK(slot_map[a] == "a"s);
+                CHECK(slot_map[c] == "c"s);
+            }
+        }
+        WHEN("the map is cleared and filled again") {
+            slot_map.Clear();
+            const auto d = slot_map.Emplace("d"s);
+            const auto e = slot_map.Emplace("e"s);
+            const auto f = slot_map.Emplace("f"s);
+
+            THEN("the slots are reused but the old keys don't match the new values") {
+                CHECK(slot_map.GetValues() == std::vector{"d"s, "e"s, "f"s});
+                for (const auto key : {d, e, f}) {
+                    CHECK((key.slot == a.slot || key.slot == b.slot || key.slot == c.slot));
+                }
+                CHECK(!slot_map.Contains(a));
+                CHECK(!slot_map.Contains(b));
+                CHECK(!slot_map.Contains(c));
+                CHECK(slot_map[d] == "d"s);
+                CHECK(slot_map[f] == "f"s);
+            }
+        }
+    }
+    GIVEN("random insertions and erasures") {
+        std::mt19937 gen(20241020);
+        util::SlotMap<int> slot_map;
+        std::map<int, util::SlotMap<int>::Key> expected;
+        for (int value = 0; value != 10'000; ++value) {
+            if (!expected.empty() && (gen() % 3 == 0)) {
+                auto it = std::next(expected.begin(), gen() % expected.size());
+                slot_map.Erase(it->second);
+                expected.erase(it);
+            } else {
+                expected.emplace(value, slot_map.Emplace(value));
+            }
+        }
+
+        THEN("every live key finds its value and the values are the live ones") {
+            REQUIRE(slot_map.size() == expected.size());
+            for (const auto& [value, key] : expected) {
+                CHECK(slot_map[key] == value);
+            }
+            std::vector<int> values(slot_map.begin(), slot_map.end());
+            std::sort(values.begin(), values.end());
+            CHECK(std::equal(values.begin(), values.end(), expected.begin(), expected.end(),
+                             [](int value, const auto& item) { return value == item.first; }));
+            for (size_t idx = 0; idx != slot_map.size(); ++idx) {
+                CHECK(slot_map[slot_map.GetKey(idx)] == slot_map.GetValues()[idx]);
+            }
+        }
+    }
+}
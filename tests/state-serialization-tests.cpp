@@ -8,6 +8,9 @@
 #include <catch2/catch_test_macros.hpp>
 #include <iterator>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 
 using namespace model;
 using namespace std::literals;
@@ -21,6 +24,44 @@ struct Fixture {
     OutputArchive output_archive{strm};
 };
 
+class NullRepository : public players::ApplicationRepository {
+public:
+    void Save([[maybe_unused]] const players::Champion& result) override {}
+    std::vector<players::Champion> GetChampions([[maybe_unused]] size_t start,
+                                                [[maybe_unused]] size_t max_items) override {
+        return {};
+    }
+};
+
+/* Файл состояния версии 0: собаки Rex и Bob на карте town (у Rex предмет в рюкзаке, в сессии два
+ * потерянных предмета), собака Max на карте city. Собаки сохранены в игроках, сессии хранят только id собак */
+constexpr std::string_view STATE_VERSION_0 =
+    "22 serialization::archive 18 0 0 2 0 0 0 4 town 10 2 0 1 2 0 0 2 0 0 0 0 0 0 "
+    "2.00000000000000000e+01 0.00000000000000000e+00 8 0.00000000000000000e+00 1 "
+    "4.00000000000000000e+01 2.50000000000000000e+01 9 0.00000000000000000e+00 4 city 0 1 0 3 0 0 0 0 "
+    "0 0 3 0 0 0 0 0 1 3 Rex 0 0 4.00000000000000000e+01 1.25000000000000000e+01 0 0 "
+    "0.00000000000000000e+00 4.00000000000000000e+00 1 15 0 0 1 0 0 0 7 1 0.00000000000000000e+00 "
+    "0.00000000000000000e+00 4 town 2 3 Bob 1.00000000000000000e+01 0.00000000000000000e+00 "
+    "0.00000000000000000e+00 0.00000000000000000e+00 2 0 0 0 0.00000000000000000e+00 "
+    "0.00000000000000000e+00 4 town 3 3 Max 0.00000000000000000e+00 0.00000000000000000e+00 "
+    "0.00000000000000000e+00 0.00000000000000000e+00 0 0 0 0 0.00000000000000000e+00 "
+    "0.00000000000000000e+00 4 city 3 0 0 0 0 3 13 0 0 0 1 0 0 32 e1b6a2bcabddaadf47f89a16275dd40d 2 "
+    "32 b49a5d693ce8621d0d28ed821d4c94ba 3 32 72957f38938dd15e566879ca8bde03ea";
+
+/* Тот же мир в файле версии 1 (без очков Rex): собаки сохранены в сессиях, номеров экземпляров сессий ещё нет */
+constexpr std::string_view STATE_VERSION_1 =
+    "22 serialization::archive 18 0 0 2 0 0 1 4 town 10 0 0 2 0 0 0 1 3 Rex 0 0 0 0 "
+    "4.00000000000000000e+01 1.25000000000000000e+01 0 0 0.00000000000000000e+00 "
+    "4.00000000000000000e+00 1 0 0 0 1 0 0 0 7 1 0.00000000000000000e+00 0.00000000000000000e+00 2 3 "
+    "Bob 1.00000000000000000e+01 0.00000000000000000e+00 0.00000000000000000e+00 "
+    "0.00000000000000000e+00 2 0 0 0 0.00000000000000000e+00 0.00000000000000000e+00 0 0 2 0 0 0 0 "
+    "2.00000000000000000e+01 0.00000000000000000e+00 8 0.00000000000000000e+00 1 "
+    "4.00000000000000000e+01 2.50000000000000000e+01 9 0.00000000000000000e+00 4 city 0 1 0 3 3 Max "
+    "0.00000000000000000e+00 0.00000000000000000e+00 0.00000000000000000e+00 0.00000000000000000e+00 "
+    "0 0 0 0 0.00000000000000000e+00 0.00000000000000000e+00 0 0 0 0 0 0 3 0 0 1 1 4 town 2 4 town 3 "
+    "4 city 3 0 0 0 0 3 13 0 0 0 1 0 0 32 a29e8877b16ee0e789427f1676a1a801 2 32 "
+    "98f67253454ce20ef613c7b53753c6cf 3 32 80eda02b8b0eeff7db554d5a1315d260";
+
 }  // namespace
 
 namespace model {
@@ -198,6 +239,7 @@ SCENARIO_METHOD(Fixture, "Player, players Serialization") {
         }();
         Map map{Map::Id{"town"}, "Town map", 4., 3};
         map.AddRoad({model::Road::HORIZONTAL, {0, 0}, 100});
+        map.AddRoad({model::Road::VERTICAL, {7, 0}, 20});
         std::shared_ptr<GameSession> game_session = std::make_shared<GameSession>(&map);
         std::vector<model::Game::Sessions> sessions;
         sessions.emplace_back(game_session);
@@ -215,7 +257,8 @@ SCENARIO_METHOD(Fixture, "Player, players Serialization") {
                 input_archive >> repr;
                 const auto restored = repr.Restore(sessions);
 
-                CHECK(player.GetDog()->GetDogId() == restored.GetDog()->GetDogId());
+                CHECK(player.GetDog().GetDogId() == restored.GetDog().GetDogId());
+                CHECK(restored.GetDog().GetRoad().road == 1);
                 CHECK(player.GetGameSession()->GetMap()->GetId() == restored.GetGameSession()->GetMap()->GetId());
             }
         }
@@ -300,13 +343,18 @@ SCENARIO_METHOD(Fixture, "GameSession Serialization") {
         Game game;
         game.AddMap(map);
         auto session_ptr = game.PlacePlayerOnMap(map.GetId());
-        GameSession::LostObjects lost_objects;
+        std::vector<LostObject> lost_objects;
         for (size_t i = 0; i != 4; ++i) {
             Dog dog{42 + i, "Pluto"s + std::to_string(i), {42.2, 12.5}};
-            session_ptr->AddDog(dog.GetDogId());
-            lost_objects.emplace_back(std::make_shared<LostObject>(LostObject(1, {20.8, 10. + i}, i, 0.8)));
+            dog.AddPickedObject(PickedObject{100 + i, 1}, 4);
+            dog.AddScores(10 * i);
+            dog.IncTotalTime(1.5 * i);
+            session_ptr->AddDog(dog);
+            lost_objects.emplace_back(1, Position{20.8, 10. + i}, i, 0.8);
         }
         session_ptr->RestoreLostObjects(lost_objects, 4);
+        // удаление переставляет собак в массивах сессии
+        session_ptr->DeleteDog(43);
 
         WHEN("game session is serialized") {
             {
@@ -328,9 +376,104 @@ SCENARIO_METHOD(Fixture, "GameSession Serialization") {
                 for (auto it1 = session_ptr->GetDogIds().begin(), it2 = restored.GetDogIds().begin();
                         it1 != session_ptr->GetDogIds().end(); ++it1, ++it2, ++s_it, ++r_it) {
                     CHECK(*it1 == *it2);
-                    CHECK((*s_it)->GetId() == (*r_it)->GetId());
+                    CHECK(s_it->GetId() == r_it->GetId());
+                }
+                const SessionDogs& dogs = session_ptr->GetDogs();
+                const SessionDogs& restored_dogs = restored.GetDogs();
+                for (size_t idx = 0; idx != dogs.Size(); ++idx) {
+                    CHECK(dogs.GetName(idx) == restored_dogs.GetName(idx));
+                    CHECK(dogs.GetState(idx) == restored_dogs.GetState(idx));
+                    CHECK(dogs.GetBag(idx) == restored_dogs.GetBag(idx));
+                    CHECK(dogs.GetScores(idx) == restored_dogs.GetScores(idx));
+                    CHECK(dogs.GetTotalTime(idx) == restored_dogs.GetTotalTime(idx));
                 }
             }
+            THEN("game session can't be restored to a game without its map") {
+                InputArchive input_archive{strm};
+                serialization::GameSessionRepr repr;
+                input_archive >> repr;
+                Game other_game;
+                other_game.AddMap(Map{Map::Id("city"), "Some City", 5.5, 2u});
+
+                CHECK_THROWS_AS(repr.Restore(other_game), std::domain_error);
+            }
+        }
+    }
+}
+
+SCENARIO("State files of previous formats") {
+    GIVEN("a game with the maps of old state files") {
+        Game game;
+        Map town(Map::Id{"town"s}, "Town"s, 4., 3);
+        town.AddRoad(model::Road{model::Road::HORIZONTAL, {0, 0}, 40});
+        town.AddRoad(model::Road{model::Road::VERTICAL, {40, 0}, 30});
+        town.AddLootType(LootType{"key"sv, "key.obj"sv, "obj"sv, std::nullopt, std::nullopt, 0.1, 5});
+        town.AddLootType(LootType{"wallet"sv, "wallet.obj"sv, "obj"sv, std::nullopt, std::nullopt, 0.1, 10});
+        Map city(Map::Id{"city"s}, "City"s, 2., 3);
+        city.AddRoad(model::Road{model::Road::HORIZONTAL, {0, 0}, 10});
+        game.AddMap(std::move(town));
+        game.AddMap(std::move(city));
+        NullRepository repository;
+        players::Application app(game, false, true, 0, std::nullopt, repository);
+
+        WHEN("the state of version 0 is restored") {
+            std::stringstream strm{std::string{STATE_VERSION_0}};
+            players::DeserializeState(strm, app);
+
+            THEN("the dogs saved in players are moved to their sessions") {
+                const auto rex = app.FindPlayerByToken(players::Token{"e1b6a2bcabddaadf47f89a16275dd40d"s});
+                REQUIRE(rex != nullptr);
+                CHECK(rex->GetName() == "Rex"s);
+                CHECK(rex->GetDog().GetDogState().position == Position{40., 12.5});
+                REQUIRE(rex->GetDog().GetPickedObjects().size() == 1);
+                CHECK(rex->GetDog().GetPickedObjects().front() == PickedObject{7, 1});
+                CHECK(rex->GetDog().GetScores() == 15);
+                const auto bob = app.FindPlayerByToken(players::Token{"b49a5d693ce8621d0d28ed821d4c94ba"s});
+                REQUIRE(bob != nullptr);
+                CHECK(bob->GetGameSession() == rex->GetGameSession());
+                const auto max = app.FindPlayerByToken(players::Token{"72957f38938dd15e566879ca8bde03ea"s});
+                REQUIRE(max != nullptr);
+                CHECK(*max->GetGameSession()->GetMap()->GetId() == "city"s);
+            }
+            THEN("sessions keep their lost objects and get the first instance number") {
+                REQUIRE(game.GetSessions().size() == 2);
+                const auto& town_session = game.GetSessions()[0];
+                CHECK(town_session->GetInstanceId() == 0);
+                CHECK(town_session->CountDogsInSession() == 2);
+                CHECK(town_session->GetLostObjects().size() == 2);
+                CHECK(town_session->GetLastObjectId() == 10);
+            }
+            THEN("the state is saved in the current format and loads again") {
+                std::stringstream saved = players::SerializeState(app);
+                Game other_game;
+                other_game.AddMap(game.GetMaps()[0]);
+                other_game.AddMap(game.GetMaps()[1]);
+                players::Application other_app(other_game, false, true, 0, std::nullopt, repository);
+                players::DeserializeState(saved, other_app);
+                REQUIRE(other_game.GetSessions().size() == 2);
+                CHECK(other_game.GetSessions()[0]->CountDogsInSession() == 2);
+                CHECK(other_app.FindPlayerByToken(players::Token{"e1b6a2bcabddaadf47f89a16275dd40d"s}) != nullptr);
+            }
+        }
+        WHEN("the state of version 1 is restored") {
+            std::stringstream strm{std::string{STATE_VERSION_1}};
+            players::DeserializeState(strm, app);
+
+            THEN("sessions and players get the first instance number") {
+                REQUIRE(game.GetSessions().size() == 2);
+                const auto& town_session = game.GetSessions()[0];
+                CHECK(town_session->GetInstanceId() == 0);
+                CHECK(town_session->CountDogsInSession() == 2);
+                CHECK(town_session->GetLostObjects().size() == 2);
+                const auto rex = app.FindPlayerByToken(players::Token{"a29e8877b16ee0e789427f1676a1a801"s});
+                REQUIRE(rex != nullptr);
+                CHECK(rex->GetGameSession() == town_session);
+                CHECK(rex->GetDog().GetDogState().position == Position{40., 12.5});
+                CHECK(rex->GetDog().GetPickedObjects().size() == 1);
+                const auto max = app.FindPlayerByToken(players::Token{"80eda02b8b0eeff7db554d5a1315d260"s});
+                REQUIRE(max != nullptr);
+                CHECK(max->GetGameSession() == game.GetSessions()[1]);
+            }
         }
     }
 }